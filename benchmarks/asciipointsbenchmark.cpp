@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "mesh.h"
+#include "asciipoints.h"
+
+// Parsing throughput of an XYZ file with a few million points
+TEST(AsciiPointsBenchmark, LargeFile)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected{ generate_sample_points(1.f, 1000) };
+
+    std::string path{ (std::filesystem::temp_directory_path() / "points_large.xyz").string() };
+
+    {
+        std::ofstream file{ path };
+        file.precision(9);
+
+        for (auto point : expected)
+        {
+            file << point.x << ' ' << point.y << ' ' << point.z << '\n';
+        }
+    }
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+    double megabytes{ std::filesystem::file_size(path) / 1e6 };
+
+    EXPECT_EQ(cloud.points.size(), expected.size());
+
+    std::cout << "Parsed " << cloud.points.size() << " points (" << megabytes << " MB) in " << seconds << " s, " << megabytes / seconds << " MB/s" << std::endl;
+
+    std::filesystem::remove(path);
+}
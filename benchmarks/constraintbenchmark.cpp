@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "mesh.h"
+
+// Time per constraint for each constraint mode as the constraints get longer and cross more edges
+// The crossing count where cavity retriangulation starts to beat flipping is what
+// cavity_crossing_threshold is set from
+TEST(ConstraintBenchmark, FlipVersusCavity)
+{
+    using namespace moodysim;
+
+    constexpr int num_points{ 10000 };
+    constexpr int num_constraints{ 40 };
+
+    for (float length : { 0.1f, 0.2f, 0.3f, 0.4f, 0.6f, 1.f, 1.6f })
+    {
+        std::mt19937 rng{ 1234 };
+        std::uniform_real_distribution<float> coord{ -1.f, 1.f };
+        std::uniform_real_distribution<float> start{ -0.95f, 0.95f - length };
+
+        std::vector<Point3D> input_points{};
+        std::vector<Edge> input_edges{};
+
+        for (int i = 0; i < num_points; ++i)
+        {
+            input_points.push_back({ coord(rng), coord(rng), 0.f });
+        }
+
+        // Horizontal segments on separate rows so they never cross each other
+        for (int k = 0; k < num_constraints; ++k)
+        {
+            float x{ start(rng) };
+            float y{ -0.95f + 1.9f * (k + 0.5f) / num_constraints };
+            int index{ static_cast<int>(input_points.size()) };
+
+            input_points.push_back({ x, y, 0.f });
+            input_points.push_back({ x + length, y, 0.f });
+            input_edges.push_back({ index, index + 1 });
+        }
+
+        // Mean number of edges of the unconstrained triangulation each constraint crosses
+        DelaunayGenerator unconstrained_gen{ input_points, input_edges };
+        unconstrained_gen.triangulate();
+
+        // Every run starts from a copy of the same triangulation
+        DelaunayState state{};
+        unconstrained_gen.get_state(state);
+
+        const auto& points{ unconstrained_gen.get_points() };
+        size_t crossings{ 0 };
+
+        for (const auto& triangle : unconstrained_gen.get_triangles())
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                int a{ triangle[i] };
+                int b{ triangle[(i + 1) % 3] };
+
+                for (auto edge : input_edges)
+                {
+                    crossings += unconstrained_gen.check_intersection(points[a], points[b], points[edge.n1], points[edge.n2]) ? 1 : 0;
+                }
+            }
+        }
+
+        // Each interior edge belongs to two triangles
+        std::cout << "Length " << length << " mean crossings " << crossings / 2.0 / num_constraints << " us per constraint:";
+
+        const char* names[]{ "automatic", "flip", "cavity" };
+
+        for (auto mode : { ConstraintMode::Flip, ConstraintMode::Cavity, ConstraintMode::Automatic })
+        {
+            double best{ 1e30 };
+
+            for (int repeat = 0; repeat < 5; ++repeat)
+            {
+                DelaunayGenerator delaunay_gen{ state };
+
+                auto begin{ std::chrono::steady_clock::now() };
+                EXPECT_TRUE(delaunay_gen.apply_constraint(mode));
+                auto end{ std::chrono::steady_clock::now() };
+
+                best = std::min(best, std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+
+            std::cout << " " << names[static_cast<int>(mode)] << " " << best / num_constraints;
+        }
+
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "decimate.h"
+#include "meshfixtures.h"
+
+// Time to decimate a two million triangle height field to a tenth of its triangles
+TEST(DecimateBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_height_field(1000, [](float x, float y) { return 0.2f * std::sin(3.f * x) * std::cos(2.f * y); }) };
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    MeshDecimator decimator{ mesh };
+    SurfaceMeshData result{ decimator.decimate(mesh.get_indices().size() / 3 / 10) };
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_LE(result.get_indices().size(), mesh.get_indices().size() / 10);
+
+    std::cout << "Decimated " << mesh.get_indices().size() / 3 << " triangles to " << result.get_indices().size() / 3
+        << " in " << seconds << " s" << std::endl;
+}
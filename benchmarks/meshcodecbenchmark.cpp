@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "meshcodec.h"
+#include "meshfixtures.h"
+
+// Encoded size and decoding throughput of a two million triangle jittered grid
+TEST(MeshCodecBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_jittered_grid(1000, [](int i, int) { return std::cos(0.01f * i); }) };
+
+    size_t raw_size{ mesh.get_vertices().size() * 3 * sizeof(float) + mesh.get_indices().size() * sizeof(unsigned int) };
+
+    std::vector<std::byte> data{ encode_mesh(mesh) };
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    std::optional<SurfaceMeshData> decoded{ decode_mesh(data) };
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    ASSERT_TRUE(decoded);
+
+    std::cout << "Encoded " << raw_size / 1e6 << " MB of positions and indices in " << data.size() / 1e6 << " MB, decoded in "
+        << seconds << " s (" << raw_size / 1e6 / seconds << " MB/s of raw mesh)" << std::endl;
+}
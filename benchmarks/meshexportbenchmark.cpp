@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#include "meshexport.h"
+#include "meshfixtures.h"
+
+// Export throughput of a two million triangle grid as ASCII OBJ and binary PLY
+TEST(MeshExportBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_height_field(1000, [](float x, float y) { return 0.1f * std::sin(3.f * x) * std::cos(2.f * y); }) };
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_export_large.obj").string() };
+
+    for (auto [format, binary] : { std::pair{ MeshExportFormat::Obj, false }, std::pair{ MeshExportFormat::Ply, true } })
+    {
+        auto start{ std::chrono::steady_clock::now() };
+
+        ASSERT_TRUE(export_mesh(path, mesh, format, binary));
+
+        double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+        double megabytes{ std::filesystem::file_size(path) / 1e6 };
+
+        std::cout << "Exported " << mesh.get_indices().size() / 3 << " triangles (" << megabytes << " MB) in " << seconds << " s, "
+            << megabytes / seconds << " MB/s" << std::endl;
+    }
+
+    std::filesystem::remove(path);
+}
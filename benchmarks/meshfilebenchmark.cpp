@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include "meshfile.h"
+#include "meshfixtures.h"
+
+// Time to open a ten million triangle mesh file, which maps it without copying
+TEST(MeshFileBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_large.mesh").string() };
+
+    {
+        SurfaceMeshData mesh{ make_grid(2237) };
+        ASSERT_TRUE(write_mesh_file(path, mesh));
+    }
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    MeshFile file{};
+    ASSERT_TRUE(file.open(path));
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    size_t num_triangles{ file.mesh().get_indices().size() / 3 };
+
+    EXPECT_GT(num_triangles, 10000000);
+
+    std::cout << "Opened " << num_triangles << " triangles in " << seconds * 1000.0 << " ms" << std::endl;
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include "mesh.h"
+#include "pointcloud.h"
+
+// Time to read ten million points through the memory mapped reader
+TEST(PointCloudBenchmark, LargeCloud)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected(10000000);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        expected[i] = { static_cast<float>(i % 4096), static_cast<float>(i / 4096), 0.f };
+    }
+
+    std::string path{ (std::filesystem::temp_directory_path() / "pointcloud_large.bin").string() };
+    ASSERT_TRUE(write_point_cloud(path, expected));
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    PointCloudReader reader{};
+    ASSERT_TRUE(reader.open(path));
+
+    std::vector<Point3D> points{};
+    points.reserve(reader.size_hint());
+
+    while (reader.read(points, 1 << 16) > 0)
+    {
+    }
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_EQ(points.size(), expected.size());
+
+    std::cout << "Read " << points.size() << " points in " << seconds << " s" << std::endl;
+
+    std::filesystem::remove(path);
+}
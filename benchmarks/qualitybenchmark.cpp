@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "quality.h"
+#include "meshfixtures.h"
+
+// Time to measure every triangle of a two million triangle grid and build the report
+TEST(QualityBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    constexpr int n{ 1000 };
+
+    SurfaceMeshData mesh{ make_jittered_grid(n, [](int, int) { return 0.f; }) };
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    QualityReport report{ measure_quality(mesh, 18, 5) };
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_EQ(report.min_angle.values.size(), 2 * n * n);
+
+    std::cout << "Measured " << report.min_angle.values.size() << " triangles in " << 1000.0 * seconds << " ms, min angle "
+        << report.min_angle.min << " mean " << report.min_angle.mean << std::endl;
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "mesh.h"
+#include "meshfixtures.h"
+
+// Time for Ruppert refinement of a constrained point cloud to reach a minimum angle of 20 degrees
+TEST(RefineBenchmark, PointCloud)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(5000, 20, input_points, input_edges);
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+
+    auto start{ std::chrono::steady_clock::now() };
+    int added{ delaunay_gen.refine(20.f) };
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_GT(added, 0);
+
+    std::cout << "Refinement added " << added << " points making " << delaunay_gen.get_triangles().size() << " triangles in "
+        << 1000.0 * seconds << " ms" << std::endl;
+}
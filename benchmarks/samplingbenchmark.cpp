@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "sampling.h"
+
+// Time for tiled Poisson-disk sampling of an annulus with a slot cut out of it
+TEST(SamplingBenchmark, TiledDomain)
+{
+    using namespace moodysim;
+
+    auto inside = [](float x, float y)
+        {
+            float sqr_radius{ x * x + y * y };
+            return sqr_radius <= 1.f && sqr_radius >= 0.09f && !(x > 0.f && std::abs(y) < 0.1f);
+        };
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    std::vector<Point3D> points{ generate_poisson_disk_points(inside, -1.f, -1.f, 1.f, 1.f, 0.002f, 3) };
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_FALSE(points.empty());
+
+    std::cout << "Sampled " << points.size() << " points in " << seconds << " s" << std::endl;
+}
+
+// Time to generate about nine million lattice points filling the default shape
+TEST(SamplingBenchmark, LargeLattice)
+{
+    using namespace moodysim;
+
+    LatticeShape circle{};
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    std::vector<Point3D> points{ generate_lattice_points(circle, 0.0006f) };
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_GT(points.size(), 9000000);
+
+    std::cout << "Generated " << points.size() << " lattice points in " << seconds << " s" << std::endl;
+}
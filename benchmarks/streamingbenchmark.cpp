@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "streaming.h"
+#include "meshfixtures.h"
+
+// Only counts what a StreamingDelaunay writes so the sink costs nothing
+class CountingMeshSink : public moodysim::StreamingMeshSink
+{
+public:
+
+    void write_points(std::span<const moodysim::Point3D> points) override
+    {
+        num_points += points.size();
+    }
+
+    void write_triangles(std::span<const std::array<std::int64_t, 3>> triangles) override
+    {
+        num_triangles += triangles.size();
+    }
+
+    size_t num_points{ 0 };
+    size_t num_triangles{ 0 };
+};
+
+// Throughput and peak memory of streaming 800 thousand points arriving one cell at a time
+TEST(StreamingBenchmark, BoundedMemory)
+{
+    using namespace moodysim;
+
+    constexpr int grid_size{ 64 };
+    std::vector<Point3D> points{ make_cell_ordered_points(grid_size, 200, 9) };
+
+    CountingMeshSink sink{};
+    StreamingDelaunay streaming{ sink, -1.f, -1.f, 1.f, 1.f, grid_size };
+
+    auto start{ std::chrono::steady_clock::now() };
+
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        streaming.add_point(points[k]);
+
+        if ((k + 1) % 200 == 0)
+        {
+            streaming.finalize_cell(streaming.cell_index(points[k]));
+        }
+    }
+
+    streaming.finish();
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    EXPECT_EQ(sink.num_points, points.size());
+
+    std::cout << "Streamed " << points.size() << " points into " << sink.num_triangles << " triangles in " << seconds
+        << " s, peak resident triangles " << streaming.get_peak_resident_triangles() << " points " << streaming.get_peak_resident_points() << std::endl;
+}
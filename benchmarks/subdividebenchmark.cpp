@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "subdivide.h"
+#include "meshfixtures.h"
+
+// Time for one step of each subdivision scheme on a one million triangle grid
+TEST(SubdivideBenchmark, LargeMesh)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_height_field(708, [](float, float) { return 0.f; }) };
+
+    for (auto scheme : { SubdivisionScheme::Midpoint, SubdivisionScheme::Loop, SubdivisionScheme::Sqrt3 })
+    {
+        auto start{ std::chrono::steady_clock::now() };
+
+        SurfaceMeshData result{ subdivide(mesh, scheme) };
+
+        double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+        EXPECT_GT(result.get_indices().size(), mesh.get_indices().size());
+
+        std::cout << "Subdivided " << mesh.get_indices().size() / 3 << " triangles to " << result.get_indices().size() / 3
+            << " in " << seconds << " s" << std::endl;
+    }
+}
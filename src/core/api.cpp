@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "mesh.h"
+#include "pointsource.h"
 #include "graphics.h"
 #include "surfacemeshdata.h"
 
@@ -12,9 +13,10 @@ void delaunay_sample(float radius, int density)
 
     using namespace moodysim;
 
-    std::vector<Point3D> input_points{ generate_sample_points(radius, density) };
+    // Generate the points straight into the triangulator instead of copying a finished vector
+    RangePointSource source{ stream_sample_points(radius, density), sample_points_bound(radius, density) };
 
-    DelaunayGenerator delaunay_gen{ input_points, {} };
+    DelaunayGenerator delaunay_gen{ source };
 
     SurfaceMeshData mesh_data = delaunay_gen.generate_delaunay_mesh();
 
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+namespace moodysim
+{
+    // Lazy sequence produced by a coroutine with co_yield, iterated once like an input range
+    // Each value is produced when the iterator advances so the sequence is never stored
+    template <typename T>
+    class Generator
+    {
+    public:
+
+        struct promise_type
+        {
+            T value_{};
+
+            Generator get_return_object() { return Generator{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            std::suspend_always yield_value(T value)
+            {
+                value_ = std::move(value);
+                return {};
+            }
+
+            void return_void() {}
+
+            // Errors are reported before yielding so there is nothing to pass on
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        struct Sentinel {};
+
+        class Iterator
+        {
+        public:
+
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+
+            explicit Iterator(std::coroutine_handle<promise_type> handle)
+                : handle_(handle)
+            {}
+
+            const T& operator*() const { return handle_.promise().value_; }
+
+            Iterator& operator++()
+            {
+                handle_.resume();
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            bool operator==(Sentinel) const { return !handle_ || handle_.done(); }
+
+        private:
+
+            std::coroutine_handle<promise_type> handle_{};
+        };
+
+        explicit Generator(std::coroutine_handle<promise_type> handle)
+            : handle_(handle)
+        {}
+
+        Generator(Generator&& other) noexcept
+            : handle_(std::exchange(other.handle_, {}))
+        {}
+
+        Generator& operator=(Generator&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                {
+                    handle_.destroy();
+                }
+
+                handle_ = std::exchange(other.handle_, {});
+            }
+
+            return *this;
+        }
+
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        ~Generator()
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+        }
+
+        // Runs the coroutine to its first value so call it only once
+        Iterator begin()
+        {
+            if (handle_)
+            {
+                handle_.resume();
+            }
+
+            return Iterator{ handle_ };
+        }
+
+        Sentinel end() const { return {}; }
+
+    private:
+
+        std::coroutine_handle<promise_type> handle_{};
+    };
+}
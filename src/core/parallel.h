@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace moodysim
+{
+    // Number of threads used by the parallel loops
+    inline int thread_count()
+    {
+        unsigned int count{ std::thread::hardware_concurrency() };
+
+        return count == 0 ? 1 : static_cast<int>(count);
+    }
+
+    // Split [begin, end) into one contiguous block per thread and call func(block_begin, block_end)
+    // for each block, ranges smaller than min_block per thread run on the calling thread
+    template <typename Func>
+    void parallel_for(int begin, int end, Func&& func, int min_block = 1 << 14)
+    {
+        int count{ end - begin };
+
+        if (count <= 0)
+        {
+            return;
+        }
+
+        int blocks{ std::min(thread_count(), (count + min_block - 1) / min_block) };
+
+        if (blocks <= 1)
+        {
+            func(begin, end);
+            return;
+        }
+
+        int block_size{ (count + blocks - 1) / blocks };
+
+        std::vector<std::thread> threads{};
+        threads.reserve(blocks - 1);
+
+        for (int block = 1; block < blocks; ++block)
+        {
+            int block_begin{ begin + block * block_size };
+            int block_end{ std::min(end, block_begin + block_size) };
+
+            if (block_begin < block_end)
+            {
+                threads.emplace_back([&func, block_begin, block_end]() { func(block_begin, block_end); });
+            }
+        }
+
+        func(begin, std::min(end, begin + block_size));
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <span>
+#include <memory>
 
 namespace moodysim
 {
@@ -10,20 +12,40 @@ namespace moodysim
         float r{}, g{}, b{}; // Vertex Color
     };
 
+    // Immutable vertices and triangle indices, either owned or viewed in storage kept alive by an owner
+    // Copies share the same storage
     class SurfaceMeshData
     {
     public:
 
         SurfaceMeshData(std::vector<SMVertex> vertices, std::vector<unsigned int> indices)
-            : vertices_(std::move(vertices)), indices_(std::move(indices))
+        {
+            auto storage{ std::make_shared<Storage>(std::move(vertices), std::move(indices)) };
+
+            vertices_ = storage->vertices;
+            indices_ = storage->indices;
+            owner_ = std::move(storage);
+        }
+
+        // View of vertices and indices held by owner (such as a mapped file), nothing is copied
+        SurfaceMeshData(std::span<const SMVertex> vertices, std::span<const unsigned int> indices, std::shared_ptr<const void> owner)
+            : vertices_(vertices), indices_(indices), owner_(std::move(owner))
         {}
 
-        const std::vector<SMVertex>& get_vertices() const { return vertices_; }
-        const std::vector<unsigned int>& get_indices() const { return indices_; }
+        std::span<const SMVertex> get_vertices() const { return vertices_; }
+        std::span<const unsigned int> get_indices() const { return indices_; }
 
     private:
 
-        std::vector<SMVertex> vertices_;
-        std::vector<unsigned int> indices_;
+        struct Storage
+        {
+            std::vector<SMVertex> vertices;
+            std::vector<unsigned int> indices;
+        };
+
+        std::span<const SMVertex> vertices_;
+        std::span<const unsigned int> indices_;
+
+        std::shared_ptr<const void> owner_;
     };
 }
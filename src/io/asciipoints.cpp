@@ -0,0 +1,525 @@
+#include "asciipoints.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+#include "mappedfile.h"
+#include "parallel.h"
+
+namespace moodysim
+{
+    namespace
+    {
+        // Where the values of each column go and which part of the file holds the data lines
+        struct AsciiLayout
+        {
+            char delimiter{ ' ' };
+            bool comments{ true };
+
+            // Per column 0, 1, 2 for x, y, z, 3 + k for attribute k, -1 to skip
+            std::vector<int> targets{};
+
+            // Columns a line needs to hold both coordinates
+            int required{ 2 };
+
+            const char* begin{ nullptr };
+            const char* end{ nullptr };
+
+            // Lines before begin, for error messages
+            size_t first_line{ 0 };
+
+            // Number of data lines to read (PLY gives it in the header)
+            size_t max_count{ std::numeric_limits<size_t>::max() };
+        };
+
+        bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        const char* line_end(const char* p, const char* end)
+        {
+            const void* found{ std::memchr(p, '\n', end - p) };
+            return found ? static_cast<const char*>(found) : end;
+        }
+
+        std::string_view trim(std::string_view text)
+        {
+            while (!text.empty() && (is_space(text.front()) || text.front() == '"'))
+            {
+                text.remove_prefix(1);
+            }
+
+            while (!text.empty() && (is_space(text.back()) || text.back() == '"'))
+            {
+                text.remove_suffix(1);
+            }
+
+            return text;
+        }
+
+        std::string lowercase(std::string_view text)
+        {
+            std::string result{ text };
+            std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return result;
+        }
+
+        // Split a line at the delimiter (runs of whitespace when it is a space)
+        std::vector<std::string_view> split(std::string_view line, char delimiter)
+        {
+            std::vector<std::string_view> fields{};
+
+            if (delimiter == ' ')
+            {
+                size_t p{ 0 };
+
+                while (true)
+                {
+                    while (p < line.size() && is_space(line[p]))
+                    {
+                        ++p;
+                    }
+
+                    if (p == line.size())
+                    {
+                        break;
+                    }
+
+                    size_t q{ p };
+                    while (q < line.size() && !is_space(line[q]))
+                    {
+                        ++q;
+                    }
+
+                    fields.push_back(line.substr(p, q - p));
+                    p = q;
+                }
+            }
+            else
+            {
+                size_t p{ 0 };
+
+                while (true)
+                {
+                    size_t q{ std::min(line.find(delimiter, p), line.size()) };
+                    fields.push_back(trim(line.substr(p, q - p)));
+
+                    if (q == line.size())
+                    {
+                        break;
+                    }
+
+                    p = q + 1;
+                }
+            }
+
+            return fields;
+        }
+
+        // Data line (not blank or a comment)
+        bool is_data(const char* p, const char* end, bool comments)
+        {
+            while (p < end && is_space(*p))
+            {
+                ++p;
+            }
+
+            return p < end && !(comments && *p == '#');
+        }
+
+        // Parse the fields of the line [p, end) into values, returns the number parsed or -1 if a field is not a number
+        int parse_fields(const char* p, const char* end, char delimiter, double* values, int max_fields)
+        {
+            int count{ 0 };
+
+            while (true)
+            {
+                while (p < end && is_space(*p))
+                {
+                    ++p;
+                }
+
+                if (p == end || count == max_fields)
+                {
+                    return count;
+                }
+
+                // from_chars does not take a leading plus
+                p += *p == '+' ? 1 : 0;
+
+                auto [next, error] { std::from_chars(p, end, values[count]) };
+
+                if (error != std::errc{})
+                {
+                    return -1;
+                }
+
+                ++count;
+                p = next;
+
+                while (p < end && is_space(*p))
+                {
+                    ++p;
+                }
+
+                if (delimiter != ' ' && p < end)
+                {
+                    if (*p != delimiter)
+                    {
+                        return -1;
+                    }
+
+                    ++p;
+                }
+                else if (delimiter == ' ' && p < end && p == next)
+                {
+                    // Number followed directly by something else
+                    return -1;
+                }
+            }
+        }
+
+        // Columns in order x, y, z then the rest as attributes
+        void default_targets(int columns, AsciiLayout& layout, std::vector<std::string>& names)
+        {
+            layout.targets.resize(columns);
+
+            for (int k = 0; k < columns; ++k)
+            {
+                layout.targets[k] = k;
+
+                if (k >= 3)
+                {
+                    names.push_back("column" + std::to_string(k));
+                }
+            }
+        }
+
+        // Columns picked by name, returns false without an x and a y
+        bool named_targets(const std::vector<std::string>& columns, AsciiLayout& layout, std::vector<std::string>& names)
+        {
+            layout.targets.assign(columns.size(), -1);
+
+            int coordinates[3]{ -1, -1, -1 };
+
+            for (size_t k = 0; k < columns.size(); ++k)
+            {
+                std::string name{ lowercase(columns[k]) };
+
+                if (name.size() == 1 && name[0] >= 'x' && name[0] <= 'z' && coordinates[name[0] - 'x'] < 0)
+                {
+                    coordinates[name[0] - 'x'] = static_cast<int>(k);
+                    layout.targets[k] = name[0] - 'x';
+                }
+                else
+                {
+                    layout.targets[k] = 3 + static_cast<int>(names.size());
+                    names.push_back(columns[k]);
+                }
+            }
+
+            layout.required = std::max(coordinates[0], coordinates[1]) + 1;
+
+            return coordinates[0] >= 0 && coordinates[1] >= 0;
+        }
+
+        bool read_ply_header(const std::string& path, const char* data, const char* end, AsciiLayout& layout, std::vector<std::string>& names)
+        {
+            const char* p{ data };
+
+            size_t line_count{ 0 };
+            size_t skip_lines{ 0 };
+            bool in_vertex{ false };
+            bool found_vertex{ false };
+            std::vector<std::string> properties{};
+
+            while (p < end)
+            {
+                const char* e{ line_end(p, end) };
+                std::vector<std::string_view> fields{ split({ p, static_cast<size_t>(e - p) }, ' ') };
+
+                p = e + (e < end ? 1 : 0);
+                ++line_count;
+
+                if (fields.empty() || fields[0] == "comment" || fields[0] == "obj_info" || fields[0] == "ply")
+                {
+                    continue;
+                }
+
+                if (fields[0] == "format")
+                {
+                    if (fields.size() < 2 || fields[1] != "ascii")
+                    {
+                        std::cerr << "Error: " << path << " is not an ASCII PLY file" << std::endl;
+                        return false;
+                    }
+                }
+                else if (fields[0] == "element" && fields.size() == 3)
+                {
+                    size_t count{};
+                    std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), count);
+
+                    in_vertex = fields[1] == "vertex" && !found_vertex;
+
+                    if (in_vertex)
+                    {
+                        found_vertex = true;
+                        layout.max_count = count;
+                    }
+                    else if (!found_vertex)
+                    {
+                        // Lines of elements before the vertices
+                        skip_lines += count;
+                    }
+                }
+                else if (fields[0] == "property" && in_vertex)
+                {
+                    if (fields.size() != 3)
+                    {
+                        std::cerr << "Error: " << path << " has a list property on its vertices" << std::endl;
+                        return false;
+                    }
+
+                    properties.emplace_back(fields[2]);
+                }
+                else if (fields[0] == "end_header")
+                {
+                    break;
+                }
+            }
+
+            if (!found_vertex || !named_targets(properties, layout, names))
+            {
+                std::cerr << "Error: " << path << " has no vertex element with x and y" << std::endl;
+                return false;
+            }
+
+            for (; skip_lines > 0 && p < end; --skip_lines)
+            {
+                const char* e{ line_end(p, end) };
+                p = e + (e < end ? 1 : 0);
+                ++line_count;
+            }
+
+            layout.comments = false;
+            layout.begin = p;
+            layout.first_line = line_count;
+
+            return true;
+        }
+
+        bool read_text_header(const std::string& path, AsciiPointFormat format, const char* data, const char* end, AsciiLayout& layout, std::vector<std::string>& names)
+        {
+            const char* p{ data };
+            size_t line_count{ 0 };
+
+            // Skip to the first data line, it decides the delimiter and whether there is a header
+            while (p < end && !is_data(p, line_end(p, end), true))
+            {
+                const char* e{ line_end(p, end) };
+                p = e + (e < end ? 1 : 0);
+                ++line_count;
+            }
+
+            const char* e{ line_end(p, end) };
+            std::string_view line{ p, static_cast<size_t>(e - p) };
+
+            if (format == AsciiPointFormat::Auto)
+            {
+                format = line.find(',') != std::string_view::npos ? AsciiPointFormat::Csv : AsciiPointFormat::Xyz;
+            }
+
+            layout.delimiter = format == AsciiPointFormat::Csv ? ',' : ' ';
+
+            std::vector<std::string_view> fields{ split(line, layout.delimiter) };
+
+            // Header when the first field is not a number
+            double value{};
+            std::string_view first{ fields.empty() ? std::string_view{} : fields[0] };
+            first.remove_prefix(!first.empty() && first[0] == '+' ? 1 : 0);
+
+            bool header{ !fields.empty() && std::from_chars(first.data(), first.data() + first.size(), value).ec != std::errc{} };
+
+            if (header)
+            {
+                if (!named_targets({ fields.begin(), fields.end() }, layout, names))
+                {
+                    std::cerr << "Error: " << path << " has no x and y columns" << std::endl;
+                    return false;
+                }
+
+                p = e + (e < end ? 1 : 0);
+                ++line_count;
+            }
+            else
+            {
+                default_targets(static_cast<int>(fields.size()), layout, names);
+            }
+
+            layout.begin = p;
+            layout.first_line = line_count;
+
+            return true;
+        }
+    }
+
+    bool load_ascii_points(const std::string& path, AsciiPointCloud& cloud, AsciiPointFormat format)
+    {
+        cloud = {};
+
+        MappedFile file{};
+
+        if (!file.open(path))
+        {
+            return false;
+        }
+
+        const char* data{ reinterpret_cast<const char*>(file.data()) };
+        const char* end{ data + file.size() };
+
+        AsciiLayout layout{};
+        layout.end = end;
+
+        if (format == AsciiPointFormat::Auto && file.size() >= 3 && std::memcmp(data, "ply", 3) == 0)
+        {
+            format = AsciiPointFormat::Ply;
+        }
+
+        bool valid{ format == AsciiPointFormat::Ply ?
+            read_ply_header(path, data, end, layout, cloud.attribute_names) :
+            read_text_header(path, format, data, end, layout, cloud.attribute_names) };
+
+        if (!valid)
+        {
+            return false;
+        }
+
+        // One chunk per thread starting after a line break
+        int num_chunks{ static_cast<int>(std::clamp<size_t>((layout.end - layout.begin) >> 20, 1, thread_count())) };
+
+        std::vector<const char*> bounds(num_chunks + 1);
+        bounds[0] = layout.begin;
+        bounds[num_chunks] = layout.end;
+
+        for (int c = 1; c < num_chunks; ++c)
+        {
+            const char* p{ std::max(bounds[c - 1], layout.begin + (layout.end - layout.begin) / num_chunks * c) };
+            const char* e{ line_end(p, layout.end) };
+
+            bounds[c] = e + (e < layout.end ? 1 : 0);
+        }
+
+        // Count the data lines of every chunk to know where it starts in the output
+        std::vector<size_t> offsets(num_chunks + 1);
+        std::vector<size_t> lines(num_chunks + 1);
+
+        parallel_for(0, num_chunks, [&](int begin, int end)
+            {
+                for (int c = begin; c < end; ++c)
+                {
+                    size_t count{ 0 };
+                    size_t line_count{ 0 };
+
+                    for (const char* p = bounds[c]; p < bounds[c + 1]; ++line_count)
+                    {
+                        const char* e{ line_end(p, bounds[c + 1]) };
+                        count += is_data(p, e, layout.comments) ? 1 : 0;
+                        p = e + 1;
+                    }
+
+                    offsets[c + 1] = count;
+                    lines[c + 1] = line_count;
+                }
+            }, 1);
+
+        lines[0] = layout.first_line;
+
+        for (int c = 0; c < num_chunks; ++c)
+        {
+            offsets[c + 1] += offsets[c];
+            lines[c + 1] += lines[c];
+        }
+
+        size_t total{ std::min(offsets[num_chunks], layout.max_count) };
+
+        if (layout.max_count != std::numeric_limits<size_t>::max() && total < layout.max_count)
+        {
+            std::cerr << "Error: " << path << " has " << total << " of its " << layout.max_count << " vertices" << std::endl;
+            return false;
+        }
+
+        int num_attributes{ static_cast<int>(cloud.attribute_names.size()) };
+
+        cloud.points.resize(total);
+        cloud.attributes.assign(num_attributes, std::vector<float>(total));
+
+        // First malformed line of each chunk (0 if none)
+        std::vector<size_t> errors(num_chunks, 0);
+
+        parallel_for(0, num_chunks, [&](int begin, int end)
+            {
+                int columns{ static_cast<int>(layout.targets.size()) };
+                std::vector<double> values(columns);
+
+                for (int c = begin; c < end; ++c)
+                {
+                    size_t index{ offsets[c] };
+                    size_t line{ lines[c] };
+
+                    for (const char* p = bounds[c]; p < bounds[c + 1] && index < total; ++line)
+                    {
+                        const char* e{ line_end(p, bounds[c + 1]) };
+
+                        if (is_data(p, e, layout.comments))
+                        {
+                            int count{ parse_fields(p, e, layout.delimiter, values.data(), columns) };
+
+                            if (count < layout.required)
+                            {
+                                errors[c] = line + 1;
+                                break;
+                            }
+
+                            float coordinates[3]{};
+
+                            for (int k = 0; k < count; ++k)
+                            {
+                                int target{ layout.targets[k] };
+
+                                if (target >= 3)
+                                {
+                                    cloud.attributes[target - 3][index] = static_cast<float>(values[k]);
+                                }
+                                else if (target >= 0)
+                                {
+                                    coordinates[target] = static_cast<float>(values[k]);
+                                }
+                            }
+
+                            cloud.points[index++] = { coordinates[0], coordinates[1], coordinates[2] };
+                        }
+
+                        p = e + 1;
+                    }
+                }
+            }, 1);
+
+        for (size_t error : errors)
+        {
+            if (error != 0)
+            {
+                std::cerr << "Error: Could not parse line " << error << " of " << path << std::endl;
+                cloud = {};
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
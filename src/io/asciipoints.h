@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "mesh.h"
+
+namespace moodysim
+{
+    // Text formats read by load_ascii_points
+    enum class AsciiPointFormat
+    {
+        Auto,  // PLY if the file starts with ply, CSV if the first data line has a comma, XYZ otherwise
+        Xyz,   // Whitespace separated x y [z] [extra columns], # starts a comment line
+        Csv,   // Comma separated with an optional header naming the x, y and z columns
+        Ply    // ASCII PLY, the x, y and z properties of the vertex element
+    };
+
+    // Points read from a text file
+    // Coordinates go straight into the Point3D layout the triangulator takes so points can be moved into
+    // DelaunayGenerator, every other column becomes an attribute stored as its own array
+    struct AsciiPointCloud
+    {
+        std::vector<Point3D> points{};
+
+        std::vector<std::string> attribute_names{};
+        std::vector<std::vector<float>> attributes{};
+    };
+
+    // Map the file at path and parse it into cloud, returns false if it cannot be read or a line is malformed
+    // The data is split at line boundaries into one chunk per thread, the lines of each chunk are counted
+    // to place it in the output, then every chunk is parsed in parallel with from_chars into its own range
+    bool load_ascii_points(const std::string& path, AsciiPointCloud& cloud, AsciiPointFormat format = AsciiPointFormat::Auto);
+}
@@ -0,0 +1,154 @@
+#include "checkpoint.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <span>
+
+#include "meshfile.h"
+
+namespace moodysim
+{
+    namespace
+    {
+        // Scalars of DelaunayState stored in the GeneratorState section
+        struct CheckpointCounters
+        {
+            int32_t num_steiner_points{ 0 };
+            int32_t steiner_placement{ 0 };
+            int32_t num_input_points{ -1 };
+            int32_t next_point{ 0 };
+        };
+
+        template <typename T>
+        MeshSectionData section(MeshSection type, const std::vector<T>& values)
+        {
+            return { type, sizeof(T), values.size(), values.data() };
+        }
+
+        // Copy the section into values, returns false if its elements are not the size of T
+        template <typename T>
+        bool read_section(const MappedFile& file, const MeshSectionEntry& entry, std::vector<T>& values)
+        {
+            if (entry.element_size != sizeof(T))
+            {
+                return false;
+            }
+
+            values.resize(entry.count);
+            std::memcpy(values.data(), file.data() + entry.offset, entry.count * sizeof(T));
+
+            return true;
+        }
+    }
+
+    bool write_checkpoint(const std::string& path, const DelaunayState& state)
+    {
+        std::vector<CheckpointCounters> counters{ {
+            state.num_steiner_points,
+            static_cast<int32_t>(state.steiner_placement),
+            state.num_input_points,
+            state.next_point } };
+
+        std::vector<MeshSectionData> sections{
+            section(MeshSection::GeneratorState, counters),
+            section(MeshSection::Points, state.points),
+            section(MeshSection::PointOrdering, state.point_ordering),
+            section(MeshSection::Edges, state.edges),
+            section(MeshSection::Holes, state.holes),
+            section(MeshSection::Triangles, state.triangles),
+            section(MeshSection::Neighbors, state.neighbors),
+            section(MeshSection::VertexTriangles, state.vertex_triangles),
+            section(MeshSection::ConstrainedEdges, state.constrained_edges) };
+
+        std::string temporary{ path + ".tmp" };
+
+        if (!write_mesh_sections(temporary, sections))
+        {
+            return false;
+        }
+
+        std::error_code error{};
+        std::filesystem::rename(temporary, path, error);
+
+        if (error)
+        {
+            std::cerr << "Error: Could not replace " << path << ": " << error.message() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool read_checkpoint(const std::string& path, DelaunayState& state)
+    {
+        MappedFile file{};
+
+        if (!file.open(path))
+        {
+            return false;
+        }
+
+        std::vector<MeshSectionEntry> entries{};
+
+        if (!read_mesh_sections(path, file, entries))
+        {
+            return false;
+        }
+
+        std::vector<CheckpointCounters> counters{};
+        bool valid{ true };
+
+        for (const auto& entry : entries)
+        {
+            switch (entry.type)
+            {
+            case MeshSection::GeneratorState: valid = valid && read_section(file, entry, counters); break;
+            case MeshSection::Points: valid = valid && read_section(file, entry, state.points); break;
+            case MeshSection::PointOrdering: valid = valid && read_section(file, entry, state.point_ordering); break;
+            case MeshSection::Edges: valid = valid && read_section(file, entry, state.edges); break;
+            case MeshSection::Holes: valid = valid && read_section(file, entry, state.holes); break;
+            case MeshSection::Triangles: valid = valid && read_section(file, entry, state.triangles); break;
+            case MeshSection::Neighbors: valid = valid && read_section(file, entry, state.neighbors); break;
+            case MeshSection::VertexTriangles: valid = valid && read_section(file, entry, state.vertex_triangles); break;
+            case MeshSection::ConstrainedEdges: valid = valid && read_section(file, entry, state.constrained_edges); break;
+            default: break;
+            }
+        }
+
+        if (!valid || counters.size() != 1 || state.neighbors.size() != state.triangles.size())
+        {
+            std::cerr << "Error: " << path << " is not a complete checkpoint" << std::endl;
+            return false;
+        }
+
+        state.num_steiner_points = counters[0].num_steiner_points;
+        state.steiner_placement = static_cast<SteinerPlacement>(counters[0].steiner_placement);
+        state.num_input_points = counters[0].num_input_points;
+        state.next_point = counters[0].next_point;
+
+        return true;
+    }
+
+    CheckpointWriter::CheckpointWriter(std::string path)
+        : path_(std::move(path)), writer_([this](DelaunayState& state) { return write_checkpoint(path_, state); })
+    {
+    }
+
+    void CheckpointWriter::submit(const DelaunayGenerator& generator)
+    {
+        // A snapshot still waiting is replaced by this newer one
+        generator.get_state(writer_.acquire(true));
+        writer_.submit();
+    }
+
+    bool CheckpointWriter::flush()
+    {
+        return writer_.flush();
+    }
+
+    int CheckpointWriter::get_num_written() const
+    {
+        return writer_.get_num_written();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "mesh.h"
+#include "doublebuffer.h"
+
+namespace moodysim
+{
+    // Save state in the sectioned mesh file format, the file is written next to path and renamed
+    // over it at the end so an interrupted write leaves the previous checkpoint intact
+    bool write_checkpoint(const std::string& path, const DelaunayState& state);
+
+    bool read_checkpoint(const std::string& path, DelaunayState& state);
+
+    // Writes snapshots of a DelaunayGenerator to a checkpoint file on a background thread
+    // Submitting copies the state into whichever of two buffers is not being written, a snapshot
+    // still waiting is replaced by the newer one so the generator only waits for the copy
+    class CheckpointWriter
+    {
+    public:
+
+        explicit CheckpointWriter(std::string path);
+
+        // Pass to DelaunayGenerator::set_checkpoint as [&](const DelaunayGenerator& g) { writer.submit(g); }
+        void submit(const DelaunayGenerator& generator);
+
+        // Wait until every submitted snapshot is written, returns false if a write failed
+        bool flush();
+
+        int get_num_written() const;
+
+    private:
+
+        std::string path_{};
+
+        // Writes the snapshot still waiting when destroyed
+        DoubleBufferedWriter<DelaunayState> writer_;
+    };
+}
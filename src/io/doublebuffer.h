@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace moodysim
+{
+    // Writes buffers on a background thread in the order they were submitted
+    // Two buffers alternate so the caller fills one while the other is being written
+    template <typename Buffer>
+    class DoubleBufferedWriter
+    {
+    public:
+
+        // write is called on the background thread with each submitted buffer, returns false if it failed
+        explicit DoubleBufferedWriter(std::function<bool(Buffer&)> write)
+            : write_(std::move(write))
+        {
+            thread_ = std::thread{ [this]() { run(); } };
+        }
+
+        DoubleBufferedWriter(const DoubleBufferedWriter&) = delete;
+        DoubleBufferedWriter& operator=(const DoubleBufferedWriter&) = delete;
+
+        // Writes the buffer still waiting before returning
+        ~DoubleBufferedWriter()
+        {
+            {
+                std::lock_guard lock{ mutex_ };
+                stop_ = true;
+            }
+
+            condition_.notify_all();
+            thread_.join();
+        }
+
+        // The buffer that is not being written, to fill and then submit
+        // Waits until the buffer waiting to be written has started, or drops it when replace is set
+        Buffer& acquire(bool replace = false)
+        {
+            std::unique_lock lock{ mutex_ };
+
+            if (!replace)
+            {
+                condition_.wait(lock, [this]() { return pending_ == -1; });
+            }
+
+            acquired_ = writing_ == 0 ? 1 : 0;
+            pending_ = pending_ == acquired_ ? -1 : pending_;
+
+            // The writer thread never touches a buffer that is neither writing nor pending
+            return buffers_[acquired_];
+        }
+
+        // Queue the buffer returned by the last acquire
+        void submit()
+        {
+            {
+                std::lock_guard lock{ mutex_ };
+                pending_ = acquired_;
+                acquired_ = -1;
+            }
+
+            condition_.notify_all();
+        }
+
+        // Wait until every submitted buffer is written, returns false if a write failed
+        bool flush()
+        {
+            std::unique_lock lock{ mutex_ };
+            condition_.wait(lock, [this]() { return pending_ == -1 && writing_ == -1; });
+
+            return !failed_;
+        }
+
+        int get_num_written() const
+        {
+            std::lock_guard lock{ mutex_ };
+            return num_written_;
+        }
+
+    private:
+
+        void run()
+        {
+            std::unique_lock lock{ mutex_ };
+
+            while (true)
+            {
+                condition_.wait(lock, [this]() { return pending_ != -1 || stop_; });
+
+                // Finish the last buffer before stopping
+                if (pending_ == -1)
+                {
+                    break;
+                }
+
+                writing_ = pending_;
+                pending_ = -1;
+
+                // Wakes a caller waiting in acquire for the other buffer
+                condition_.notify_all();
+
+                lock.unlock();
+                bool written{ write_(buffers_[writing_]) };
+                lock.lock();
+
+                writing_ = -1;
+                failed_ = failed_ || !written;
+                num_written_ += written ? 1 : 0;
+
+                condition_.notify_all();
+            }
+        }
+
+        std::function<bool(Buffer&)> write_{};
+
+        Buffer buffers_[2]{};
+
+        // Buffer being written, buffer waiting to be written, and buffer being filled (-1 for none)
+        int writing_{ -1 };
+        int pending_{ -1 };
+        int acquired_{ -1 };
+
+        int num_written_{ 0 };
+        bool failed_{ false };
+        bool stop_{ false };
+
+        mutable std::mutex mutex_{};
+        std::condition_variable condition_{};
+
+        std::thread thread_{};
+    };
+}
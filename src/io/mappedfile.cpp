@@ -0,0 +1,169 @@
+#include "mappedfile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace moodysim
+{
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+#ifdef _WIN32
+        , file_(std::exchange(other.file_, nullptr)), mapping_(std::exchange(other.mapping_, nullptr))
+#endif
+    {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+            file_ = std::exchange(other.file_, nullptr);
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+#ifdef _WIN32
+
+    bool MappedFile::open(const std::string& path, bool sequential)
+    {
+        close();
+
+        DWORD flags{ sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL };
+        HANDLE file{ CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr) };
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "Error: Could not open " << path << std::endl;
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        GetFileSizeEx(file, &size);
+
+        // An empty file cannot be mapped but is still a valid file
+        if (size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            std::cerr << "Error: " << path << " is empty" << std::endl;
+            return false;
+        }
+
+        HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        void* view{ mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr };
+
+        if (!view)
+        {
+            if (mapping)
+            {
+                CloseHandle(mapping);
+            }
+
+            CloseHandle(file);
+            std::cerr << "Error: Could not map " << path << std::endl;
+            return false;
+        }
+
+        file_ = file;
+        mapping_ = mapping;
+        data_ = static_cast<const std::byte*>(view);
+        size_ = static_cast<size_t>(size.QuadPart);
+
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (data_)
+        {
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+            CloseHandle(file_);
+        }
+
+        data_ = nullptr;
+        size_ = 0;
+        file_ = nullptr;
+        mapping_ = nullptr;
+    }
+
+#else
+
+    bool MappedFile::open(const std::string& path, bool sequential)
+    {
+        close();
+
+        int file{ ::open(path.c_str(), O_RDONLY) };
+
+        if (file < 0)
+        {
+            std::cerr << "Error: Could not open " << path << std::endl;
+            return false;
+        }
+
+        struct stat status{};
+
+        if (fstat(file, &status) != 0 || status.st_size == 0)
+        {
+            ::close(file);
+            std::cerr << "Error: " << path << " is empty or cannot be read" << std::endl;
+            return false;
+        }
+
+        void* view{ mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0) };
+
+        // The mapping keeps the file alive on its own
+        ::close(file);
+
+        if (view == MAP_FAILED)
+        {
+            std::cerr << "Error: Could not map " << path << std::endl;
+            return false;
+        }
+
+        if (sequential)
+        {
+            madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+        }
+
+        data_ = static_cast<const std::byte*>(view);
+        size_ = static_cast<size_t>(status.st_size);
+
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (data_)
+        {
+            munmap(const_cast<std::byte*>(data_), size_);
+        }
+
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace moodysim
+{
+    // Read-only memory mapping of a whole file, pages are loaded by the OS on first touch
+    // so large files are never read into a buffer of their own
+    class MappedFile
+    {
+    public:
+
+        MappedFile() = default;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        // Map the file at path replacing any current mapping, returns false if it cannot be opened or mapped
+        // Pass sequential when the file is read front to back so the OS reads ahead more aggressively
+        bool open(const std::string& path, bool sequential = true);
+
+        void close();
+
+        bool is_open() const { return data_ != nullptr; }
+
+        const std::byte* data() const { return data_; }
+
+        size_t size() const { return size_; }
+
+    private:
+
+        const std::byte* data_{ nullptr };
+        size_t size_{ 0 };
+
+#ifdef _WIN32
+        void* file_{ nullptr };
+        void* mapping_{ nullptr };
+#endif
+    };
+}
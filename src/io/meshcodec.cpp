@@ -0,0 +1,417 @@
+#include "meshcodec.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    namespace
+    {
+        // Rotate so the smallest index comes first, which keeps the orientation
+        std::array<unsigned int, 3> rotate_smallest_first(std::array<unsigned int, 3> triangle)
+        {
+            while (triangle[0] > triangle[1] || triangle[0] > triangle[2])
+            {
+                triangle = { triangle[1], triangle[2], triangle[0] };
+            }
+
+            return triangle;
+        }
+
+        void write_varint(std::vector<std::byte>& out, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<std::byte>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+
+            out.push_back(static_cast<std::byte>(value));
+        }
+
+        // Returns false when the stream ends early or the value does not fit
+        inline bool read_varint(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+        {
+            // Almost every delta fits in one byte
+            if (p < end && *p < 0x80)
+            {
+                value = *p++;
+                return true;
+            }
+
+            uint64_t result{ 0 };
+
+            for (int shift = 0; p < end && shift < 35; shift += 7)
+            {
+                uint8_t byte{ *p++ };
+                result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+
+                if (byte < 0x80)
+                {
+                    value = static_cast<uint32_t>(result);
+                    return result <= std::numeric_limits<uint32_t>::max();
+                }
+            }
+
+            return false;
+        }
+
+        uint32_t zigzag(int64_t value)
+        {
+            return static_cast<uint32_t>(value < 0 ? 2 * (-value) - 1 : 2 * value);
+        }
+
+        int64_t unzigzag(uint32_t value)
+        {
+            return (value & 1) ? -static_cast<int64_t>((value + 1) / 2) : static_cast<int64_t>(value / 2);
+        }
+
+        // Position component = min + quantized * step for vertices [begin, end)
+        template <typename Q>
+        void dequantize(const std::byte* plane, float min, float step, float SMVertex::* member, std::vector<SMVertex>& vertices, int begin, int end)
+        {
+            for (int v = begin; v < end; ++v)
+            {
+                Q value{};
+                std::memcpy(&value, plane + v * sizeof(Q), sizeof(Q));
+
+                vertices[v].*member = min + static_cast<float>(value) * step;
+            }
+        }
+
+        template <typename T>
+        void append(std::vector<std::byte>& out, const T& value)
+        {
+            size_t size{ out.size() };
+            out.resize(size + sizeof(T));
+            std::memcpy(out.data() + size, &value, sizeof(T));
+        }
+    }
+
+    std::vector<std::byte> encode_mesh(const SurfaceMeshData& mesh, int position_bits)
+    {
+        if (position_bits < 1 || position_bits > 32)
+        {
+            std::cerr << "Error: Position bits must be between 1 and 32" << std::endl;
+            return {};
+        }
+
+        auto vertices{ mesh.get_vertices() };
+        auto indices{ mesh.get_indices() };
+
+        size_t num_vertices{ vertices.size() };
+        size_t num_triangles{ indices.size() / 3 };
+
+        // Sort the triangles, number the vertices in order of first use, then sort again in the new numbering
+        // so consecutive triangles start at nearby vertices and share most of theirs
+        std::vector<std::array<unsigned int, 3>> triangles(num_triangles);
+
+        for (size_t t = 0; t < num_triangles; ++t)
+        {
+            triangles[t] = rotate_smallest_first({ indices[3 * t], indices[3 * t + 1], indices[3 * t + 2] });
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+
+        constexpr unsigned int unused{ std::numeric_limits<unsigned int>::max() };
+
+        std::vector<unsigned int> remap(num_vertices, unused);
+        unsigned int next{ 0 };
+
+        for (const auto& triangle : triangles)
+        {
+            for (unsigned int v : triangle)
+            {
+                if (remap[v] == unused)
+                {
+                    remap[v] = next++;
+                }
+            }
+        }
+
+        // Vertices without triangles go at the end
+        for (auto& index : remap)
+        {
+            index = index == unused ? next++ : index;
+        }
+
+        for (auto& triangle : triangles)
+        {
+            triangle = rotate_smallest_first({ remap[triangle[0]], remap[triangle[1]], remap[triangle[2]] });
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+
+        std::vector<SMVertex> ordered(num_vertices);
+
+        for (size_t v = 0; v < num_vertices; ++v)
+        {
+            ordered[remap[v]] = vertices[v];
+        }
+
+        MeshCodecHeader header{};
+        header.position_bits = position_bits;
+        header.num_vertices = num_vertices;
+        header.num_triangles = num_triangles;
+        header.num_blocks = static_cast<uint32_t>((num_triangles + mesh_codec_block_size - 1) / mesh_codec_block_size);
+
+        float max[3]{};
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.min[axis] = num_vertices > 0 ? std::numeric_limits<float>::max() : 0.f;
+            max[axis] = num_vertices > 0 ? std::numeric_limits<float>::lowest() : 0.f;
+        }
+
+        for (const auto& vertex : ordered)
+        {
+            const float position[3]{ vertex.x, vertex.y, vertex.z };
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                header.min[axis] = std::min(header.min[axis], position[axis]);
+                max[axis] = std::max(max[axis], position[axis]);
+            }
+
+            header.has_colors = header.has_colors || vertex.r != 0.f || vertex.g != 0.f || vertex.b != 0.f;
+        }
+
+        double levels{ std::ldexp(1.0, position_bits) - 1.0 };
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.step[axis] = static_cast<float>((static_cast<double>(max[axis]) - header.min[axis]) / levels);
+        }
+
+        std::vector<std::byte> out{};
+        append(out, header);
+
+        // Quantize against the stored step so decoding reproduces the rounding exactly
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (const auto& vertex : ordered)
+            {
+                const float position[3]{ vertex.x, vertex.y, vertex.z };
+
+                double step{ header.step[axis] };
+                double q{ step > 0.0 ? std::round((position[axis] - static_cast<double>(header.min[axis])) / step) : 0.0 };
+
+                q = std::clamp(q, 0.0, levels);
+
+                if (position_bits <= 16)
+                {
+                    append(out, static_cast<uint16_t>(q));
+                }
+                else
+                {
+                    append(out, static_cast<uint32_t>(q));
+                }
+            }
+        }
+
+        if (header.has_colors)
+        {
+            for (const auto& vertex : ordered)
+            {
+                for (float channel : { vertex.r, vertex.g, vertex.b })
+                {
+                    append(out, static_cast<uint8_t>(std::lround(std::clamp(channel, 0.f, 1.f) * 255.f)));
+                }
+            }
+        }
+
+        // Blocks are encoded in parallel, each starting from vertex 0 so it decodes on its own
+        int num_blocks{ static_cast<int>(header.num_blocks) };
+        std::vector<std::vector<std::byte>> blocks(num_blocks);
+
+        parallel_for(0, num_blocks, [&](int begin, int end)
+            {
+                for (int b = begin; b < end; ++b)
+                {
+                    size_t first{ b * mesh_codec_block_size };
+                    size_t last{ std::min(num_triangles, first + mesh_codec_block_size) };
+
+                    auto& stream{ blocks[b] };
+                    stream.reserve(4 * (last - first));
+
+                    unsigned int previous{ 0 };
+
+                    for (size_t t = first; t < last; ++t)
+                    {
+                        const auto& triangle{ triangles[t] };
+
+                        // The first index only grows, the second is above it, the third may be on either side of the second
+                        write_varint(stream, triangle[0] - previous);
+                        write_varint(stream, triangle[1] - triangle[0]);
+                        write_varint(stream, zigzag(static_cast<int64_t>(triangle[2]) - triangle[1]));
+
+                        previous = triangle[0];
+                    }
+                }
+            }, 1);
+
+        uint64_t offset{ 0 };
+
+        for (const auto& stream : blocks)
+        {
+            append(out, offset);
+            offset += stream.size();
+        }
+
+        for (const auto& stream : blocks)
+        {
+            out.insert(out.end(), stream.begin(), stream.end());
+        }
+
+        return out;
+    }
+
+    std::optional<SurfaceMeshData> decode_mesh(std::span<const std::byte> data)
+    {
+        MeshCodecHeader header{};
+        MeshCodecHeader expected{};
+
+        if (data.size() < sizeof(MeshCodecHeader))
+        {
+            std::cerr << "Error: Encoded mesh is too small" << std::endl;
+            return std::nullopt;
+        }
+
+        std::memcpy(&header, data.data(), sizeof(MeshCodecHeader));
+
+        if (std::memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0 || header.version != expected.version ||
+            header.position_bits < 1 || header.position_bits > 32)
+        {
+            std::cerr << "Error: Not a version " << expected.version << " encoded mesh" << std::endl;
+            return std::nullopt;
+        }
+
+        size_t num_vertices{ static_cast<size_t>(header.num_vertices) };
+        size_t num_triangles{ static_cast<size_t>(header.num_triangles) };
+        size_t scalar_size{ header.position_bits <= 16 ? sizeof(uint16_t) : sizeof(uint32_t) };
+
+        size_t positions_size{ 3 * scalar_size * num_vertices };
+        size_t colors_size{ header.has_colors ? 3 * num_vertices : 0 };
+        size_t offsets_size{ sizeof(uint64_t) * header.num_blocks };
+
+        // Limits checked one at a time so corrupt counts cannot overflow the sums
+        size_t available{ data.size() - sizeof(MeshCodecHeader) };
+
+        if (num_vertices > available / (3 * scalar_size) || num_triangles > available / 3 ||
+            header.num_blocks != (num_triangles + mesh_codec_block_size - 1) / mesh_codec_block_size ||
+            available < positions_size + colors_size + offsets_size)
+        {
+            std::cerr << "Error: Encoded mesh is truncated" << std::endl;
+            return std::nullopt;
+        }
+
+        const std::byte* positions{ data.data() + sizeof(MeshCodecHeader) };
+        const uint8_t* colors{ reinterpret_cast<const uint8_t*>(positions + positions_size) };
+        const std::byte* offsets{ positions + positions_size + colors_size };
+
+        const uint8_t* stream{ reinterpret_cast<const uint8_t*>(offsets + offsets_size) };
+        size_t stream_size{ available - positions_size - colors_size - offsets_size };
+
+        std::vector<SMVertex> vertices(num_vertices);
+
+        parallel_for(0, static_cast<int>(num_vertices), [&](int begin, int end)
+            {
+                float SMVertex::* const members[3]{ &SMVertex::x, &SMVertex::y, &SMVertex::z };
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const std::byte* plane{ positions + axis * scalar_size * num_vertices };
+
+                    if (scalar_size == sizeof(uint16_t))
+                    {
+                        dequantize<uint16_t>(plane, header.min[axis], header.step[axis], members[axis], vertices, begin, end);
+                    }
+                    else
+                    {
+                        dequantize<uint32_t>(plane, header.min[axis], header.step[axis], members[axis], vertices, begin, end);
+                    }
+                }
+
+                if (header.has_colors)
+                {
+                    for (int v = begin; v < end; ++v)
+                    {
+                        vertices[v].r = colors[3 * v] / 255.f;
+                        vertices[v].g = colors[3 * v + 1] / 255.f;
+                        vertices[v].b = colors[3 * v + 2] / 255.f;
+                    }
+                }
+            });
+
+        std::vector<unsigned int> indices(3 * num_triangles);
+
+        int num_blocks{ static_cast<int>(header.num_blocks) };
+        std::vector<char> valid(num_blocks, 1);
+
+        parallel_for(0, num_blocks, [&](int begin, int end)
+            {
+                for (int b = begin; b < end; ++b)
+                {
+                    uint64_t first_byte{};
+                    uint64_t last_byte{ stream_size };
+
+                    std::memcpy(&first_byte, offsets + b * sizeof(uint64_t), sizeof(uint64_t));
+
+                    if (b + 1 < num_blocks)
+                    {
+                        std::memcpy(&last_byte, offsets + (b + 1) * sizeof(uint64_t), sizeof(uint64_t));
+                    }
+
+                    if (first_byte > last_byte || last_byte > stream_size)
+                    {
+                        valid[b] = 0;
+                        continue;
+                    }
+
+                    const uint8_t* p{ stream + first_byte };
+                    const uint8_t* stream_end{ stream + last_byte };
+
+                    size_t first{ b * mesh_codec_block_size };
+                    size_t last{ std::min(num_triangles, first + mesh_codec_block_size) };
+
+                    uint32_t previous{ 0 };
+                    bool ok{ true };
+
+                    for (size_t t = first; t < last && ok; ++t)
+                    {
+                        uint32_t da{}, db{}, dc{};
+
+                        ok = read_varint(p, stream_end, da) && read_varint(p, stream_end, db) && read_varint(p, stream_end, dc);
+
+                        int64_t a{ static_cast<int64_t>(previous) + da };
+                        int64_t bb{ a + db };
+                        int64_t c{ bb + unzigzag(dc) };
+
+                        ok = ok && bb < static_cast<int64_t>(num_vertices) && c >= 0 && c < static_cast<int64_t>(num_vertices);
+
+                        indices[3 * t] = static_cast<unsigned int>(a);
+                        indices[3 * t + 1] = static_cast<unsigned int>(bb);
+                        indices[3 * t + 2] = static_cast<unsigned int>(c);
+
+                        previous = static_cast<uint32_t>(a);
+                    }
+
+                    valid[b] = ok ? 1 : 0;
+                }
+            }, 1);
+
+        if (std::find(valid.begin(), valid.end(), 0) != valid.end())
+        {
+            std::cerr << "Error: Encoded mesh has a corrupt index stream" << std::endl;
+            return std::nullopt;
+        }
+
+        return SurfaceMeshData{ std::move(vertices), std::move(indices) };
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+#include "surfacemeshdata.h"
+
+namespace moodysim
+{
+    // Start of an encoded mesh
+    // Followed by the quantized positions as three planes (x, y, z) of uint16 when position_bits is at most 16
+    // or uint32 otherwise, the colors as 8 bit triples when has_colors is set, the byte offset of each
+    // block of triangles in the index stream, and the index stream
+    struct MeshCodecHeader
+    {
+        char magic[4]{ 'M', 'Q', 'S', 'H' };
+        uint32_t version{ 1 };
+        uint32_t position_bits{ 16 };
+        uint32_t has_colors{ 0 };
+        uint64_t num_vertices{ 0 };
+        uint64_t num_triangles{ 0 };
+
+        // Position = min + quantized * step on each axis
+        float min[3]{};
+        float step[3]{};
+
+        uint32_t num_blocks{ 0 };
+        uint32_t reserved{ 0 };
+    };
+
+    static_assert(sizeof(MeshCodecHeader) == 64);
+
+    // Triangles per independently decodable block of the index stream
+    constexpr size_t mesh_codec_block_size{ 1 << 16 };
+
+    // Compress mesh for storage or transfer, positions are quantized to position_bits (1 to 32) per axis
+    // within the bounding box so they are off by at most half a step
+    // Triangles are sorted and vertices renumbered in order of first use so the indices of each
+    // triangle are stored as small deltas in zigzag varints, the mesh comes back in this order
+    std::vector<std::byte> encode_mesh(const SurfaceMeshData& mesh, int position_bits = 16);
+
+    // Decode data from encode_mesh, blocks of triangles and the positions are decoded in parallel
+    // Returns nothing if data is not a valid encoded mesh
+    std::optional<SurfaceMeshData> decode_mesh(std::span<const std::byte> data);
+}
@@ -0,0 +1,578 @@
+#include "meshexport.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+
+#include "parallel.h"
+#include "doublebuffer.h"
+
+namespace moodysim
+{
+    namespace
+    {
+        // Growable output buffer cleared and reused for every chunk
+        class ExportBuffer
+        {
+        public:
+
+            void clear() { size_ = 0; }
+
+            const char* data() const { return data_.data(); }
+
+            size_t size() const { return size_; }
+
+            void put(std::string_view text)
+            {
+                std::memcpy(reserve(text.size()), text.data(), text.size());
+                size_ += text.size();
+            }
+
+            void put(char c)
+            {
+                *reserve(1) = c;
+                ++size_;
+            }
+
+            // Shortest text that reads back to the same float
+            void put(float value)
+            {
+                char* out{ reserve(max_number_size) };
+                size_ = std::to_chars(out, out + max_number_size, value).ptr - data_.data();
+            }
+
+            void put(uint64_t value)
+            {
+                char* out{ reserve(max_number_size) };
+                size_ = std::to_chars(out, out + max_number_size, value).ptr - data_.data();
+            }
+
+            // Raw bytes of value in the given byte order
+            template <typename T>
+            void put_binary(T value, bool big_endian = false)
+            {
+                char* out{ reserve(sizeof(T)) };
+                std::memcpy(out, &value, sizeof(T));
+
+                if (big_endian != (std::endian::native == std::endian::big))
+                {
+                    std::reverse(out, out + sizeof(T));
+                }
+
+                size_ += sizeof(T);
+            }
+
+        private:
+
+            static constexpr size_t max_number_size{ 32 };
+
+            char* reserve(size_t count)
+            {
+                if (size_ + count > data_.size())
+                {
+                    data_.resize(std::max(2 * data_.size(), size_ + count + (1 << 16)));
+                }
+
+                return data_.data() + size_;
+            }
+
+            std::vector<char> data_{};
+            size_t size_{ 0 };
+        };
+
+        // Chunks formatted together and written in order
+        struct ChunkBatch
+        {
+            std::vector<ExportBuffer> chunks{};
+            int num_chunks{ 0 };
+        };
+
+        // Formats chunks of items in parallel and hands them to a writer thread in order
+        // Two batches alternate so one is written while the next is formatted
+        class ChunkWriter
+        {
+        public:
+
+            explicit ChunkWriter(std::ofstream& file)
+                : file_(file), writer_([this](ChunkBatch& batch) { return write_batch(batch); })
+            {}
+
+            // Call format(i, buffer) for every item in [0, count)
+            template <typename Format>
+            void write(size_t count, Format&& format)
+            {
+                constexpr size_t chunk_size{ 1 << 14 };
+
+                size_t batch_size{ chunk_size * thread_count() };
+
+                for (size_t batch = 0; batch < count; batch += batch_size)
+                {
+                    ChunkBatch& buffers{ writer_.acquire() };
+
+                    buffers.num_chunks = static_cast<int>((std::min(count - batch, batch_size) + chunk_size - 1) / chunk_size);
+                    buffers.chunks.resize(std::max<size_t>(buffers.chunks.size(), buffers.num_chunks));
+
+                    parallel_for(0, buffers.num_chunks, [&](int begin, int end)
+                        {
+                            for (int c = begin; c < end; ++c)
+                            {
+                                size_t first{ batch + c * chunk_size };
+                                size_t last{ std::min(count, first + chunk_size) };
+
+                                ExportBuffer& buffer{ buffers.chunks[c] };
+                                buffer.clear();
+
+                                for (size_t i = first; i < last; ++i)
+                                {
+                                    format(i, buffer);
+                                }
+                            }
+                        }, 1);
+
+                    writer_.submit();
+                }
+            }
+
+            // Write text directly, after everything queued before it
+            void write(std::string_view text)
+            {
+                writer_.flush();
+                file_.write(text.data(), text.size());
+            }
+
+        private:
+
+            bool write_batch(const ChunkBatch& batch)
+            {
+                for (int c = 0; c < batch.num_chunks; ++c)
+                {
+                    file_.write(batch.chunks[c].data(), batch.chunks[c].size());
+                }
+
+                return static_cast<bool>(file_);
+            }
+
+            std::ofstream& file_;
+
+            // Writes the batch still waiting when destroyed
+            DoubleBufferedWriter<ChunkBatch> writer_;
+        };
+
+        SMVertex face_normal(const SMVertex& a, const SMVertex& b, const SMVertex& c)
+        {
+            float ux{ b.x - a.x }, uy{ b.y - a.y }, uz{ b.z - a.z };
+            float vx{ c.x - a.x }, vy{ c.y - a.y }, vz{ c.z - a.z };
+
+            float nx{ uy * vz - uz * vy };
+            float ny{ uz * vx - ux * vz };
+            float nz{ ux * vy - uy * vx };
+
+            float length{ std::sqrt(nx * nx + ny * ny + nz * nz) };
+            float scale{ length > 0.f ? 1.f / length : 0.f };
+
+            return { nx * scale, ny * scale, nz * scale };
+        }
+
+        void write_obj(ChunkWriter& writer, const SurfaceMeshData& mesh)
+        {
+            auto vertices{ mesh.get_vertices() };
+            auto indices{ mesh.get_indices() };
+
+            writer.write(vertices.size(), [&](size_t i, ExportBuffer& out)
+                {
+                    out.put("v ");
+                    out.put(vertices[i].x);
+                    out.put(' ');
+                    out.put(vertices[i].y);
+                    out.put(' ');
+                    out.put(vertices[i].z);
+                    out.put('\n');
+                });
+
+            // OBJ indices start at 1
+            writer.write(indices.size() / 3, [&](size_t t, ExportBuffer& out)
+                {
+                    out.put('f');
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        out.put(' ');
+                        out.put(static_cast<uint64_t>(indices[3 * t + k]) + 1);
+                    }
+
+                    out.put('\n');
+                });
+        }
+
+        void write_ply(ChunkWriter& writer, const SurfaceMeshData& mesh, bool binary, const std::vector<ScalarField>& fields)
+        {
+            auto vertices{ mesh.get_vertices() };
+            auto indices{ mesh.get_indices() };
+
+            std::string header{ "ply\nformat " };
+            header += binary ? "binary_little_endian 1.0\n" : "ascii 1.0\n";
+            header += "element vertex " + std::to_string(vertices.size()) + "\n";
+            header += "property float x\nproperty float y\nproperty float z\n";
+
+            for (const auto& field : fields)
+            {
+                header += "property float " + field.name + "\n";
+            }
+
+            header += "element face " + std::to_string(indices.size() / 3) + "\n";
+            header += "property list uchar uint vertex_indices\nend_header\n";
+
+            writer.write(header);
+
+            writer.write(vertices.size(), [&](size_t i, ExportBuffer& out)
+                {
+                    if (binary)
+                    {
+                        out.put_binary(vertices[i].x);
+                        out.put_binary(vertices[i].y);
+                        out.put_binary(vertices[i].z);
+
+                        for (const auto& field : fields)
+                        {
+                            out.put_binary(field.values[i]);
+                        }
+
+                        return;
+                    }
+
+                    out.put(vertices[i].x);
+                    out.put(' ');
+                    out.put(vertices[i].y);
+                    out.put(' ');
+                    out.put(vertices[i].z);
+
+                    for (const auto& field : fields)
+                    {
+                        out.put(' ');
+                        out.put(field.values[i]);
+                    }
+
+                    out.put('\n');
+                });
+
+            writer.write(indices.size() / 3, [&](size_t t, ExportBuffer& out)
+                {
+                    if (binary)
+                    {
+                        out.put_binary(uint8_t{ 3 });
+
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            out.put_binary(indices[3 * t + k]);
+                        }
+
+                        return;
+                    }
+
+                    out.put('3');
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        out.put(' ');
+                        out.put(static_cast<uint64_t>(indices[3 * t + k]));
+                    }
+
+                    out.put('\n');
+                });
+        }
+
+        // Legacy VTK binary data is big endian
+        void write_vtk(ChunkWriter& writer, const SurfaceMeshData& mesh, bool binary, const std::vector<ScalarField>& fields)
+        {
+            auto vertices{ mesh.get_vertices() };
+            auto indices{ mesh.get_indices() };
+
+            size_t num_triangles{ indices.size() / 3 };
+
+            std::string header{ "# vtk DataFile Version 3.0\nmoodysim mesh\n" };
+            header += binary ? "BINARY\n" : "ASCII\n";
+            header += "DATASET POLYDATA\nPOINTS " + std::to_string(vertices.size()) + " float\n";
+
+            writer.write(header);
+
+            writer.write(vertices.size(), [&](size_t i, ExportBuffer& out)
+                {
+                    if (binary)
+                    {
+                        out.put_binary(vertices[i].x, true);
+                        out.put_binary(vertices[i].y, true);
+                        out.put_binary(vertices[i].z, true);
+                        return;
+                    }
+
+                    out.put(vertices[i].x);
+                    out.put(' ');
+                    out.put(vertices[i].y);
+                    out.put(' ');
+                    out.put(vertices[i].z);
+                    out.put('\n');
+                });
+
+            writer.write("\nPOLYGONS " + std::to_string(num_triangles) + " " + std::to_string(4 * num_triangles) + "\n");
+
+            writer.write(num_triangles, [&](size_t t, ExportBuffer& out)
+                {
+                    if (binary)
+                    {
+                        out.put_binary(int32_t{ 3 }, true);
+
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            out.put_binary(static_cast<int32_t>(indices[3 * t + k]), true);
+                        }
+
+                        return;
+                    }
+
+                    out.put('3');
+
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        out.put(' ');
+                        out.put(static_cast<uint64_t>(indices[3 * t + k]));
+                    }
+
+                    out.put('\n');
+                });
+
+            if (!fields.empty())
+            {
+                writer.write("\nPOINT_DATA " + std::to_string(vertices.size()) + "\n");
+            }
+
+            for (const auto& field : fields)
+            {
+                writer.write("SCALARS " + field.name + " float 1\nLOOKUP_TABLE default\n");
+
+                writer.write(vertices.size(), [&](size_t i, ExportBuffer& out)
+                    {
+                        if (binary)
+                        {
+                            out.put_binary(field.values[i], true);
+                            return;
+                        }
+
+                        out.put(field.values[i]);
+                        out.put('\n');
+                    });
+
+                writer.write("\n");
+            }
+        }
+
+        // Arrays follow the XML in the order they are declared, each after its size in bytes
+        void write_vtu(ChunkWriter& writer, const SurfaceMeshData& mesh, const std::vector<ScalarField>& fields)
+        {
+            auto vertices{ mesh.get_vertices() };
+            auto indices{ mesh.get_indices() };
+
+            size_t num_triangles{ indices.size() / 3 };
+
+            uint64_t points_size{ 3 * sizeof(float) * vertices.size() };
+            uint64_t connectivity_size{ sizeof(uint32_t) * indices.size() };
+            uint64_t offsets_size{ sizeof(int64_t) * num_triangles };
+            uint64_t types_size{ sizeof(uint8_t) * num_triangles };
+            uint64_t field_size{ sizeof(float) * vertices.size() };
+
+            uint64_t offset{ 0 };
+
+            auto array = [&](const std::string& attributes, uint64_t size)
+                {
+                    std::string text{ "<DataArray " + attributes + " format=\"appended\" offset=\"" + std::to_string(offset) + "\"/>\n" };
+                    offset += sizeof(uint64_t) + size;
+                    return text;
+                };
+
+            std::string header{ "<?xml version=\"1.0\"?>\n" };
+            header += "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+            header += "<UnstructuredGrid>\n";
+            header += "<Piece NumberOfPoints=\"" + std::to_string(vertices.size()) + "\" NumberOfCells=\"" + std::to_string(num_triangles) + "\">\n";
+            header += "<Points>\n" + array("type=\"Float32\" NumberOfComponents=\"3\"", points_size) + "</Points>\n";
+            header += "<Cells>\n";
+            header += array("type=\"UInt32\" Name=\"connectivity\"", connectivity_size);
+            header += array("type=\"Int64\" Name=\"offsets\"", offsets_size);
+            header += array("type=\"UInt8\" Name=\"types\"", types_size);
+            header += "</Cells>\n";
+            header += "<PointData>\n";
+
+            for (const auto& field : fields)
+            {
+                header += array("type=\"Float32\" Name=\"" + field.name + "\"", field_size);
+            }
+
+            header += "</PointData>\n</Piece>\n</UnstructuredGrid>\n<AppendedData encoding=\"raw\">\n_";
+
+            writer.write(header);
+
+            auto write_size = [&](uint64_t size)
+                {
+                    writer.write(std::string_view{ reinterpret_cast<const char*>(&size), sizeof(size) });
+                };
+
+            write_size(points_size);
+            writer.write(vertices.size(), [&](size_t i, ExportBuffer& out)
+                {
+                    out.put_binary(vertices[i].x);
+                    out.put_binary(vertices[i].y);
+                    out.put_binary(vertices[i].z);
+                });
+
+            // Indices are already in the file layout
+            write_size(connectivity_size);
+            writer.write(std::string_view{ reinterpret_cast<const char*>(indices.data()), connectivity_size });
+
+            write_size(offsets_size);
+            writer.write(num_triangles, [&](size_t t, ExportBuffer& out) { out.put_binary(static_cast<int64_t>(3 * (t + 1))); });
+
+            // VTK_TRIANGLE
+            write_size(types_size);
+            writer.write(num_triangles, [&](size_t, ExportBuffer& out) { out.put_binary(uint8_t{ 5 }); });
+
+            for (const auto& field : fields)
+            {
+                write_size(field_size);
+                writer.write(std::string_view{ reinterpret_cast<const char*>(field.values.data()), field_size });
+            }
+
+            writer.write("\n</AppendedData>\n</VTKFile>\n");
+        }
+
+        void write_stl(ChunkWriter& writer, const SurfaceMeshData& mesh, bool binary)
+        {
+            auto vertices{ mesh.get_vertices() };
+            auto indices{ mesh.get_indices() };
+
+            size_t num_triangles{ indices.size() / 3 };
+
+            if (binary)
+            {
+                // 80 byte header that must not start with solid, then the triangle count
+                std::string header(80, ' ');
+                header.replace(0, 13, "moodysim mesh");
+
+                uint32_t count{ static_cast<uint32_t>(num_triangles) };
+                header.append(reinterpret_cast<const char*>(&count), sizeof(count));
+
+                writer.write(header);
+            }
+            else
+            {
+                writer.write("solid moodysim\n");
+            }
+
+            writer.write(num_triangles, [&](size_t t, ExportBuffer& out)
+                {
+                    const SMVertex& a{ vertices[indices[3 * t]] };
+                    const SMVertex& b{ vertices[indices[3 * t + 1]] };
+                    const SMVertex& c{ vertices[indices[3 * t + 2]] };
+
+                    SMVertex normal{ face_normal(a, b, c) };
+
+                    if (binary)
+                    {
+                        for (const SMVertex* vertex : std::initializer_list<const SMVertex*>{ &normal, &a, &b, &c })
+                        {
+                            out.put_binary(vertex->x);
+                            out.put_binary(vertex->y);
+                            out.put_binary(vertex->z);
+                        }
+
+                        out.put_binary(uint16_t{ 0 });
+                        return;
+                    }
+
+                    out.put("facet normal ");
+                    out.put(normal.x);
+                    out.put(' ');
+                    out.put(normal.y);
+                    out.put(' ');
+                    out.put(normal.z);
+                    out.put("\n outer loop\n");
+
+                    for (const SMVertex* vertex : std::initializer_list<const SMVertex*>{ &a, &b, &c })
+                    {
+                        out.put("  vertex ");
+                        out.put(vertex->x);
+                        out.put(' ');
+                        out.put(vertex->y);
+                        out.put(' ');
+                        out.put(vertex->z);
+                        out.put('\n');
+                    }
+
+                    out.put(" endloop\nendfacet\n");
+                });
+
+            if (!binary)
+            {
+                writer.write("endsolid moodysim\n");
+            }
+        }
+    }
+
+    bool export_mesh(const std::string& path, const SurfaceMeshData& mesh, MeshExportFormat format, bool binary, const std::vector<ScalarField>& fields)
+    {
+        for (const auto& field : fields)
+        {
+            if (field.values.size() != mesh.get_vertices().size())
+            {
+                std::cerr << "Error: Field " << field.name << " does not have one value per vertex" << std::endl;
+                return false;
+            }
+        }
+
+        std::ofstream file{ path, std::ios::binary };
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not create " << path << std::endl;
+            return false;
+        }
+
+        {
+            ChunkWriter writer{ file };
+
+            switch (format)
+            {
+            case MeshExportFormat::Obj:
+                write_obj(writer, mesh);
+                break;
+
+            case MeshExportFormat::Ply:
+                write_ply(writer, mesh, binary, fields);
+                break;
+
+            case MeshExportFormat::Vtk:
+                write_vtk(writer, mesh, binary, fields);
+                break;
+
+            case MeshExportFormat::Vtu:
+                write_vtu(writer, mesh, fields);
+                break;
+
+            case MeshExportFormat::Stl:
+                write_stl(writer, mesh, binary);
+                break;
+            }
+        }
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not write " << path << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+
+#include "surfacemeshdata.h"
+
+namespace moodysim
+{
+    // File formats written by export_mesh
+    enum class MeshExportFormat
+    {
+        Obj,  // Wavefront OBJ, text only, scalar fields are not written
+        Ply,  // Stanford PLY, fields become vertex properties
+        Vtk,  // Legacy VTK polydata, fields become point data
+        Vtu,  // VTK XML unstructured grid, always raw appended binary
+        Stl   // Stereolithography triangles with face normals, scalar fields are not written
+    };
+
+    // Named value per vertex written alongside the mesh where the format has room for it
+    struct ScalarField
+    {
+        std::string name{};
+        std::span<const float> values{};
+    };
+
+    // Write mesh to path, as binary where the format has a binary variant unless binary is false
+    // Vertices and triangles are formatted with to_chars in parallel into reusable chunk buffers
+    // and each batch of chunks is written by a separate thread while the next one is formatted
+    bool export_mesh(const std::string& path, const SurfaceMeshData& mesh, MeshExportFormat format,
+        bool binary = true, const std::vector<ScalarField>& fields = {});
+}
@@ -0,0 +1,264 @@
+#include "meshfile.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace moodysim
+{
+    static size_t align_up(size_t offset)
+    {
+        return (offset + mesh_file_alignment - 1) / mesh_file_alignment * mesh_file_alignment;
+    }
+
+    bool write_mesh_sections(const std::string& path, const std::vector<MeshSectionData>& sections)
+    {
+        std::vector<MeshSectionEntry> entries(sections.size());
+
+        size_t offset{ align_up(sizeof(MeshFileHeader) + sections.size() * sizeof(MeshSectionEntry)) };
+
+        for (size_t s = 0; s < sections.size(); ++s)
+        {
+            entries[s] = { sections[s].type, sections[s].element_size, offset, sections[s].count };
+            offset = align_up(offset + sections[s].count * sections[s].element_size);
+        }
+
+        std::ofstream file{ path, std::ios::binary };
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not create " << path << std::endl;
+            return false;
+        }
+
+        MeshFileHeader header{};
+        header.num_sections = static_cast<uint32_t>(sections.size());
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(MeshSectionEntry));
+
+        // Zero padding up to the next section
+        const char padding[mesh_file_alignment]{};
+        size_t position{ sizeof(MeshFileHeader) + sections.size() * sizeof(MeshSectionEntry) };
+
+        for (size_t s = 0; s < sections.size(); ++s)
+        {
+            file.write(padding, entries[s].offset - position);
+
+            size_t size{ entries[s].count * entries[s].element_size };
+            file.write(static_cast<const char*>(sections[s].data), size);
+
+            position = entries[s].offset + size;
+        }
+
+        // Pad the end too so every section is a whole number of cache lines
+        file.write(padding, align_up(position) - position);
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not write " << path << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool read_mesh_sections(const std::string& path, const MappedFile& file, std::vector<MeshSectionEntry>& entries)
+    {
+        entries.clear();
+
+        MeshFileHeader header{};
+        MeshFileHeader expected{};
+
+        if (file.size() < sizeof(MeshFileHeader))
+        {
+            std::cerr << "Error: " << path << " is too small to be a mesh file" << std::endl;
+            return false;
+        }
+
+        std::memcpy(&header, file.data(), sizeof(MeshFileHeader));
+
+        if (std::memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0 || header.major_version != expected.major_version)
+        {
+            std::cerr << "Error: " << path << " is not a version " << expected.major_version << " mesh file" << std::endl;
+            return false;
+        }
+
+        if ((file.size() - sizeof(MeshFileHeader)) / sizeof(MeshSectionEntry) < header.num_sections)
+        {
+            std::cerr << "Error: " << path << " is truncated" << std::endl;
+            return false;
+        }
+
+        entries.resize(header.num_sections);
+        std::memcpy(entries.data(), file.data() + sizeof(MeshFileHeader), entries.size() * sizeof(MeshSectionEntry));
+
+        for (const auto& entry : entries)
+        {
+            if (entry.offset % mesh_file_alignment != 0 || entry.offset > file.size() ||
+                entry.element_size == 0 || (file.size() - entry.offset) / entry.element_size < entry.count)
+            {
+                std::cerr << "Error: " << path << " has a section outside the file" << std::endl;
+                entries.clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool write_mesh_file(const std::string& path, const SurfaceMeshData& mesh,
+        std::span<const std::array<int, 3>> neighbors, std::span<const int> point_ordering)
+    {
+        auto vertices{ mesh.get_vertices() };
+        auto indices{ mesh.get_indices() };
+
+        if (!neighbors.empty() && neighbors.size() != indices.size() / 3)
+        {
+            std::cerr << "Error: Expected one neighbor triple per triangle" << std::endl;
+            return false;
+        }
+
+        if (point_ordering.size() > vertices.size())
+        {
+            std::cerr << "Error: Expected at most one point ordering entry per vertex" << std::endl;
+            return false;
+        }
+
+        std::vector<MeshSectionData> sections{};
+        sections.push_back({ MeshSection::Vertices, sizeof(SMVertex), vertices.size(), vertices.data() });
+        sections.push_back({ MeshSection::Indices, sizeof(unsigned int), indices.size(), indices.data() });
+
+        if (!neighbors.empty())
+        {
+            sections.push_back({ MeshSection::Neighbors, sizeof(std::array<int, 3>), neighbors.size(), neighbors.data() });
+        }
+
+        if (!point_ordering.empty())
+        {
+            sections.push_back({ MeshSection::PointOrdering, sizeof(int), point_ordering.size(), point_ordering.data() });
+        }
+
+        return write_mesh_sections(path, sections);
+    }
+
+    bool MeshFile::open(const std::string& path)
+    {
+        mesh_.reset();
+        file_.reset();
+        neighbors_ = {};
+        point_ordering_ = {};
+
+        auto file{ std::make_shared<MappedFile>() };
+
+        // Sections are used in place rather than read front to back
+        if (!file->open(path, false))
+        {
+            return false;
+        }
+
+        std::vector<MeshSectionEntry> entries{};
+
+        if (!read_mesh_sections(path, *file, entries))
+        {
+            return false;
+        }
+
+        std::span<const SMVertex> vertices{};
+        std::span<const unsigned int> indices{};
+        std::span<const std::array<int, 3>> neighbors{};
+        std::span<const int> point_ordering{};
+        bool has_vertices{ false };
+        bool has_indices{ false };
+
+        for (const auto& entry : entries)
+        {
+            const std::byte* data{ file->data() + entry.offset };
+            size_t count{ static_cast<size_t>(entry.count) };
+
+            auto check_size = [&](size_t size)
+                {
+                    if (entry.element_size != size)
+                    {
+                        std::cerr << "Error: " << path << " has a section of unexpected element size " << entry.element_size << std::endl;
+                        return false;
+                    }
+
+                    return true;
+                };
+
+            switch (entry.type)
+            {
+            case MeshSection::Vertices:
+                if (!check_size(sizeof(SMVertex)))
+                {
+                    return false;
+                }
+
+                vertices = { reinterpret_cast<const SMVertex*>(data), count };
+                has_vertices = true;
+                break;
+
+            case MeshSection::Indices:
+                if (!check_size(sizeof(unsigned int)))
+                {
+                    return false;
+                }
+
+                indices = { reinterpret_cast<const unsigned int*>(data), count };
+                has_indices = true;
+                break;
+
+            case MeshSection::Neighbors:
+                if (!check_size(sizeof(std::array<int, 3>)))
+                {
+                    return false;
+                }
+
+                neighbors = { reinterpret_cast<const std::array<int, 3>*>(data), count };
+                break;
+
+            case MeshSection::PointOrdering:
+                if (!check_size(sizeof(int)))
+                {
+                    return false;
+                }
+
+                point_ordering = { reinterpret_cast<const int*>(data), count };
+                break;
+
+            default:
+                // Checkpoint data or added by a later minor version
+                break;
+            }
+        }
+
+        if (!has_vertices || !has_indices || indices.size() % 3 != 0)
+        {
+            std::cerr << "Error: " << path << " has no complete vertex and index sections" << std::endl;
+            return false;
+        }
+
+        if (!neighbors.empty() && neighbors.size() != indices.size() / 3)
+        {
+            std::cerr << "Error: " << path << " has " << neighbors.size() << " neighbor triples for " << indices.size() / 3 << " triangles" << std::endl;
+            return false;
+        }
+
+        // The ordering only has entries for the input points so it can be shorter than the vertices
+        if (point_ordering.size() > vertices.size())
+        {
+            std::cerr << "Error: " << path << " has a point ordering of " << point_ordering.size() << " entries for " << vertices.size() << " vertices" << std::endl;
+            return false;
+        }
+
+        neighbors_ = neighbors;
+        point_ordering_ = point_ordering;
+
+        file_ = file;
+        mesh_.emplace(vertices, indices, std::move(file));
+
+        return true;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "surfacemeshdata.h"
+#include "mappedfile.h"
+
+namespace moodysim
+{
+    // Kind of data held by a section of a mesh file
+    enum class MeshSection : uint32_t
+    {
+        Vertices = 1,       // SMVertex
+        Indices = 2,        // unsigned int, three per triangle
+        Neighbors = 3,      // std::array<int, 3> per triangle, the triangle across each edge or -1
+        PointOrdering = 4,  // int per input point, as kept by DelaunayGenerator
+
+        // DelaunayGenerator checkpoints
+        Points = 5,            // Point3D
+        Edges = 6,             // Edge constraints
+        Holes = 7,             // Point3D
+        Triangles = 8,         // std::array<int, 3>
+        VertexTriangles = 9,   // int per point
+        ConstrainedEdges = 10, // uint64_t edge key
+        GeneratorState = 11    // Counters and settings of the generator
+    };
+
+    // Location of one section, the offset is from the start of the file and a multiple of mesh_file_alignment
+    struct MeshSectionEntry
+    {
+        MeshSection type{};
+        uint32_t element_size{ 0 };
+        uint64_t offset{ 0 };
+        uint64_t count{ 0 };
+    };
+
+    // Start of a mesh file, followed by num_sections entries then the sections
+    // Data is little endian, readers reject another major version and skip section types they do not know
+    struct MeshFileHeader
+    {
+        char magic[4]{ 'M', 'M', 'S', 'H' };
+        uint16_t major_version{ 1 };
+        uint16_t minor_version{ 0 };
+        uint32_t num_sections{ 0 };
+        uint32_t reserved{ 0 };
+    };
+
+    static_assert(sizeof(MeshSectionEntry) == 24);
+    static_assert(sizeof(MeshFileHeader) == 16);
+
+    // Sections start on cache line boundaries so they can be used in place with aligned loads
+    constexpr size_t mesh_file_alignment{ 64 };
+
+    // Contents of one section to write
+    struct MeshSectionData
+    {
+        MeshSection type{};
+        uint32_t element_size{ 0 };
+        uint64_t count{ 0 };
+        const void* data{ nullptr };
+    };
+
+    // Write a mesh file holding the given sections in order
+    bool write_mesh_sections(const std::string& path, const std::vector<MeshSectionData>& sections);
+
+    // Check the header of a mapped mesh file and read its section table, every section lies inside the file
+    bool read_mesh_sections(const std::string& path, const MappedFile& file, std::vector<MeshSectionEntry>& entries);
+
+    // Write the vertices and indices of mesh and, when not empty, the neighbors (one triple per triangle)
+    // and point ordering (at most one entry per vertex)
+    bool write_mesh_file(const std::string& path, const SurfaceMeshData& mesh,
+        std::span<const std::array<int, 3>> neighbors = {}, std::span<const int> point_ordering = {});
+
+    // Mesh file mapped into memory, opening only checks the header and section table
+    // so the time to open does not depend on the size of the mesh
+    class MeshFile
+    {
+    public:
+
+        // Map the file at path, returns false if it is not a valid mesh file
+        bool open(const std::string& path);
+
+        // Vertices and indices viewed in the mapping (only after open succeeded), the view keeps the file mapped on its own
+        const SurfaceMeshData& mesh() const { return *mesh_; }
+
+        // Empty when the file has none
+        std::span<const std::array<int, 3>> get_neighbors() const { return neighbors_; }
+        std::span<const int> get_point_ordering() const { return point_ordering_; }
+
+    private:
+
+        std::shared_ptr<const MappedFile> file_{};
+        std::optional<SurfaceMeshData> mesh_{};
+
+        std::span<const std::array<int, 3>> neighbors_{};
+        std::span<const int> point_ordering_{};
+    };
+}
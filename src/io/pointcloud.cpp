@@ -0,0 +1,246 @@
+#include "pointcloud.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace moodysim
+{
+    namespace
+    {
+        // The file is little endian so a big endian host reverses every value it reads or writes
+        constexpr bool swap_bytes{ std::endian::native == std::endian::big };
+
+        template <typename T>
+        T reverse_bytes(T value)
+        {
+            std::byte* bytes{ reinterpret_cast<std::byte*>(&value) };
+            std::reverse(bytes, bytes + sizeof(T));
+            return value;
+        }
+
+        // Converts between the host and the file byte order, both ways
+        PointCloudHeader file_byte_order(PointCloudHeader header)
+        {
+            if constexpr (swap_bytes)
+            {
+                header.version = reverse_bytes(header.version);
+                header.scalar_size = reverse_bytes(header.scalar_size);
+                header.dimensions = reverse_bytes(header.dimensions);
+                header.num_attributes = reverse_bytes(header.num_attributes);
+                header.num_points = reverse_bytes(header.num_points);
+            }
+
+            return header;
+        }
+    }
+
+    bool write_point_cloud(const std::string& path, const std::vector<Point3D>& points, PointCloudLayout layout, const std::vector<double>& attributes)
+    {
+        if (layout.dimensions < 2 || layout.dimensions > 3 || layout.num_attributes < 0
+            || static_cast<uint32_t>(layout.num_attributes) > max_point_cloud_attributes)
+        {
+            std::cerr << "Error: Unsupported point cloud layout" << std::endl;
+            return false;
+        }
+
+        if (attributes.size() != points.size() * layout.num_attributes)
+        {
+            std::cerr << "Error: Expected " << layout.num_attributes << " attributes per point" << std::endl;
+            return false;
+        }
+
+        std::ofstream file{ path, std::ios::binary };
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not create " << path << std::endl;
+            return false;
+        }
+
+        PointCloudHeader header{};
+        header.scalar_size = layout.use_double ? 8 : 4;
+        header.dimensions = layout.dimensions;
+        header.num_attributes = layout.num_attributes;
+        header.num_points = points.size();
+
+        PointCloudHeader file_header{ file_byte_order(header) };
+        file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+
+        // Records are assembled a chunk at a time so the stream is written in large blocks
+        constexpr size_t chunk_size{ 1 << 14 };
+
+        size_t scalars{ static_cast<size_t>(layout.dimensions + layout.num_attributes) };
+        std::vector<std::byte> buffer(chunk_size * scalars * header.scalar_size);
+
+        for (size_t begin = 0; begin < points.size(); begin += chunk_size)
+        {
+            size_t end{ std::min(points.size(), begin + chunk_size) };
+            std::byte* out{ buffer.data() };
+
+            auto put = [&](double value)
+                {
+                    if (layout.use_double)
+                    {
+                        value = swap_bytes ? reverse_bytes(value) : value;
+                        std::memcpy(out, &value, sizeof(double));
+                        out += sizeof(double);
+                    }
+                    else
+                    {
+                        float single{ static_cast<float>(value) };
+                        single = swap_bytes ? reverse_bytes(single) : single;
+                        std::memcpy(out, &single, sizeof(float));
+                        out += sizeof(float);
+                    }
+                };
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                put(points[i].x);
+                put(points[i].y);
+
+                if (layout.dimensions == 3)
+                {
+                    put(points[i].z);
+                }
+
+                for (int k = 0; k < layout.num_attributes; ++k)
+                {
+                    put(attributes[i * layout.num_attributes + k]);
+                }
+            }
+
+            file.write(reinterpret_cast<const char*>(buffer.data()), out - buffer.data());
+        }
+
+        if (!file)
+        {
+            std::cerr << "Error: Could not write " << path << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PointCloudReader::open(const std::string& path)
+    {
+        records_ = nullptr;
+        next_ = 0;
+
+        if (!file_.open(path))
+        {
+            return false;
+        }
+
+        if (file_.size() < sizeof(PointCloudHeader))
+        {
+            std::cerr << "Error: " << path << " is too small to be a point cloud" << std::endl;
+            file_.close();
+            return false;
+        }
+
+        std::memcpy(&header_, file_.data(), sizeof(PointCloudHeader));
+        header_ = file_byte_order(header_);
+
+        PointCloudHeader expected{};
+
+        if (std::memcmp(header_.magic, expected.magic, sizeof(expected.magic)) != 0 || header_.version != expected.version)
+        {
+            std::cerr << "Error: " << path << " is not a version " << expected.version << " point cloud" << std::endl;
+            file_.close();
+            return false;
+        }
+
+        // Widened before adding so a corrupt attribute count cannot wrap the stride
+        stride_ = (static_cast<size_t>(header_.dimensions) + static_cast<size_t>(header_.num_attributes)) * header_.scalar_size;
+
+        if ((header_.scalar_size != 4 && header_.scalar_size != 8) || header_.dimensions < 2 || header_.dimensions > 3
+            || header_.num_attributes > max_point_cloud_attributes || stride_ == 0)
+        {
+            std::cerr << "Error: " << path << " has an unsupported point layout" << std::endl;
+            file_.close();
+            return false;
+        }
+
+        layout_.use_double = header_.scalar_size == 8;
+        layout_.dimensions = static_cast<int>(header_.dimensions);
+        layout_.num_attributes = static_cast<int>(header_.num_attributes);
+
+        // Compare by division so a corrupt point count cannot overflow
+        if ((file_.size() - sizeof(PointCloudHeader)) / stride_ < header_.num_points)
+        {
+            std::cerr << "Error: " << path << " is truncated" << std::endl;
+            file_.close();
+            return false;
+        }
+
+        records_ = file_.data() + sizeof(PointCloudHeader);
+
+        return true;
+    }
+
+    std::span<const Point3D> PointCloudReader::points() const
+    {
+        // The mapping is page aligned and the header keeps the records aligned for float
+        if (swap_bytes || !records_ || layout_.use_double || layout_.dimensions != 3 || layout_.num_attributes != 0)
+        {
+            return {};
+        }
+
+        return { reinterpret_cast<const Point3D*>(records_), size() };
+    }
+
+    double PointCloudReader::attribute(size_t point, int index) const
+    {
+        return scalar(point, layout_.dimensions + index);
+    }
+
+    double PointCloudReader::scalar(size_t point, int k) const
+    {
+        const std::byte* in{ records_ + point * stride_ + static_cast<size_t>(k) * header_.scalar_size };
+
+        if (layout_.use_double)
+        {
+            double value{};
+            std::memcpy(&value, in, sizeof(double));
+            return swap_bytes ? reverse_bytes(value) : value;
+        }
+
+        float value{};
+        std::memcpy(&value, in, sizeof(float));
+        return swap_bytes ? reverse_bytes(value) : value;
+    }
+
+    size_t PointCloudReader::read(std::vector<Point3D>& destination, size_t max_count)
+    {
+        size_t count{ std::min(max_count, size() - std::min(next_, size())) };
+
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        std::span<const Point3D> view{ points() };
+
+        if (!view.empty())
+        {
+            // Straight from the page cache into the destination
+            destination.insert(destination.end(), view.begin() + next_, view.begin() + next_ + count);
+        }
+        else
+        {
+            for (size_t i = next_; i < next_ + count; ++i)
+            {
+                float z{ layout_.dimensions == 3 ? static_cast<float>(scalar(i, 2)) : 0.f };
+                destination.push_back({ static_cast<float>(scalar(i, 0)), static_cast<float>(scalar(i, 1)), z });
+            }
+        }
+
+        next_ += count;
+
+        return count;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.h"
+#include "pointsource.h"
+#include "mappedfile.h"
+
+namespace moodysim
+{
+    // Scalar type and record layout of a binary point cloud
+    struct PointCloudLayout
+    {
+        bool use_double{ false };  // Scalars are double instead of float
+        int dimensions{ 3 };       // 2 for xy records, 3 for xyz
+        int num_attributes{ 0 };   // Extra scalars after the coordinates of each point
+    };
+
+    // Records with more attributes than this are rejected as corrupt
+    constexpr uint32_t max_point_cloud_attributes{ 1 << 16 };
+
+    // Start of a binary point cloud file, followed by num_points records of the coordinates then the attributes
+    // All scalars are of the same type and little endian
+    struct PointCloudHeader
+    {
+        char magic[4]{ 'M', 'P', 'C', 'L' };
+        uint32_t version{ 1 };
+        uint32_t scalar_size{ 4 };
+        uint32_t dimensions{ 3 };
+        uint32_t num_attributes{ 0 };
+        uint32_t reserved{ 0 };
+        uint64_t num_points{ 0 };
+    };
+
+    static_assert(sizeof(PointCloudHeader) == 32);
+
+    // Write points (and attributes, num_attributes per point in point order) in the given layout
+    bool write_point_cloud(const std::string& path, const std::vector<Point3D>& points,
+        PointCloudLayout layout = {}, const std::vector<double>& attributes = {});
+
+    // Binary point cloud mapped into memory and read in place
+    // Float xyz records without attributes have the layout of Point3D so they are viewed and copied
+    // without any conversion, other layouts are converted a chunk at a time as they are read
+    class PointCloudReader : public PointSource
+    {
+    public:
+
+        // Map the file at path and check its header, returns false if it is not a valid point cloud
+        bool open(const std::string& path);
+
+        size_t size() const { return static_cast<size_t>(header_.num_points); }
+
+        const PointCloudLayout& layout() const { return layout_; }
+
+        // The points where they lie in the mapped file, empty unless the layout matches Point3D
+        // and the host is little endian
+        std::span<const Point3D> points() const;
+
+        double attribute(size_t point, int index) const;
+
+        // Start reading from the first point again
+        bool rewind() override
+        {
+            next_ = 0;
+            return true;
+        }
+
+        size_t read(std::vector<Point3D>& points, size_t max_count) override;
+
+        size_t size_hint() const override { return size(); }
+
+    private:
+
+        // Coordinate or attribute k of the record of point
+        double scalar(size_t point, int k) const;
+
+        MappedFile file_{};
+        PointCloudHeader header_{};
+        PointCloudLayout layout_{};
+
+        const std::byte* records_{ nullptr };
+        size_t stride_{ 0 };
+        size_t next_{ 0 };
+    };
+}
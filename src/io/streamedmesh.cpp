@@ -0,0 +1,189 @@
+#include "streamedmesh.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "mappedfile.h"
+
+namespace moodysim
+{
+    StreamedMeshWriter::~StreamedMeshWriter()
+    {
+        close();
+    }
+
+    bool StreamedMeshWriter::open(const std::string& path)
+    {
+        close();
+
+        path_ = path;
+        file_.open(path, std::ios::binary);
+
+        if (!file_)
+        {
+            std::cerr << "Error: Could not create " << path << std::endl;
+            return false;
+        }
+
+        StreamedMeshHeader header{};
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        writer_.emplace([this](std::vector<char>& buffer)
+            {
+                file_.write(buffer.data(), buffer.size());
+                buffer.clear();
+
+                return static_cast<bool>(file_);
+            });
+
+        return true;
+    }
+
+    void StreamedMeshWriter::write_points(std::span<const Point3D> points)
+    {
+        append(StreamedMeshBlockType::Points, points.data(), points.size(), sizeof(Point3D));
+    }
+
+    void StreamedMeshWriter::write_triangles(std::span<const std::array<std::int64_t, 3>> triangles)
+    {
+        append(StreamedMeshBlockType::Triangles, triangles.data(), triangles.size(), sizeof(std::array<std::int64_t, 3>));
+    }
+
+    void StreamedMeshWriter::append(StreamedMeshBlockType type, const void* data, size_t count, size_t record_size)
+    {
+        if (!file_.is_open() || count == 0)
+        {
+            return;
+        }
+
+        StreamedMeshBlock block{ type, 0, count };
+
+        // Waits for the previous buffer to start writing
+        if (buffer_ == nullptr)
+        {
+            buffer_ = &writer_->acquire();
+        }
+
+        auto& buffer{ *buffer_ };
+        size_t offset{ buffer.size() };
+
+        buffer.resize(offset + sizeof(block) + count * record_size);
+        std::memcpy(buffer.data() + offset, &block, sizeof(block));
+        std::memcpy(buffer.data() + offset + sizeof(block), data, count * record_size);
+
+        if (buffer.size() >= buffer_size)
+        {
+            writer_->submit();
+            buffer_ = nullptr;
+        }
+    }
+
+    bool StreamedMeshWriter::close()
+    {
+        if (!file_.is_open())
+        {
+            return true;
+        }
+
+        if (buffer_ != nullptr)
+        {
+            writer_->submit();
+            buffer_ = nullptr;
+        }
+
+        // Stops the writer thread once everything is written
+        writer_.reset();
+
+        bool written{ static_cast<bool>(file_) };
+        file_.close();
+
+        if (!written)
+        {
+            std::cerr << "Error: Could not write " << path_ << std::endl;
+        }
+
+        return written;
+    }
+
+    bool read_streamed_mesh(const std::string& path, std::vector<Point3D>& points, std::vector<std::array<std::int64_t, 3>>& triangles)
+    {
+        MappedFile file{};
+
+        if (!file.open(path))
+        {
+            return false;
+        }
+
+        StreamedMeshHeader expected{};
+        StreamedMeshHeader header{};
+
+        if (file.size() < sizeof(header))
+        {
+            std::cerr << "Error: " << path << " is too small to be a streamed mesh" << std::endl;
+            return false;
+        }
+
+        std::memcpy(&header, file.data(), sizeof(header));
+
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version)
+        {
+            std::cerr << "Error: " << path << " is not a version " << expected.version << " streamed mesh" << std::endl;
+            return false;
+        }
+
+        points.clear();
+        triangles.clear();
+
+        size_t offset{ sizeof(header) };
+
+        while (offset < file.size())
+        {
+            StreamedMeshBlock block{};
+
+            if (file.size() - offset < sizeof(block))
+            {
+                std::cerr << "Error: " << path << " is truncated" << std::endl;
+                return false;
+            }
+
+            std::memcpy(&block, file.data() + offset, sizeof(block));
+            offset += sizeof(block);
+
+            size_t record_size{};
+
+            switch (block.type)
+            {
+            case StreamedMeshBlockType::Points: record_size = sizeof(Point3D); break;
+            case StreamedMeshBlockType::Triangles: record_size = sizeof(std::array<std::int64_t, 3>); break;
+            default:
+                std::cerr << "Error: " << path << " has a block of unknown type" << std::endl;
+                return false;
+            }
+
+            if (block.count > (file.size() - offset) / record_size)
+            {
+                std::cerr << "Error: " << path << " is truncated" << std::endl;
+                return false;
+            }
+
+            const std::byte* data{ file.data() + offset };
+
+            if (block.type == StreamedMeshBlockType::Points)
+            {
+                size_t first{ points.size() };
+                points.resize(first + block.count);
+                std::memcpy(points.data() + first, data, block.count * record_size);
+            }
+            else
+            {
+                size_t first{ triangles.size() };
+                triangles.resize(first + block.count);
+                std::memcpy(triangles.data() + first, data, block.count * record_size);
+            }
+
+            offset += block.count * record_size;
+        }
+
+        return true;
+    }
+}
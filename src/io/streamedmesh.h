@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <span>
+#include <string>
+#include <fstream>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.h"
+#include "streaming.h"
+#include "doublebuffer.h"
+
+namespace moodysim
+{
+    // Start of a streamed mesh file, followed by blocks in the order they were written
+    struct StreamedMeshHeader
+    {
+        char magic[4]{ 'M', 'S', 'T', 'M' };
+        uint32_t version{ 1 };
+        uint64_t reserved{ 0 };
+    };
+
+    static_assert(sizeof(StreamedMeshHeader) == 16);
+
+    enum class StreamedMeshBlockType : uint32_t
+    {
+        Points = 1,     // count Point3D
+        Triangles = 2   // count triples of int64 point indices
+    };
+
+    // Start of a block, followed by count records of its type
+    struct StreamedMeshBlock
+    {
+        StreamedMeshBlockType type{ StreamedMeshBlockType::Points };
+        uint32_t reserved{ 0 };
+        uint64_t count{ 0 };
+    };
+
+    static_assert(sizeof(StreamedMeshBlock) == 16);
+
+    // Writes the output of a StreamingDelaunay to a file as it is finalized
+    // Blocks are gathered in a buffer and each full buffer is written on a background thread
+    // while the next one fills so the triangulation rarely waits for the disk
+    class StreamedMeshWriter : public StreamingMeshSink
+    {
+    public:
+
+        StreamedMeshWriter() = default;
+
+        StreamedMeshWriter(const StreamedMeshWriter&) = delete;
+        StreamedMeshWriter& operator=(const StreamedMeshWriter&) = delete;
+
+        ~StreamedMeshWriter();
+
+        // Create the file at path and write its header, returns false if it could not be created
+        bool open(const std::string& path);
+
+        void write_points(std::span<const Point3D> points) override;
+
+        void write_triangles(std::span<const std::array<std::int64_t, 3>> triangles) override;
+
+        // Write everything still buffered and close the file, returns false if a write failed
+        bool close();
+
+        // Bytes gathered before a buffer is handed to the writer thread
+        static constexpr size_t buffer_size{ 1 << 22 };
+
+    private:
+
+        void append(StreamedMeshBlockType type, const void* data, size_t count, size_t record_size);
+
+        std::string path_{};
+        std::ofstream file_{};
+
+        // Only while the file is open, the buffer being filled comes from it (null until the first block)
+        std::optional<DoubleBufferedWriter<std::vector<char>>> writer_{};
+        std::vector<char>* buffer_{ nullptr };
+    };
+
+    // Read a whole streamed mesh file, triangles index points in the order they were written
+    bool read_streamed_mesh(const std::string& path, std::vector<Point3D>& points, std::vector<std::array<std::int64_t, 3>>& triangles);
+}
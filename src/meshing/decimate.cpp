@@ -0,0 +1,724 @@
+#include "decimate.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    void Quadric::add_plane(double a, double b, double c, double d, double weight)
+    {
+        a2 += weight * a * a;
+        ab += weight * a * b;
+        ac += weight * a * c;
+        ad += weight * a * d;
+        b2 += weight * b * b;
+        bc += weight * b * c;
+        bd += weight * b * d;
+        c2 += weight * c * c;
+        cd += weight * c * d;
+        d2 += weight * d * d;
+    }
+
+    Quadric& Quadric::operator+=(const Quadric& other)
+    {
+        a2 += other.a2;
+        ab += other.ab;
+        ac += other.ac;
+        ad += other.ad;
+        b2 += other.b2;
+        bc += other.bc;
+        bd += other.bd;
+        c2 += other.c2;
+        cd += other.cd;
+        d2 += other.d2;
+
+        return *this;
+    }
+
+    double Quadric::evaluate(double x, double y, double z) const
+    {
+        return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+            + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+            + c2 * z * z + 2.0 * cd * z
+            + d2;
+    }
+
+    bool Quadric::minimize(double& x, double& y, double& z) const
+    {
+        // Solve the 3x3 system of the gradient with Cramer's rule
+        double det{ a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac) };
+        double scale{ a2 * b2 * c2 };
+
+        if (std::abs(det) <= 1e-9 * std::abs(scale) || det == 0.0)
+        {
+            return false;
+        }
+
+        x = -(ad * (b2 * c2 - bc * bc) - ab * (bd * c2 - bc * cd) + ac * (bd * bc - b2 * cd)) / det;
+        y = -(a2 * (bd * c2 - cd * bc) - ad * (ab * c2 - bc * ac) + ac * (ab * cd - bd * ac)) / det;
+        z = -(a2 * (b2 * cd - bc * bd) - ab * (ab * cd - bd * ac) + ad * (ab * bc - b2 * ac)) / det;
+
+        return true;
+    }
+
+    MeshDecimator::MeshDecimator(const SurfaceMeshData& mesh)
+        : vertices_(mesh.get_vertices().begin(), mesh.get_vertices().end())
+    {
+        const auto& indices{ mesh.get_indices() };
+
+        int num_vertices{ static_cast<int>(vertices_.size()) };
+        num_faces_ = indices.size() / 3;
+
+        faces_.resize(num_faces_);
+        face_alive_.assign(num_faces_, 1);
+
+        // Counting pass so each face list is allocated once
+        std::vector<int> counts(num_vertices, 0);
+        for (auto index : indices)
+        {
+            ++counts[index];
+        }
+
+        vertex_faces_.resize(num_vertices);
+        for (int v = 0; v < num_vertices; ++v)
+        {
+            vertex_faces_[v].reserve(counts[v]);
+        }
+
+        for (size_t f = 0; f < num_faces_; ++f)
+        {
+            faces_[f] = { static_cast<int>(indices[3 * f]), static_cast<int>(indices[3 * f + 1]), static_cast<int>(indices[3 * f + 2]) };
+
+            for (auto v : faces_[f])
+            {
+                vertex_faces_[v].push_back(static_cast<int>(f));
+            }
+        }
+
+        quadrics_.resize(num_vertices);
+        boundary_.assign(num_vertices, 0);
+        stamps_.assign(num_vertices, 0);
+
+        // Each vertex sums the planes of its own triangles so there are no shared writes
+        // an edge is on the boundary when only one triangle around the vertex contains it
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    Quadric quadric{};
+
+                    for (auto f : vertex_faces_[v])
+                    {
+                        const SMVertex& p0{ vertices_[faces_[f][0]] };
+                        const SMVertex& p1{ vertices_[faces_[f][1]] };
+                        const SMVertex& p2{ vertices_[faces_[f][2]] };
+
+                        double ux{ static_cast<double>(p1.x) - p0.x };
+                        double uy{ static_cast<double>(p1.y) - p0.y };
+                        double uz{ static_cast<double>(p1.z) - p0.z };
+                        double wx{ static_cast<double>(p2.x) - p0.x };
+                        double wy{ static_cast<double>(p2.y) - p0.y };
+                        double wz{ static_cast<double>(p2.z) - p0.z };
+
+                        double nx{ uy * wz - uz * wy };
+                        double ny{ uz * wx - ux * wz };
+                        double nz{ ux * wy - uy * wx };
+                        double length{ std::sqrt(nx * nx + ny * ny + nz * nz) };
+
+                        if (length == 0.0)
+                        {
+                            continue;
+                        }
+
+                        nx /= length;
+                        ny /= length;
+                        nz /= length;
+
+                        // Weight by area so large triangles dominate
+                        quadric.add_plane(nx, ny, nz, -(nx * p0.x + ny * p0.y + nz * p0.z), 0.5 * length);
+
+                        int i{ faces_[f][0] == v ? 0 : (faces_[f][1] == v ? 1 : 2) };
+
+                        for (int offset = 1; offset < 3; ++offset)
+                        {
+                            int w{ faces_[f][(i + offset) % 3] };
+
+                            int shared{ 0 };
+                            for (auto g : vertex_faces_[v])
+                            {
+                                shared += (faces_[g][0] == w || faces_[g][1] == w || faces_[g][2] == w) ? 1 : 0;
+                            }
+
+                            if (shared != 1)
+                            {
+                                continue;
+                            }
+
+                            // Plane through the boundary edge perpendicular to the triangle
+                            const SMVertex& q{ vertices_[w] };
+
+                            double ex{ static_cast<double>(q.x) - vertices_[v].x };
+                            double ey{ static_cast<double>(q.y) - vertices_[v].y };
+                            double ez{ static_cast<double>(q.z) - vertices_[v].z };
+                            double edge_length{ std::sqrt(ex * ex + ey * ey + ez * ez) };
+
+                            double bx{ ey * nz - ez * ny };
+                            double by{ ez * nx - ex * nz };
+                            double bz{ ex * ny - ey * nx };
+                            double b_length{ std::sqrt(bx * bx + by * by + bz * bz) };
+
+                            if (b_length == 0.0)
+                            {
+                                continue;
+                            }
+
+                            bx /= b_length;
+                            by /= b_length;
+                            bz /= b_length;
+
+                            quadric.add_plane(bx, by, bz, -(bx * q.x + by * q.y + bz * q.z), boundary_weight * edge_length * edge_length);
+                            boundary_[v] = 1;
+                        }
+                    }
+
+                    quadrics_[v] = quadric;
+                }
+            }, 1 << 12);
+    }
+
+    template <typename Func>
+    void MeshDecimator::for_each_owned_edge(int v, Func&& func) const
+    {
+        for (auto f : vertex_faces_[v])
+        {
+            if (!face_alive_[f])
+            {
+                continue;
+            }
+
+            int i{ faces_[f][0] == v ? 0 : (faces_[f][1] == v ? 1 : 2) };
+            int next{ faces_[f][(i + 1) % 3] };
+            int previous{ faces_[f][(i + 2) % 3] };
+
+            // Interior edges appear once in each direction so only the outgoing one counts
+            // boundary edges only appear in one direction
+            if (v < next)
+            {
+                func(next);
+            }
+
+            if (v < previous)
+            {
+                bool twin{ false };
+                for (auto g : vertex_faces_[v])
+                {
+                    int j{ faces_[g][0] == v ? 0 : (faces_[g][1] == v ? 1 : 2) };
+                    twin = twin || (face_alive_[g] && faces_[g][(j + 1) % 3] == previous);
+                }
+
+                if (!twin)
+                {
+                    func(previous);
+                }
+            }
+        }
+    }
+
+    SurfaceMeshData MeshDecimator::decimate(size_t target_triangles, double max_error)
+    {
+        int num_vertices{ static_cast<int>(vertices_.size()) };
+
+        locked_.assign(num_vertices, 0);
+
+        if (num_faces_ > target_triangles && num_faces_ >= 2 * chunk_size)
+        {
+            decimate_chunks(target_triangles, max_error);
+        }
+
+        // Counting pass over the edges owned by each vertex then fill the candidate collapses in parallel at their offsets
+        std::vector<int> offsets(num_vertices + 1, 0);
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    int count{ 0 };
+                    for_each_owned_edge(v, [&](int) { ++count; });
+                    offsets[v + 1] = count;
+                }
+            }, 1 << 12);
+
+        for (int v = 0; v < num_vertices; ++v)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+
+        std::vector<QueuedCollapse> collapses(offsets[num_vertices]);
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    int position{ offsets[v] };
+                    for_each_owned_edge(v, [&](int w) { collapses[position++] = queue_entry(evaluate_collapse(v, w)); });
+                }
+            }, 1 << 12);
+
+        // Heapify all candidates at once, collapses are never updated in place but
+        // requeued with the new vertex stamps so older entries are skipped when popped
+        CollapseQueue queue{ std::greater<QueuedCollapse>{}, std::move(collapses) };
+
+        num_faces_ = collapse_edges(queue, num_faces_, target_triangles, max_error);
+
+        // Compact the vertices still used by a live triangle
+        std::vector<int> remap(num_vertices, -1);
+        std::vector<SMVertex> vertices{};
+        std::vector<unsigned int> indices{};
+
+        indices.reserve(3 * num_faces_);
+
+        for (size_t f = 0; f < faces_.size(); ++f)
+        {
+            if (!face_alive_[f])
+            {
+                continue;
+            }
+
+            for (auto v : faces_[f])
+            {
+                if (remap[v] == -1)
+                {
+                    remap[v] = static_cast<int>(vertices.size());
+                    vertices.push_back(vertices_[v]);
+                }
+
+                indices.push_back(remap[v]);
+            }
+        }
+
+        return SurfaceMeshData{ std::move(vertices), std::move(indices) };
+    }
+
+    void MeshDecimator::decimate_chunks(size_t target_triangles, double max_error)
+    {
+        int num_vertices{ static_cast<int>(vertices_.size()) };
+
+        // Bin the vertices on a grid over the two longest axes of the bounding box
+        std::array<float, 3> low{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        std::array<float, 3> high{ std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+        for (const auto& vertex : vertices_)
+        {
+            std::array<float, 3> position{ vertex.x, vertex.y, vertex.z };
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                low[axis] = std::min(low[axis], position[axis]);
+                high[axis] = std::max(high[axis], position[axis]);
+            }
+        }
+
+        std::array<int, 3> axes{ 0, 1, 2 };
+        std::sort(axes.begin(), axes.end(), [&](int a, int b) { return high[a] - low[a] > high[b] - low[b]; });
+
+        int a0{ axes[0] };
+        int a1{ axes[1] };
+
+        double extent0{ std::max(1e-30, static_cast<double>(high[a0]) - low[a0]) };
+        double extent1{ std::max(1e-30, static_cast<double>(high[a1]) - low[a1]) };
+
+        int num_chunks{ static_cast<int>(num_faces_ / chunk_size) };
+        int nx{ std::clamp(static_cast<int>(std::sqrt(num_chunks * extent0 / extent1) + 0.5), 1, num_chunks) };
+        int ny{ std::max(1, num_chunks / nx) };
+
+        num_chunks = nx * ny;
+
+        std::vector<int> chunks(num_vertices);
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    std::array<float, 3> position{ vertices_[v].x, vertices_[v].y, vertices_[v].z };
+
+                    int i{ std::min(nx - 1, static_cast<int>((position[a0] - low[a0]) / extent0 * nx)) };
+                    int j{ std::min(ny - 1, static_cast<int>((position[a1] - low[a1]) / extent1 * ny)) };
+
+                    chunks[v] = i + nx * j;
+                }
+            }, 1 << 12);
+
+        // A vertex with a neighbor in another chunk stays put so the chunks never touch the same triangle
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    for (auto f : vertex_faces_[v])
+                    {
+                        for (auto w : faces_[f])
+                        {
+                            locked_[v] = locked_[v] || chunks[w] != chunks[v];
+                        }
+                    }
+                }
+            }, 1 << 12);
+
+        // Counting sort of the vertices by chunk
+        std::vector<int> offsets(num_chunks + 1, 0);
+        for (auto chunk : chunks)
+        {
+            ++offsets[chunk + 1];
+        }
+
+        for (int c = 0; c < num_chunks; ++c)
+        {
+            offsets[c + 1] += offsets[c];
+        }
+
+        std::vector<int> chunk_vertices(num_vertices);
+        std::vector<int> positions(offsets.begin(), offsets.end() - 1);
+
+        for (int v = 0; v < num_vertices; ++v)
+        {
+            chunk_vertices[positions[chunks[v]]++] = v;
+        }
+
+        // Triangles entirely inside a chunk are the only ones it can remove
+        std::vector<size_t> chunk_faces(num_chunks, 0);
+        for (size_t f = 0; f < faces_.size(); ++f)
+        {
+            int chunk{ chunks[faces_[f][0]] };
+
+            if (face_alive_[f] && chunks[faces_[f][1]] == chunk && chunks[faces_[f][2]] == chunk)
+            {
+                ++chunk_faces[chunk];
+            }
+        }
+
+        double ratio{ static_cast<double>(target_triangles) / num_faces_ };
+        std::vector<size_t> removed(num_chunks, 0);
+
+        parallel_for(0, num_chunks, [&](int begin, int end)
+            {
+                for (int c = begin; c < end; ++c)
+                {
+                    std::vector<QueuedCollapse> collapses{};
+
+                    for (int n = offsets[c]; n < offsets[c + 1]; ++n)
+                    {
+                        int v{ chunk_vertices[n] };
+
+                        if (!locked_[v])
+                        {
+                            for_each_owned_edge(v, [&](int w)
+                                {
+                                    if (!locked_[w])
+                                    {
+                                        collapses.push_back(queue_entry(evaluate_collapse(v, w)));
+                                    }
+                                });
+                        }
+                    }
+
+                    CollapseQueue queue{ std::greater<QueuedCollapse>{}, std::move(collapses) };
+
+                    size_t target{ static_cast<size_t>(ratio * chunk_faces[c]) };
+                    removed[c] = chunk_faces[c] - collapse_edges(queue, chunk_faces[c], target, max_error);
+                }
+            }, 1);
+
+        for (auto count : removed)
+        {
+            num_faces_ -= count;
+        }
+
+        std::fill(locked_.begin(), locked_.end(), 0);
+    }
+
+    size_t MeshDecimator::collapse_edges(CollapseQueue& queue, size_t num_faces, size_t target_triangles, double max_error)
+    {
+        while (num_faces > target_triangles && !queue.empty())
+        {
+            QueuedCollapse entry{ queue.top() };
+            queue.pop();
+
+            if (entry.stamp != stamps_[entry.u] + stamps_[entry.v] || locked_[entry.u] || locked_[entry.v]
+                || vertex_faces_[entry.u].empty() || vertex_faces_[entry.v].empty())
+            {
+                continue;
+            }
+
+            Collapse collapse{ evaluate_collapse(entry.u, entry.v) };
+
+            if (collapse.error <= max_error && check_collapse(collapse))
+            {
+                num_faces -= apply_collapse(collapse, queue);
+            }
+        }
+
+        return num_faces;
+    }
+
+    MeshDecimator::Collapse MeshDecimator::evaluate_collapse(int u, int v) const
+    {
+        Quadric quadric{ quadrics_[u] };
+        quadric += quadrics_[v];
+
+        const SMVertex& a{ vertices_[u] };
+        const SMVertex& b{ vertices_[v] };
+
+        Collapse collapse{ 0.0, 0.0, u, v };
+
+        double x{}, y{}, z{};
+
+        // Nearly singular systems can put the minimum far away from the edge
+        auto near_edge = [&](double px, double py, double pz)
+            {
+                double ex{ static_cast<double>(b.x) - a.x };
+                double ey{ static_cast<double>(b.y) - a.y };
+                double ez{ static_cast<double>(b.z) - a.z };
+                double mx{ px - 0.5 * (a.x + b.x) };
+                double my{ py - 0.5 * (a.y + b.y) };
+                double mz{ pz - 0.5 * (a.z + b.z) };
+
+                return mx * mx + my * my + mz * mz <= 4.0 * (ex * ex + ey * ey + ez * ez);
+            };
+
+        // A boundary vertex only moves along the boundary so it stays where it is
+        if (boundary_[u] != boundary_[v])
+        {
+            const SMVertex& fixed{ boundary_[u] ? a : b };
+            x = fixed.x;
+            y = fixed.y;
+            z = fixed.z;
+        }
+        else if (!quadric.minimize(x, y, z) || !near_edge(x, y, z))
+        {
+            // Fall back to the best of the endpoints and the midpoint
+            double candidates[3][3]{ { a.x, a.y, a.z }, { b.x, b.y, b.z },
+                { 0.5 * (a.x + b.x), 0.5 * (a.y + b.y), 0.5 * (a.z + b.z) } };
+
+            double best{ std::numeric_limits<double>::max() };
+            for (const auto& candidate : candidates)
+            {
+                double error{ quadric.evaluate(candidate[0], candidate[1], candidate[2]) };
+
+                if (error < best)
+                {
+                    best = error;
+                    x = candidate[0];
+                    y = candidate[1];
+                    z = candidate[2];
+                }
+            }
+        }
+
+        double ex{ static_cast<double>(b.x) - a.x };
+        double ey{ static_cast<double>(b.y) - a.y };
+        double ez{ static_cast<double>(b.z) - a.z };
+        double sqr_length{ ex * ex + ey * ey + ez * ez };
+
+        collapse.error = std::max(0.0, quadric.evaluate(x, y, z));
+        collapse.cost = collapse.error + length_weight * sqr_length * sqr_length;
+        collapse.x = static_cast<float>(x);
+        collapse.y = static_cast<float>(y);
+        collapse.z = static_cast<float>(z);
+
+        return collapse;
+    }
+
+    MeshDecimator::QueuedCollapse MeshDecimator::queue_entry(const Collapse& collapse) const
+    {
+        return { static_cast<float>(collapse.cost), collapse.u, collapse.v, stamps_[collapse.u] + stamps_[collapse.v] };
+    }
+
+    bool MeshDecimator::check_collapse(const Collapse& collapse) const
+    {
+        int u{ collapse.u };
+        int v{ collapse.v };
+
+        // Triangles on the edge and the vertices opposite it
+        int shared{ 0 };
+        for (auto f : vertex_faces_[u])
+        {
+            if (face_alive_[f] && (faces_[f][0] == v || faces_[f][1] == v || faces_[f][2] == v))
+            {
+                ++shared;
+            }
+        }
+
+        if (shared == 0 || shared > 2 || (shared == 2 && boundary_[u] && boundary_[v]))
+        {
+            return false;
+        }
+
+        // Link condition: the only vertices next to both ends are the ones opposite the edge
+        thread_local std::vector<int> ring_u{};
+        thread_local std::vector<int> ring_v{};
+
+        collect_ring(u, ring_u);
+        collect_ring(v, ring_v);
+
+        int common{ 0 };
+        for (auto w : ring_u)
+        {
+            if (w != v && std::binary_search(ring_v.begin(), ring_v.end(), w))
+            {
+                ++common;
+            }
+        }
+
+        if (common != shared)
+        {
+            return false;
+        }
+
+        // No remaining triangle may flip or turn by more than about 80 degrees
+        for (int end : { u, v })
+        {
+            for (auto f : vertex_faces_[end])
+            {
+                const auto& face{ faces_[f] };
+
+                if (!face_alive_[f] || (end == u && (face[0] == v || face[1] == v || face[2] == v)))
+                {
+                    continue;
+                }
+
+                if (end == v && (face[0] == u || face[1] == u || face[2] == u))
+                {
+                    continue;
+                }
+
+                int i{ face[0] == end ? 0 : (face[1] == end ? 1 : 2) };
+
+                const SMVertex& p{ vertices_[end] };
+                const SMVertex& q{ vertices_[face[(i + 1) % 3]] };
+                const SMVertex& r{ vertices_[face[(i + 2) % 3]] };
+
+                double ex{ static_cast<double>(q.x) - r.x };
+                double ey{ static_cast<double>(q.y) - r.y };
+                double ez{ static_cast<double>(q.z) - r.z };
+
+                double ox{ static_cast<double>(p.x) - r.x };
+                double oy{ static_cast<double>(p.y) - r.y };
+                double oz{ static_cast<double>(p.z) - r.z };
+
+                double mx{ static_cast<double>(collapse.x) - r.x };
+                double my{ static_cast<double>(collapse.y) - r.y };
+                double mz{ static_cast<double>(collapse.z) - r.z };
+
+                // Normals of (r, p, q) before and after p moves
+                double n0x{ oy * ez - oz * ey };
+                double n0y{ oz * ex - ox * ez };
+                double n0z{ ox * ey - oy * ex };
+
+                double n1x{ my * ez - mz * ey };
+                double n1y{ mz * ex - mx * ez };
+                double n1z{ mx * ey - my * ex };
+
+                double dot{ n0x * n1x + n0y * n1y + n0z * n1z };
+                double norms{ std::sqrt((n0x * n0x + n0y * n0y + n0z * n0z) * (n1x * n1x + n1y * n1y + n1z * n1z)) };
+
+                if (dot <= 0.2 * norms || norms == 0.0)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    int MeshDecimator::apply_collapse(const Collapse& collapse, CollapseQueue& queue)
+    {
+        int u{ collapse.u };
+        int v{ collapse.v };
+        int removed{ 0 };
+
+        for (auto f : vertex_faces_[u])
+        {
+            if (!face_alive_[f])
+            {
+                continue;
+            }
+
+            auto& face{ faces_[f] };
+
+            if (face[0] == v || face[1] == v || face[2] == v)
+            {
+                face_alive_[f] = 0;
+                ++removed;
+                continue;
+            }
+
+            std::replace(face.begin(), face.end(), u, v);
+            vertex_faces_[v].push_back(f);
+        }
+
+        auto& faces{ vertex_faces_[v] };
+        faces.erase(std::remove_if(faces.begin(), faces.end(), [&](int f) { return !face_alive_[f]; }), faces.end());
+
+        vertex_faces_[u].clear();
+
+        // Keep the color of an endpoint the vertex landed on, otherwise blend them
+        SMVertex& target{ vertices_[v] };
+        const SMVertex& source{ vertices_[u] };
+
+        if (collapse.x == source.x && collapse.y == source.y && collapse.z == source.z)
+        {
+            target = source;
+        }
+        else if (collapse.x != target.x || collapse.y != target.y || collapse.z != target.z)
+        {
+            target = { collapse.x, collapse.y, collapse.z,
+                0.5f * (target.r + source.r), 0.5f * (target.g + source.g), 0.5f * (target.b + source.b) };
+        }
+
+        quadrics_[v] += quadrics_[u];
+        boundary_[v] = boundary_[v] || boundary_[u] ? 1 : 0;
+
+        ++stamps_[u];
+        ++stamps_[v];
+
+        thread_local std::vector<int> ring{};
+        collect_ring(v, ring);
+
+        for (auto w : ring)
+        {
+            if (!locked_[w])
+            {
+                queue.push(queue_entry(evaluate_collapse(w, v)));
+            }
+        }
+
+        return removed;
+    }
+
+    void MeshDecimator::collect_ring(int v, std::vector<int>& ring) const
+    {
+        ring.clear();
+
+        for (auto f : vertex_faces_[v])
+        {
+            if (!face_alive_[f])
+            {
+                continue;
+            }
+
+            for (auto w : faces_[f])
+            {
+                if (w != v)
+                {
+                    ring.push_back(w);
+                }
+            }
+        }
+
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <queue>
+
+#include "surfacemeshdata.h"
+
+namespace moodysim
+{
+    // Symmetric 4x4 matrix summing squared distances to planes ax + by + cz + d = 0 (Garland and Heckbert)
+    struct Quadric
+    {
+        double a2{}, ab{}, ac{}, ad{};
+        double b2{}, bc{}, bd{};
+        double c2{}, cd{};
+        double d2{};
+
+        // Add the plane with unit normal (a, b, c) and offset d scaled by weight
+        void add_plane(double a, double b, double c, double d, double weight);
+
+        Quadric& operator+=(const Quadric& other);
+
+        // Weighted sum of squared distances from (x, y, z) to the planes
+        double evaluate(double x, double y, double z) const;
+
+        // Point minimizing the error, false when the system is close to singular
+        bool minimize(double& x, double& y, double& z) const;
+    };
+
+    // Simplify a triangle mesh by collapsing edges in order of quadric error
+    // Collapses that would flip a triangle or make the surface non-manifold are skipped
+    class MeshDecimator
+    {
+    public:
+
+        explicit MeshDecimator(const SurfaceMeshData& mesh);
+
+        // Collapse edges with quadric error up to max_error, cheapest first, until at most target_triangles remain
+        // Returns a new mesh holding only the vertices still in use
+        SurfaceMeshData decimate(size_t target_triangles, double max_error = std::numeric_limits<double>::max());
+
+        // Planes along boundary edges are scaled by this to keep the outline in place
+        static constexpr double boundary_weight{ 100.0 };
+
+        // Meshes with at least twice this many triangles are first decimated in spatial chunks of
+        // about this size in parallel, keeping the vertices on chunk borders for a final global pass
+        static constexpr size_t chunk_size{ 1 << 16 };
+
+        // Scale of the fourth power of the edge length added to the cost to break ties between zero error collapses
+        static constexpr double length_weight{ 1e-6 };
+
+    private:
+
+        // Collapse of edge u-v with u merged into v at the position minimizing the error
+        // cost adds a small edge length term to error so flat regions collapse short edges first
+        struct Collapse
+        {
+            double cost{};
+            double error{};
+            int u{}, v{};
+            float x{}, y{}, z{};
+        };
+
+        // Queue entry kept small since most entries go stale before they are popped
+        // stamp is the sum of the vertex stamps when queued which only grow, so any change to u or v shows up
+        struct QueuedCollapse
+        {
+            float cost{};
+            int u{}, v{};
+            unsigned int stamp{};
+
+            bool operator>(const QueuedCollapse& other) const { return cost > other.cost; }
+        };
+
+        using CollapseQueue = std::priority_queue<QueuedCollapse, std::vector<QueuedCollapse>, std::greater<QueuedCollapse>>;
+
+        QueuedCollapse queue_entry(const Collapse& collapse) const;
+
+        // Collapse each chunk toward its share of target_triangles with its own queue
+        void decimate_chunks(size_t target_triangles, double max_error);
+
+        // Pop and apply collapses until num_faces reaches target_triangles, returns the new triangle count
+        size_t collapse_edges(CollapseQueue& queue, size_t num_faces, size_t target_triangles, double max_error);
+
+        // Call func(w) for each edge v-w with v < w so every edge is visited from one end
+        template <typename Func>
+        void for_each_owned_edge(int v, Func&& func) const;
+
+        // Cost and target position of collapsing edge u-v
+        Collapse evaluate_collapse(int u, int v) const;
+
+        // Check that the collapse keeps the surface manifold and does not flip any triangle
+        bool check_collapse(const Collapse& collapse) const;
+
+        // Merge u into v at the collapse position and queue the new edges around v
+        // Returns the number of triangles removed
+        int apply_collapse(const Collapse& collapse, CollapseQueue& queue);
+
+        // Vertices sharing a live triangle with v
+        void collect_ring(int v, std::vector<int>& ring) const;
+
+        std::vector<SMVertex> vertices_{};
+        std::vector<std::array<int, 3>> faces_{};
+        // Flags are stored as char so chunks can write neighboring entries from different threads
+        std::vector<char> face_alive_{};
+
+        // Triangles containing each vertex, dead triangles are removed lazily
+        std::vector<std::vector<int>> vertex_faces_{};
+
+        std::vector<Quadric> quadrics_{};
+        std::vector<char> boundary_{};
+
+        // Vertices that may not be collapsed in the current pass
+        std::vector<char> locked_{};
+
+        // Incremented whenever a vertex moves so queued collapses can be recognized as stale
+        std::vector<unsigned int> stamps_{};
+
+        size_t num_faces_{};
+    };
+}
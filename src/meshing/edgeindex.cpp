@@ -0,0 +1,221 @@
+#include "edgeindex.h"
+
+#include <atomic>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    void EdgeIndex::build(const std::vector<std::array<int, 3>>& triangles, const std::vector<std::array<int, 3>>& neighbors)
+    {
+        // A triangulation has fewer than 3 / 2 * T + hull edges, 2 * T is a safe bound
+        clear();
+        reserve(2 * triangles.size());
+
+        std::atomic<size_t> count{ 0 };
+
+        // Each edge is inserted once by the triangle where it runs from the lower to the
+        // higher vertex, or by its only triangle on the boundary, so the threads never race
+        // on the same key and only need to claim empty slots
+        parallel_for(0, static_cast<int>(triangles.size()), [&](int begin, int end)
+            {
+                size_t local_count{ 0 };
+
+                for (int t = begin; t < end; ++t)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        int a{ triangles[t][i] };
+                        int b{ triangles[t][(i + 1) % 3] };
+
+                        if (a > b && neighbors[t][i] != -1)
+                        {
+                            continue;
+                        }
+
+                        std::uint64_t key{ make_key(a, b) };
+                        size_t slot{ home_slot(key) };
+
+                        while (true)
+                        {
+                            std::uint64_t expected{ empty_key };
+                            std::atomic_ref<std::uint64_t> slot_key{ keys_[slot] };
+
+                            if (slot_key.load(std::memory_order_relaxed) == empty_key &&
+                                slot_key.compare_exchange_strong(expected, key, std::memory_order_relaxed))
+                            {
+                                values_[slot] = t;
+                                break;
+                            }
+
+                            slot = (slot + 1) & (keys_.size() - 1);
+                        }
+
+                        ++local_count;
+                    }
+                }
+
+                count += local_count;
+            });
+
+        size_ = count;
+    }
+
+    void EdgeIndex::insert(int a, int b, int triangle)
+    {
+        if (2 * (size_ + 1) > keys_.size())
+        {
+            reserve(2 * (size_ + 1));
+        }
+
+        std::uint64_t key{ make_key(a, b) };
+        size_t slot{ home_slot(key) };
+
+        while (keys_[slot] != empty_key)
+        {
+            if (keys_[slot] == key)
+            {
+                values_[slot] = triangle;
+                return;
+            }
+
+            slot = (slot + 1) & (keys_.size() - 1);
+        }
+
+        keys_[slot] = key;
+        values_[slot] = triangle;
+        ++size_;
+    }
+
+    void EdgeIndex::erase(int a, int b)
+    {
+        if (keys_.empty())
+        {
+            return;
+        }
+
+        size_t mask{ keys_.size() - 1 };
+        std::uint64_t key{ make_key(a, b) };
+        size_t slot{ home_slot(key) };
+
+        while (keys_[slot] != key)
+        {
+            if (keys_[slot] == empty_key)
+            {
+                return;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+
+        // Shift later entries of the probe sequence back into the hole unless
+        // that would move them in front of their home slot
+        size_t next{ slot };
+
+        while (true)
+        {
+            next = (next + 1) & mask;
+
+            if (keys_[next] == empty_key)
+            {
+                break;
+            }
+
+            size_t home{ home_slot(keys_[next]) };
+
+            bool movable{ next > slot ? (home <= slot || home > next) : (home <= slot && home > next) };
+
+            if (movable)
+            {
+                keys_[slot] = keys_[next];
+                values_[slot] = values_[next];
+                slot = next;
+            }
+        }
+
+        keys_[slot] = empty_key;
+        --size_;
+    }
+
+    int EdgeIndex::find(int a, int b) const
+    {
+        if (keys_.empty())
+        {
+            return -1;
+        }
+
+        std::uint64_t key{ make_key(a, b) };
+        size_t slot{ home_slot(key) };
+
+        while (keys_[slot] != empty_key)
+        {
+            if (keys_[slot] == key)
+            {
+                return values_[slot];
+            }
+
+            slot = (slot + 1) & (keys_.size() - 1);
+        }
+
+        return -1;
+    }
+
+    void EdgeIndex::clear()
+    {
+        keys_.clear();
+        values_.clear();
+        size_ = 0;
+        shift_ = 64;
+    }
+
+    std::uint64_t EdgeIndex::make_key(int a, int b)
+    {
+        if (a > b)
+        {
+            std::swap(a, b);
+        }
+
+        return (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b);
+    }
+
+    size_t EdgeIndex::home_slot(std::uint64_t key) const
+    {
+        // Fibonacci hashing keeps the high bits which mix both vertices
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void EdgeIndex::reserve(size_t num_edges)
+    {
+        size_t capacity{ 16 };
+        int bits{ 4 };
+
+        while (capacity < 2 * num_edges)
+        {
+            capacity *= 2;
+            ++bits;
+        }
+
+        if (capacity <= keys_.size())
+        {
+            return;
+        }
+
+        std::vector<std::uint64_t> old_keys{ std::move(keys_) };
+        std::vector<int> old_values{ std::move(values_) };
+
+        keys_.assign(capacity, empty_key);
+        values_.assign(capacity, -1);
+        shift_ = 64 - bits;
+        size_ = 0;
+
+        for (size_t slot = 0; slot < old_keys.size(); ++slot)
+        {
+            if (old_keys[slot] != empty_key)
+            {
+                int a{ static_cast<int>(old_keys[slot] >> 32) };
+                int b{ static_cast<int>(old_keys[slot] & 0xFFFFFFFFu) };
+                insert(a, b, old_values[slot]);
+            }
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace moodysim
+{
+    // Open addressing hash map from an undirected edge (sorted vertex pair)
+    // to the index of a triangle containing it
+    // Linear probing with backward shift deletion so there are no tombstones
+    class EdgeIndex
+    {
+    public:
+
+        // Index every edge of the triangulation in parallel
+        void build(const std::vector<std::array<int, 3>>& triangles, const std::vector<std::array<int, 3>>& neighbors);
+
+        // Insert edge a-b or reassign it if it is already present
+        void insert(int a, int b, int triangle);
+
+        void erase(int a, int b);
+
+        // The triangle containing edge a-b in either direction (-1 if not present)
+        int find(int a, int b) const;
+
+        void clear();
+
+        bool empty() const { return keys_.empty(); }
+        size_t size() const { return size_; }
+        size_t capacity() const { return keys_.size(); }
+
+    private:
+
+        static constexpr std::uint64_t empty_key{ ~std::uint64_t{ 0 } };
+
+        static std::uint64_t make_key(int a, int b);
+
+        size_t home_slot(std::uint64_t key) const;
+
+        // Reallocate with room for at least num_edges at a load factor of one half
+        void reserve(size_t num_edges);
+
+        std::vector<std::uint64_t> keys_{};
+        std::vector<int> values_{};
+
+        size_t size_{ 0 };
+        int shift_{ 64 };
+    };
+}
@@ -4,9 +4,17 @@
 #include <vector>
 #include <array>
 #include <stack>
+#include <deque>
+#include <unordered_map>
+#include <queue>
+#include <limits>
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "surfacemeshdata.h"
+#include "parallel.h"
+#include "pointsource.h"
 
 namespace moodysim
 {
@@ -67,7 +75,29 @@ namespace moodysim
     std::vector<Point3D> generate_sample_points(float radius, int density)
     {
         std::vector<Point3D> vertices{};
+        vertices.reserve(sample_points_bound(radius, density));
 
+        for (auto point : stream_sample_points(radius, density))
+        {
+            vertices.push_back(point);
+        }
+
+        return vertices;
+    }
+
+    size_t sample_points_bound(float radius, int density)
+    {
+        // Every lattice point in the bounding rows plus the perimeter as laid out by stream_sample_points
+        const int xpoints{ static_cast<int>(2.0f * radius * density) + 1 };
+        const float yspace = 0.8660f * 2.0f / (xpoints - 1);
+        const int ypoints{ static_cast<int>(2.0f * radius / yspace) + 2 };
+        const int perimeter_size{ static_cast<int>(xpoints * 3.14159f) };
+
+        return static_cast<size_t>(xpoints) * ypoints + perimeter_size;
+    }
+
+    Generator<Point3D> stream_sample_points(float radius, int density)
+    {
         const int xpoints{ static_cast<int>(2.0f * radius * density) + 1 };
 
         const float xspace = 2.0f / (xpoints - 1);
@@ -84,8 +114,6 @@ namespace moodysim
         // Size of the circle boundary
         const float sqr_radius{ radius * radius };
 
-        vertices.reserve(xpoints * ypoints);
-
         for (int j = 0; j < ypoints; ++j)
         {
             float xshift{ 0.f };
@@ -111,7 +139,7 @@ namespace moodysim
                 float cutoff{ sqr_radius - halfspace };
                 if (sqr_dist <= cutoff)
                 {
-                    vertices.push_back({ x, y, z });
+                    co_yield Point3D{ x, y, z };
                 }
             }
         }
@@ -129,18 +157,43 @@ namespace moodysim
             float y{ radius * sinf(i * angle) };
             float z = 0.0f;
 
-            vertices.push_back({ x, y, z });
+            co_yield Point3D{ x, y, z };
         }
+    }
 
 
-        return std::move(vertices);
-    }
+    DelaunayGenerator::DelaunayGenerator(PointSource& source, std::vector<Edge> edges, std::vector<Point3D> holes)
+        : edges_(std::move(edges)), holes_(std::move(holes))
+    {
+        // Leave room for the super triangle so triangulate does not move the points again
+        points_.reserve(source.size_hint() + 3);
 
+        while (source.read(points_, point_chunk_size) > 0)
+        {
+        }
+    }
 
     SurfaceMeshData DelaunayGenerator::generate_delaunay_mesh()
     {
         triangulate();
 
+        if (!edges_.empty())
+        {
+            apply_constraint();
+
+            // Open polylines have no outside, flooding from the hull would remove every triangle
+            if (!holes_.empty() || check_closed_constraints())
+            {
+                remove_exterior();
+            }
+        }
+
+        // Downstream solvers assemble and multiply in vertex order so neighbors should be close in memory
+        if (renumbering_)
+        {
+            renumber(renumbering_method_);
+        }
+
         std::vector<SMVertex> vertices{};
         std::vector<unsigned int> indices{};
 
@@ -164,355 +217,3065 @@ namespace moodysim
 
     void DelaunayGenerator::triangulate()
     {
-        // number of points not counting the super triangle
-        int num_pts{ static_cast<int>(points_.size()) };
+        // A generator restored from a finished triangulation, such as a checkpoint taken
+        // while refining, already has its triangles
+        if (num_input_points_ < 0 && !triangles_.empty())
+        {
+            return;
+        }
+
+        // A generator restored from a checkpoint during triangulation already has its super triangle
+        if (num_input_points_ < 0)
+        {
+            // number of points not counting the super triangle
+            num_input_points_ = static_cast<int>(points_.size());
+            next_point_ = 0;
+
+            // Input points start where they are, renumber keeps the ordering up to date
+            // while the super triangle and Steiner points get no entry
+            if (point_ordering_.empty())
+            {
+                point_ordering_.resize(num_input_points_);
+                std::iota(point_ordering_.begin(), point_ordering_.end(), 0);
+            }
 
-        // Normalize the points vector
-        //normalize_points();
+            // Normalize the points vector
+            //normalize_points();
 
-        // If sorting into bins, do it here (would need to map sorted points back to the original points)
+            // If sorting into bins, do it here (would need to map sorted points back to the original points)
 
-        /* points_.push_back({ -0.95f, -0.95f, 0.f });
-        points_.push_back({ 0.95f, -0.95f, 0.f });
-        points_.push_back({ 0.f, 0.95f, 0.f }); */
+            /* points_.push_back({ -0.95f, -0.95f, 0.f });
+            points_.push_back({ 0.95f, -0.95f, 0.f });
+            points_.push_back({ 0.f, 0.95f, 0.f }); */
 
-        // Add super triangle (-1 denotes no neighbor for that edge)
-        points_.push_back({ -100.f, -100.f, 0.f });
-        points_.push_back({ 100.f, -100.f, 0.f });
-        points_.push_back({ 0.f, 100.f, 0.f });
+            // Add super triangle (-1 denotes no neighbor for that edge)
+            // reserving exactly so a full vector grows by 3 points instead of doubling
+            points_.reserve(points_.size() + 3);
+            points_.push_back({ -100.f, -100.f, 0.f });
+            points_.push_back({ 100.f, -100.f, 0.f });
+            points_.push_back({ 0.f, 100.f, 0.f });
+            triangles_.push_back({ num_input_points_, num_input_points_ + 1, num_input_points_ + 2 });
+            neighbors_.push_back({ -1, -1, -1 });
+
+            vertex_triangle_.assign(points_.size(), -1);
+            vertex_triangle_[num_input_points_] = 0;
+            vertex_triangle_[num_input_points_ + 1] = 0;
+            vertex_triangle_[num_input_points_ + 2] = 0;
+        }
+
+        int num_pts{ num_input_points_ };
         std::array<int, 3> super_triangle{ num_pts, num_pts + 1, num_pts + 2 };
-        triangles_.push_back(super_triangle);
-        neighbors_.push_back({ -1, -1, -1 });
 
+        // Add each point one at a time fixing any triangles that violate the delaunay condition
+        // next_point_ counts the inserted points so a checkpoint resumes after the last one
+        while (next_point_ < num_pts)
+        {
+            insert_point(next_point_++);
+
+            if (checkpoint_ && checkpoint_interval_ > 0 && next_point_ % checkpoint_interval_ == 0)
+            {
+                checkpoint_(*this);
+            }
+        }
+
+        // Remove triangles that include a vertex from the super triangle
+        // They are all marked first so the fan around every vertex is still whole while
+        // vertex_triangle_ is moved to the kept triangles
+        int num_triangles{ static_cast<int>(triangles_.size()) };
+        std::vector<char> removed(num_triangles, 0);
+
+        for (int t = 0; t < num_triangles; ++t)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    // if set to true keep it true otherwise check the condition
+                    bool match{ triangles_[t][i] == super_triangle[j] };
+                    removed[t] = removed[t] || match;
+                }
+            }
+
+            if (removed[t])
+            {
+                for (int v : triangles_[t])
+                {
+                    if (vertex_triangle_[v] == t)
+                    {
+                        vertex_triangle_[v] = -1;
+                    }
+                }
+            }
+        }
+
+        // A vertex with both kept and removed triangles has a removed triangle next to a kept one
+        // across an edge through the vertex, vertices left at -1 are only in removed triangles
+        for (int t = 0; t < num_triangles; ++t)
+        {
+            if (!removed[t])
+            {
+                continue;
+            }
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int neighbor{ neighbors_[t][i] };
+
+                if (neighbor != -1 && !removed[neighbor])
+                {
+                    vertex_triangle_[triangles_[t][i]] = neighbor;
+                    vertex_triangle_[triangles_[t][(i + 1) % 3]] = neighbor;
+                }
+            }
+        }
+
+        for (int t = 0; t < num_triangles; ++t)
+        {
+            if (removed[t])
+            {
+                triangles_[t][0] = -1;
+            }
+        }
+
+        compact_triangles();
+
+        build_edge_index();
+
+        num_input_points_ = -1;
+    }
+
+    void DelaunayGenerator::get_state(DelaunayState& state) const
+    {
+        state.points.assign(points_.begin(), points_.end());
+        state.point_ordering.assign(point_ordering_.begin(), point_ordering_.end());
+        state.edges.assign(edges_.begin(), edges_.end());
+        state.holes.assign(holes_.begin(), holes_.end());
+        state.triangles.assign(triangles_.begin(), triangles_.end());
+        state.neighbors.assign(neighbors_.begin(), neighbors_.end());
+        state.vertex_triangles.assign(vertex_triangle_.begin(), vertex_triangle_.end());
+        state.constrained_edges.assign(constrained_edges_.begin(), constrained_edges_.end());
+
+        state.num_steiner_points = num_steiner_points_;
+        state.steiner_placement = steiner_placement_;
+        state.num_input_points = num_input_points_;
+        state.next_point = next_point_;
+    }
+
+    void DelaunayGenerator::set_state(DelaunayState state)
+    {
+        points_ = std::move(state.points);
+        point_ordering_ = std::move(state.point_ordering);
+        edges_ = std::move(state.edges);
+        holes_ = std::move(state.holes);
+        triangles_ = std::move(state.triangles);
+        neighbors_ = std::move(state.neighbors);
+        vertex_triangle_ = std::move(state.vertex_triangles);
+        constrained_edges_ = { state.constrained_edges.begin(), state.constrained_edges.end() };
+
+        num_steiner_points_ = state.num_steiner_points;
+        steiner_placement_ = state.steiner_placement;
+        num_input_points_ = state.num_input_points;
+        next_point_ = state.next_point;
+
+        // The edge index only exists once triangulation is finished
+        edge_index_.clear();
+
+        if (num_input_points_ < 0 && !triangles_.empty())
+        {
+            build_edge_index();
+        }
+    }
+
+    void DelaunayGenerator::insert_point(int p)
+    {
+        // First determine which triangle the new point is inside
+        int enclosing_tri_idx{ find_enclosing_triangle(p) };
+
+        if (enclosing_tri_idx == -1)
+        {
+            return;
+        }
+
+        insert_point(p, enclosing_tri_idx);
+    }
+
+    void DelaunayGenerator::insert_point(int p, int enclosing_tri_idx)
+    {
+
+        // A point on an edge would leave a flat triangle so the edge is split instead
+        for (int e = 0; e < 3; ++e)
+        {
+            Point3D e1{ points_[triangles_[enclosing_tri_idx][e]] };
+            Point3D e2{ points_[triangles_[enclosing_tri_idx][(e + 1) % 3]] };
+
+            double sqr_length{ dot_product(subtract(e2, e1), subtract(e2, e1)) };
+
+            if (std::abs(orientation(e1, e2, points_[p])) <= 1e-6 * sqr_length)
+            {
+                split_edge(p, enclosing_tri_idx, e);
+                return;
+            }
+        }
 
         // A stack is used to track triangles that need to be checked
         std::stack<int> tri_stack{};
 
-        // Add each point one at a time fixing any triangles that violate the delaunay condition
-        for (int p = 0; p < num_pts; ++p)
+        std::array<int, 3> enclosing_tri{ triangles_[enclosing_tri_idx] };
+        std::array<int, 3> enclosing_adj{ neighbors_[enclosing_tri_idx] };
+
+        // Delete the enclosing triangle and create 3 new triangles between
+        // the enclosing vertices and the new vertex p (Always make p the first vertex)
+        // replace enclosing triangle with the first new one and add the other two to the vector
+        // Keep vertex indices ordered counter-clockwise for each triangle 
+        triangles_[enclosing_tri_idx] = { p, enclosing_tri[0], enclosing_tri[1] };
+        triangles_.push_back({ p, enclosing_tri[1], enclosing_tri[2] });
+        triangles_.push_back({ p, enclosing_tri[2], enclosing_tri[0] });
+
+        // Indices for the new triangles
+        int tri_0{ enclosing_tri_idx };
+        int tri_1{ static_cast<int>(triangles_.size()) - 2 };
+        int tri_2{ static_cast<int>(triangles_.size()) - 1 };
+
+        /* // Push the new triangles onto the stack
+        tri_stack.push(tri_0);
+        tri_stack.push(tri_1);
+        tri_stack.push(tri_2); */
+
+        // The triangles adjacent to the original triangle become the opposite adjacent neighbor
+        // to the new triangles i.e. they share the edge that does not include the new point
+        int opp_adj_0 = enclosing_adj[0];;
+        int opp_adj_1 = enclosing_adj[1];
+        int opp_adj_2 = enclosing_adj[2];
+
+        // When adding to the adjacency list make the opposite adjacent triangle to p
+        // the middle adjacency entry so we know when popping a triangle t from the stack
+        // that the opposite adjacent edge to point triangles[t][0] is adjacency[t][1] (not 2)
+
+        // The statement "In general for element I in the stack, the opposite adjacent triangle
+        // is given by E(2, I)" Confused me since fortran starts arrays at 1 not 0 and the paper
+        // didn't specify a relative position i.e. middle vs last but it turns out to be middle
+        // so actually we need E(1, I) to be opposite adjacent of p not E(2, I)
+
+        // Update existing adjancency entry
+        neighbors_[tri_0][0] = tri_2;
+        neighbors_[tri_0][1] = opp_adj_0;
+        neighbors_[tri_0][2] = tri_1;
+
+        //adjacency[tri_1][0] = tri_0;
+        //adjacency[tri_1][1] = opp_adj_1;
+        //adjacency[tri_1][2] = tri_2;
+
+        //adjacency[tri_2][0] = tri_1;
+        //adjacency[tri_2][1] = opp_adj_2;
+        //adjacency[tri_2][2] = tri_0;
+
+        // Add adjacency entries for the two new triangles
+        neighbors_.push_back({ tri_0, opp_adj_1, tri_2 });
+        neighbors_.push_back({ tri_1, opp_adj_2, tri_0 });
+
+        // The reused triangle no longer contains the last enclosing vertex
+        if (vertex_triangle_.size() < points_.size())
+        {
+            vertex_triangle_.resize(points_.size(), -1);
+        }
+
+        vertex_triangle_[p] = tri_0;
+        vertex_triangle_[enclosing_tri[0]] = tri_0;
+        vertex_triangle_[enclosing_tri[1]] = tri_1;
+        vertex_triangle_[enclosing_tri[2]] = tri_2;
+
+        index_triangle(tri_0);
+        index_triangle(tri_1);
+        index_triangle(tri_2);
+
+
+        // Place the new triangles containing p in the stack as long as the edges opposite
+        // p have a neighboring triangle (i.e. is not on a boundary t = -1)
+        // While doing this update the adjacency list for the enclosing triangles neighbors
+        // as long as they exist (!= -1) The first one enclosing_adj[0] does not need to be 
+        // updated since it already points to tri_0 since it was reused but it wont hurt
+
+        if (opp_adj_0 != -1)
+        {
+            tri_stack.push(tri_0);
+        }
+        if (opp_adj_1 != -1)
+        {
+            // Update opposite adjancent 1's neighbor entry that used to point
+            // to enclosing triangle to now point toward triangle 1
+            update_adjacent(opp_adj_1, enclosing_tri_idx, tri_1);
+
+            tri_stack.push(tri_1);
+        }
+        if (opp_adj_2 != -1)
+        {
+            // Update opposite adjancent 2's neighbor entry that used to point
+            // to enclosing triangle to now point toward triangle 2
+            update_adjacent(opp_adj_2, enclosing_tri_idx, tri_2);
+
+            tri_stack.push(tri_2);
+        }
+
+
+        restore_delaunay(tri_stack);
+    }
+
+    void DelaunayGenerator::split_edge(int p, int tri, int edge)
+    {
+        int a{ triangles_[tri][edge] };
+        int b{ triangles_[tri][(edge + 1) % 3] };
+        int opp{ neighbors_[tri][edge] };
+
+        int tri_1{ static_cast<int>(triangles_.size()) };
+        int opp_1{ opp != -1 ? tri_1 + 1 : -1 };
+
+        triangles_.resize(triangles_.size() + (opp != -1 ? 2 : 1));
+        neighbors_.resize(triangles_.size());
+
+        if (vertex_triangle_.size() < points_.size())
+        {
+            vertex_triangle_.resize(points_.size(), -1);
+        }
+
+        split_edge_slots(p, tri, edge, tri_1, opp_1);
+
+        std::stack<int> tri_stack{};
+        tri_stack.push(tri);
+        tri_stack.push(tri_1);
+
+        if (opp != -1)
+        {
+            tri_stack.push(opp);
+            tri_stack.push(opp_1);
+        }
+
+        if (!edge_index_.empty())
+        {
+            edge_index_.erase(a, b);
+            index_triangle(tri);
+            index_triangle(tri_1);
+
+            if (opp != -1)
+            {
+                index_triangle(opp);
+                index_triangle(opp_1);
+            }
+        }
+
+        // A constraint passing through p now consists of two pieces
+        if (constrained_edges_.erase(edge_key(a, b)) != 0)
+        {
+            constrained_edges_.insert(edge_key(a, p));
+            constrained_edges_.insert(edge_key(p, b));
+        }
+
+        restore_delaunay(tri_stack);
+    }
+
+    void DelaunayGenerator::begin_streaming(float xmin, float ymin, float xmax, float ymax)
+    {
+        // Same proportions as the super triangle of triangulate so a box of [-1, 1] gives the same corners
+        float cx{ 0.5f * (xmin + xmax) };
+        float cy{ 0.5f * (ymin + ymax) };
+        float half{ 0.5f * std::max(xmax - xmin, ymax - ymin) };
+
+        if (half <= 0.f)
+        {
+            half = 1.f;
+        }
+
+        points_ = {
+            { cx - 100.f * half, cy - 100.f * half, 0.f },
+            { cx + 100.f * half, cy - 100.f * half, 0.f },
+            { cx, cy + 100.f * half, 0.f } };
+
+        triangles_ = { { 0, 1, 2 } };
+        neighbors_ = { { -1, -1, -1 } };
+        vertex_triangle_ = { 0, 0, 0 };
+
+        point_ordering_.clear();
+        edges_.clear();
+        holes_.clear();
+        constrained_edges_.clear();
+        edge_index_.clear();
+
+        num_input_points_ = -1;
+        next_point_ = 0;
+    }
+
+    int DelaunayGenerator::add_point(Point3D point, int near)
+    {
+        int tri{ near >= 0 && near < static_cast<int>(points_.size()) ? vertex_triangle_[near] : -1 };
+
+        if (tri != -1)
+        {
+            Edge blocking{};
+            tri = locate_visible(tri, point, blocking);
+        }
+
+        // The walk stops at removed triangles when it does not go straight around them
+        if (tri == -1)
+        {
+            tri = find_enclosing_triangle(point);
+        }
+
+        if (tri == -1)
+        {
+            return -1;
+        }
+
+        int p{ static_cast<int>(points_.size()) };
+
+        points_.push_back(point);
+        vertex_triangle_.push_back(-1);
+
+        insert_point(p, tri);
+
+        return p;
+    }
+
+    void DelaunayGenerator::evict_triangles(const std::vector<char>& evict, std::vector<std::array<int, 3>>& evicted, std::vector<int>& point_remap)
+    {
+        // compact_triangles removes triangles marked with -1 and gives their neighbors -1
+        for (size_t t = 0; t < triangles_.size(); ++t)
+        {
+            if (evict[t])
+            {
+                evicted.push_back(triangles_[t]);
+                triangles_[t][0] = -1;
+            }
+        }
+
+        compact_triangles();
+
+        point_remap.assign(points_.size(), -1);
+
+        for (const auto& triangle : triangles_)
+        {
+            for (int v : triangle)
+            {
+                point_remap[v] = 0;
+            }
+        }
+
+        int count{ 0 };
+
+        for (size_t v = 0; v < points_.size(); ++v)
+        {
+            if (point_remap[v] != -1)
+            {
+                point_remap[v] = count;
+                points_[count++] = points_[v];
+            }
+        }
+
+        points_.resize(count);
+
+        parallel_for(0, static_cast<int>(triangles_.size()), [&](int begin, int end)
+            {
+                for (int t = begin; t < end; ++t)
+                {
+                    for (auto& v : triangles_[t])
+                    {
+                        v = point_remap[v];
+                    }
+                }
+            });
+
+        // Vertices whose triangle was removed need another one
+        build_vertex_triangles();
+    }
+
+    void DelaunayGenerator::split_edge_slots(int p, int tri, int edge, int tri_1, int opp_1)
+    {
+        // Rotate so the split edge a-b is the first edge of tri = (a, b, c)
+        rotate_vertices(tri, edge);
+
+        std::array<int, 3> tri_pts{ triangles_[tri] };
+        std::array<int, 3> tri_adj{ neighbors_[tri] };
+
+        int a{ tri_pts[0] };
+        int b{ tri_pts[1] };
+        int c{ tri_pts[2] };
+        int opp{ tri_adj[0] };
+
+        // Keep p first and the triangle opposite p in the middle as in insert_point
+        int tri_0{ tri };
+
+        triangles_[tri_0] = { p, b, c };
+        triangles_[tri_1] = { p, c, a };
+        neighbors_[tri_0] = { -1, tri_adj[1], tri_1 };
+        neighbors_[tri_1] = { tri_0, tri_adj[2], -1 };
+
+        if (tri_adj[2] != -1)
+        {
+            update_adjacent(tri_adj[2], tri, tri_1);
+        }
+
+        if (opp != -1)
+        {
+            // The triangle on the other side is (b, a, d)
+            int k{ 0 };
+            while (triangles_[opp][k] != b)
+            {
+                ++k;
+            }
+
+            rotate_vertices(opp, k);
+
+            std::array<int, 3> opp_adj{ neighbors_[opp] };
+            int d{ triangles_[opp][2] };
+
+            int opp_0{ opp };
+
+            triangles_[opp_0] = { p, a, d };
+            triangles_[opp_1] = { p, d, b };
+            neighbors_[opp_0] = { tri_1, opp_adj[1], opp_1 };
+            neighbors_[opp_1] = { opp_0, opp_adj[2], tri_0 };
+
+            neighbors_[tri_0][0] = opp_1;
+            neighbors_[tri_1][2] = opp_0;
+
+            if (opp_adj[2] != -1)
+            {
+                update_adjacent(opp_adj[2], opp, opp_1);
+            }
+
+            vertex_triangle_[d] = opp;
+        }
+
+        vertex_triangle_[p] = tri_0;
+        vertex_triangle_[b] = tri_0;
+        vertex_triangle_[c] = tri_0;
+        vertex_triangle_[a] = tri_1;
+    }
+
+    void DelaunayGenerator::restore_delaunay(std::stack<int>& tri_stack)
+    {
+        // Check Delaunay condition and swap as needed propagating via the stack
+        while (!tri_stack.empty())
+        {
+            int tri_l = tri_stack.top();
+            tri_stack.pop();
+
+            // the point that was added when tri_l was formed
+            int point_p = triangles_[tri_l][0];
+
+            // The triangle opposite adjacent to the point p
+            int tri_r = neighbors_[tri_l][1];
+
+            // Constraint edges are never swapped when inserting into a constrained triangulation
+            bool constrained{ tri_r != -1 && !constrained_edges_.empty() &&
+                constrained_edges_.count(edge_key(triangles_[tri_l][1], triangles_[tri_l][2])) != 0 };
+
+            // Check if point p is inside the circumcircle of triangle r
+            if (tri_r != -1 && !constrained && check_delaunay(tri_l, tri_r))
+            {
+                // Swap the diagonal edge by updating the points of l and r
+                // then update the adjancies of the effected neighbors
+                swap_triangles(tri_l, tri_r);
+
+                // There are now potentially two triangles adjacent to l and r (A, B)
+                // that are opposite p. place the l on the stack if A exists and r on the stack if B exists
+                if (neighbors_[tri_l][1] != -1)
+                {
+                    tri_stack.push(tri_l);
+                }
+                if (neighbors_[tri_r][1] != -1)
+                {
+                    tri_stack.push(tri_r);
+                }
+            }
+        }
+    }
+
+    bool DelaunayGenerator::apply_constraint(ConstraintMode mode)
+    {
+        if (mode == ConstraintMode::Conforming)
         {
-            // First determine which triangle the new point is inside
-            int enclosing_tri_idx{ find_enclosing_triangle(p) };
+            return conform_constraints();
+        }
 
-            std::array<int, 3> enclosing_tri{ triangles_[enclosing_tri_idx] };
-            std::array<int, 3> enclosing_adj{ neighbors_[enclosing_tri_idx] };
+        if (edge_index_.empty())
+        {
+            build_edge_index();
+        }
+
+        bool inserted_all{ true };
+
+        // Loop over the constraining edges
+        for (int constraint = 0; constraint < edges_.size(); ++constraint)
+        {
+            int con_start = edges_[constraint].n1;
+            int con_end = edges_[constraint].n2;
+
+            // Check that both vertices of the constraint are part of the triangulation
+            if (vertex_triangle_[con_start] == -1 || vertex_triangle_[con_end] == -1)
+            {
+                std::cerr << "Error: Constraint " << constraint << " has a vertex outside the triangulation" << std::endl;
+                inserted_all = false;
+                continue;
+            }
+
+            // The constraint may pass directly through other vertices in which case it
+            // is inserted one piece at a time starting from the last vertex reached
+            int piece_start{ con_start };
+
+            while (piece_start != con_end)
+            {
+                // Walk from triangle to triangle in the direction of the constraint end point
+                // adding any intersecting edges along the way
+                ConstraintCrossing crossing{ walk_constraint(piece_start, con_end) };
+
+                if (crossing.end == -1)
+                {
+                    std::cerr << "Error: Failed to find a matching or intersecting triangle for constraint " << constraint << std::endl;
+                    inserted_all = false;
+                    break;
+                }
+
+                // If nothing was crossed the edge is already a part of the triangulation
+                bool inserted{ true };
+
+                if (!crossing.edges.empty())
+                {
+                    // Flipping is cheap for short constraints but can cycle through the crossing
+                    // list many times for long ones, where rebuilding the cavity is linear
+                    bool use_cavity{ mode == ConstraintMode::Cavity };
+
+                    if (mode == ConstraintMode::Automatic)
+                    {
+                        use_cavity = crossing.edges.size() > cavity_crossing_threshold;
+                    }
+
+                    inserted = use_cavity ? insert_constraint_cavity(piece_start, crossing) : insert_constraint_flip(piece_start, crossing);
+                }
+
+                // A piece that is not in the mesh must not lock the edges around it
+                if (!inserted)
+                {
+                    std::cerr << "Error: Failed to insert constraint " << constraint << std::endl;
+                    inserted_all = false;
+                    break;
+                }
+
+                constrained_edges_.insert(edge_key(piece_start, crossing.end));
+
+                piece_start = crossing.end;
+            }
+        }
+
+        return inserted_all;
+    }
+
+    bool DelaunayGenerator::conform_constraints()
+    {
+        // The pieces of each constraint that still have to be checked
+        std::vector<Edge> segments{ edges_ };
+
+        // Pieces that are encroached or missing but too short to split
+        std::vector<char> failed(segments.size(), 0);
+
+        std::vector<char> input_vertex{ input_vertices() };
+
+        if (edge_index_.empty())
+        {
+            build_edge_index();
+        }
+
+        // Keep splitting until a full pass over the pieces finds nothing encroached
+        // since inserting a point can remove a piece that was already present
+        bool split{ true };
+
+        while (split)
+        {
+            split = false;
+
+            for (size_t seg = 0; seg < segments.size(); ++seg)
+            {
+                int a{ segments[seg].n1 };
+                int b{ segments[seg].n2 };
+
+                if (failed[seg] || !check_encroached(a, b))
+                {
+                    continue;
+                }
+
+                int p{ split_segment(a, b, input_vertex) };
+
+                if (p == -1)
+                {
+                    failed[seg] = 1;
+                    continue;
+                }
+
+                segments[seg] = { a, p };
+                segments.push_back({ p, b });
+                failed.push_back(0);
+
+                split = true;
+            }
+        }
+
+        bool conformed{ true };
+
+        // Every other piece is now a Delaunay edge and keeps its constraint status
+        for (size_t seg = 0; seg < segments.size(); ++seg)
+        {
+            if (failed[seg])
+            {
+                std::cerr << "Error: Constraint piece " << segments[seg].n1 << "-" << segments[seg].n2 << " could not be recovered" << std::endl;
+                conformed = false;
+                continue;
+            }
+
+            constrained_edges_.insert(edge_key(segments[seg].n1, segments[seg].n2));
+        }
+
+        return conformed;
+    }
+
+    std::vector<char> DelaunayGenerator::input_vertices() const
+    {
+        // Without an ordering nothing tells the points apart so the ones present are taken as input
+        std::vector<char> input(points_.size(), point_ordering_.empty() ? 1 : 0);
+
+        for (int location : point_ordering_)
+        {
+            if (location >= 0 && location < input.size())
+            {
+                input[location] = 1;
+            }
+        }
+
+        return input;
+    }
+
+    int DelaunayGenerator::split_segment(int a, int b, const std::vector<char>& input_vertex)
+    {
+        Point3D pa{ points_[a] };
+        Point3D pb{ points_[b] };
+
+        float length{ std::sqrt(dot_product(subtract(pb, pa), subtract(pb, pa))) };
+
+        if (length < 1e-6f)
+        {
+            std::cerr << "Error: constraint piece is too short to split" << std::endl;
+            return -1;
+        }
+
+        // Split at the midpoint unless exactly one end is an input vertex, in which case
+        // split on a concentric shell (power of two distance) around it so that pieces of
+        // constraints meeting at a small angle do not keep encroaching on each other
+        float t{ 0.5f };
+        bool a_input{ a < input_vertex.size() && input_vertex[a] };
+        bool b_input{ b < input_vertex.size() && input_vertex[b] };
+
+        if (a_input != b_input)
+        {
+            float shell{ std::exp2(std::round(std::log2(0.5f * length))) };
+            t = a_input ? shell / length : 1.f - shell / length;
+        }
+
+        points_.push_back({ pa.x + t * (pb.x - pa.x), pa.y + t * (pb.y - pa.y), pa.z + t * (pb.z - pa.z) });
+        int p{ static_cast<int>(points_.size()) - 1 };
+
+        ++num_steiner_points_;
+
+        // Split the edge directly when it exists otherwise locate the point
+        int tri{ find_edge(a, b) };
+
+        if (tri == -1)
+        {
+            tri = find_edge(b, a);
+        }
+
+        if (tri == -1)
+        {
+            insert_point(p);
+            return p;
+        }
+
+        int edge{ 0 };
+        while (!(triangles_[tri][edge] == a && triangles_[tri][(edge + 1) % 3] == b) &&
+            !(triangles_[tri][edge] == b && triangles_[tri][(edge + 1) % 3] == a))
+        {
+            ++edge;
+        }
+
+        split_edge(p, tri, edge);
+
+        return p;
+    }
+
+    bool DelaunayGenerator::check_encroached(int a, int b)
+    {
+        int sides[2]{ find_edge(a, b), find_edge(b, a) };
+
+        // A missing edge is always encroached
+        if (sides[0] == -1 && sides[1] == -1)
+        {
+            return true;
+        }
+
+        // In a Delaunay triangulation a vertex inside the diametral circle of an edge implies
+        // the apex of one of the triangles sharing the edge is also inside it
+        for (auto tri : sides)
+        {
+            if (tri == -1)
+            {
+                continue;
+            }
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int c{ triangles_[tri][i] };
+
+                if (c == a || c == b)
+                {
+                    continue;
+                }
+
+                // The apex is inside the circle when the angle it makes with the edge is obtuse
+                if (dot_product(subtract(points_[a], points_[c]), subtract(points_[b], points_[c])) < 0.f)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void DelaunayGenerator::build_vertex_triangles()
+    {
+        // Make a list of triangle indices keyed by vertex index
+        // to give a starting search triangle for a given vertex
+        // There is one triangle per vertex not all triangles the
+        // vertex is a part of
+
+        vertex_triangle_.assign(points_.size(), -1);
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                int v = triangles_[t][i];
+
+                if (vertex_triangle_[v] == -1)
+                {
+                    vertex_triangle_[v] = t;
+                }
+            }
+        }
+    }
+
+    int DelaunayGenerator::refine(float min_angle, int max_steiner_points)
+    {
+        return refine(min_angle, nullptr, max_steiner_points);
+    }
+
+    int DelaunayGenerator::refine(float min_angle, const SizeField& size_field, int max_steiner_points)
+    {
+        return refine(min_angle, &size_field, max_steiner_points);
+    }
+
+    int DelaunayGenerator::refine(float min_angle, const SizeField* size_field, int max_steiner_points)
+    {
+        if (edge_index_.empty())
+        {
+            build_edge_index();
+        }
+
+        int steiner_before{ num_steiner_points_ };
+
+        // Renumbering and remeshing mix Steiner points in with the input points
+        std::vector<char> input_vertex{ input_vertices() };
+
+        // A triangle whose smallest angle is below min_angle has a circumradius to
+        // shortest edge ratio above 1 / (2 sin(min_angle))
+        double max_ratio{ 1.0 / (2.0 * std::sin(min_angle * 3.14159265358979 / 180.0)) };
+
+        // The isosceles triangle on an edge of length 1 with apex angle min_angle has its apex this far from the edge
+        // off-centers go slightly closer so rounding does not leave the new triangles just below the bound
+        double offcenter_distance{ 0.98 * 0.5 / std::tan(0.5 * min_angle * 3.14159265358979 / 180.0) };
+
+        // Bad triangles worst first, entries that no longer match the triangle are skipped
+        std::priority_queue<BadTriangle> bad_triangles{};
+
+        // Segments (constraints and the convex hull) that may be encroached
+        std::vector<Edge> segments{};
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            queue_bad_triangle(t, max_ratio, size_field, bad_triangles);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int a{ triangles_[t][i] };
+                int b{ triangles_[t][(i + 1) % 3] };
+
+                if ((a < b || neighbors_[t][i] == -1) && check_segment(a, b))
+                {
+                    segments.push_back({ a, b });
+                }
+            }
+        }
+
+        std::vector<int> fan{};
+
+        // Queue the triangles created or swapped by inserting p, which all contain p,
+        // and the segments opposite p that it may encroach upon
+        auto queue_star = [&](int p)
+            {
+                collect_fan(p, fan);
+
+                for (auto tri : fan)
+                {
+                    queue_bad_triangle(tri, max_ratio, size_field, bad_triangles);
+
+                    int i{ triangles_[tri][0] == p ? 0 : (triangles_[tri][1] == p ? 1 : 2) };
+                    int a{ triangles_[tri][(i + 1) % 3] };
+                    int b{ triangles_[tri][(i + 2) % 3] };
+
+                    if (check_segment(a, b))
+                    {
+                        segments.push_back({ a, b });
+                    }
+                }
+            };
+
+        int last_checkpoint{ num_steiner_points_ };
+
+        while (num_steiner_points_ - steiner_before < max_steiner_points)
+        {
+            // The queues are rebuilt from the triangles on resuming so only the triangulation is saved
+            if (checkpoint_ && checkpoint_interval_ > 0 && num_steiner_points_ - last_checkpoint >= checkpoint_interval_)
+            {
+                checkpoint_(*this);
+                last_checkpoint = num_steiner_points_;
+            }
+
+            // Encroached segments are always split before bad triangles
+            if (!segments.empty())
+            {
+                Edge segment{ segments.back() };
+                segments.pop_back();
+
+                if (!check_segment(segment.n1, segment.n2) || !check_encroached(segment.n1, segment.n2))
+                {
+                    continue;
+                }
+
+                int p{ split_segment(segment.n1, segment.n2, input_vertex) };
+
+                if (p != -1)
+                {
+                    queue_star(p);
+                }
+
+                continue;
+            }
+
+            if (bad_triangles.empty())
+            {
+                break;
+            }
+
+            BadTriangle bad{ bad_triangles.top() };
+            bad_triangles.pop();
+
+            if (bad.tri >= triangles_.size() || triangles_[bad.tri] != bad.vertices)
+            {
+                continue;
+            }
+
+            Point3D center{ steiner_point(bad.tri, offcenter_distance) };
+
+            // Walk from the bad triangle toward its circumcenter without crossing segments
+            Edge blocking{ -1, -1 };
+            int tri{ locate_visible(bad.tri, center, blocking) };
+
+            std::vector<Edge> encroached{};
+
+            if (tri == -1)
+            {
+                if (blocking.n1 == -1)
+                {
+                    continue;
+                }
+
+                // The circumcenter is hidden behind a segment so split the segment instead
+                encroached.push_back(blocking);
+            }
+            else
+            {
+                // A circumcenter inside the diametral circle of a segment on the boundary
+                // of its cavity would encroach upon that segment
+                collect_encroached(tri, center, encroached);
+            }
+
+            if (!encroached.empty())
+            {
+                bool split{ false };
+
+                for (auto segment : encroached)
+                {
+                    if (!check_segment(segment.n1, segment.n2))
+                    {
+                        continue;
+                    }
+
+                    int p{ split_segment(segment.n1, segment.n2, input_vertex) };
+
+                    if (p != -1)
+                    {
+                        queue_star(p);
+                        split = true;
+                    }
+                }
+
+                // Come back to the triangle once the segments are split if it survives
+                if (split)
+                {
+                    bad_triangles.push(bad);
+                }
+
+                continue;
+            }
+
+            points_.push_back(center);
+            int p{ static_cast<int>(points_.size()) - 1 };
+            ++num_steiner_points_;
+
+            insert_point(p, tri);
+            queue_star(p);
+        }
+
+        return num_steiner_points_ - steiner_before;
+    }
+
+    double DelaunayGenerator::radius_edge_ratio(int tri) const
+    {
+        Point3D a{ points_[triangles_[tri][0]] };
+        Point3D b{ points_[triangles_[tri][1]] };
+        Point3D c{ points_[triangles_[tri][2]] };
+
+        double ab{ dot_product(subtract(b, a), subtract(b, a)) };
+        double bc{ dot_product(subtract(c, b), subtract(c, b)) };
+        double ca{ dot_product(subtract(a, c), subtract(a, c)) };
+
+        double sqr_area{ 0.25 * orientation(a, b, c) * orientation(a, b, c) };
+
+        if (sqr_area == 0.0)
+        {
+            return std::numeric_limits<double>::max();
+        }
+
+        // R^2 = ab * bc * ca / (16 * area^2)
+        double sqr_radius{ ab * bc * ca / (16.0 * sqr_area) };
+
+        return std::sqrt(sqr_radius / std::min(ab, std::min(bc, ca)));
+    }
+
+    Point3D DelaunayGenerator::steiner_point(int tri, double offcenter_distance) const
+    {
+        Point3D a{ points_[triangles_[tri][0]] };
+        Point3D b{ points_[triangles_[tri][1]] };
+        Point3D c{ points_[triangles_[tri][2]] };
+
+        Point3D center{ circumcenter(a, b, c) };
+
+        if (steiner_placement_ == SteinerPlacement::Circumcenter)
+        {
+            return center;
+        }
+
+        // Shortest edge p-q
+        Point3D p{ a };
+        Point3D q{ b };
+
+        if (dot_product(subtract(c, b), subtract(c, b)) < dot_product(subtract(q, p), subtract(q, p)))
+        {
+            p = b;
+            q = c;
+        }
+
+        if (dot_product(subtract(a, c), subtract(a, c)) < dot_product(subtract(q, p), subtract(q, p)))
+        {
+            p = c;
+            q = a;
+        }
+
+        double mx{ 0.5 * (static_cast<double>(p.x) + q.x) };
+        double my{ 0.5 * (static_cast<double>(p.y) + q.y) };
+
+        double dx{ center.x - mx };
+        double dy{ center.y - my };
+
+        double center_distance{ std::sqrt(dx * dx + dy * dy) };
+        double distance{ offcenter_distance * std::sqrt(static_cast<double>(dot_product(subtract(q, p), subtract(q, p)))) };
+
+        // Use the circumcenter when it is already closer than the off-center
+        if (center_distance <= distance)
+        {
+            return center;
+        }
+
+        // Move along the bisector of p-q toward the circumcenter
+        double scale{ distance / center_distance };
+
+        return Point3D{ static_cast<float>(mx + scale * dx), static_cast<float>(my + scale * dy), center.z };
+    }
+
+    void DelaunayGenerator::queue_bad_triangle(int tri, double max_ratio, const SizeField* size_field, std::priority_queue<BadTriangle>& bad_triangles)
+    {
+        // Scale both criteria by their bound so the worst offender of either kind comes first
+        double badness{ radius_edge_ratio(tri) / max_ratio };
+
+        if (size_field != nullptr)
+        {
+            Point3D a{ points_[triangles_[tri][0]] };
+            Point3D b{ points_[triangles_[tri][1]] };
+            Point3D c{ points_[triangles_[tri][2]] };
+
+            float size{ (*size_field)((a.x + b.x + c.x) / 3.f, (a.y + b.y + c.y) / 3.f) };
+
+            if (size > 0.f)
+            {
+                Point3D center{ circumcenter(a, b, c) };
+                double radius{ std::sqrt(dot_product(subtract(a, center), subtract(a, center))) };
+
+                badness = std::max(badness, radius / size);
+            }
+        }
+
+        if (badness > 1.0)
+        {
+            bad_triangles.push({ badness, tri, triangles_[tri] });
+        }
+    }
+
+    bool DelaunayGenerator::check_segment(int a, int b) const
+    {
+        if (constrained_edges_.count(edge_key(a, b)) != 0)
+        {
+            return true;
+        }
+
+        // Edges on the convex hull bound the domain like constraints
+        int left{ find_edge(a, b) };
+        int right{ find_edge(b, a) };
+
+        return (left == -1) != (right == -1);
+    }
+
+    int DelaunayGenerator::locate_visible(int start, Point3D point, Edge& blocking) const
+    {
+        int current{ start };
+
+        // Visibility walk, a cap on the steps guards against cycling on degenerate input
+        for (size_t step = 0; step < triangles_.size(); ++step)
+        {
+            int next{ -1 };
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int a{ triangles_[current][i] };
+                int b{ triangles_[current][(i + 1) % 3] };
+
+                // The point is on the far side of edge a-b
+                if (orientation(points_[a], points_[b], point) < 0.0)
+                {
+                    if (neighbors_[current][i] == -1 || constrained_edges_.count(edge_key(a, b)) != 0)
+                    {
+                        blocking = { a, b };
+                        return -1;
+                    }
+
+                    next = neighbors_[current][i];
+                    break;
+                }
+            }
+
+            if (next == -1)
+            {
+                return current;
+            }
+
+            current = next;
+        }
+
+        return -1;
+    }
+
+    void DelaunayGenerator::collect_encroached(int tri, Point3D point, std::vector<Edge>& encroached) const
+    {
+        // Flood the triangles whose circumcircle contains the point stopping at segments
+        std::vector<int> cavity{ tri };
+        std::unordered_set<int> visited{ tri };
+
+        for (size_t n = 0; n < cavity.size(); ++n)
+        {
+            int current{ cavity[n] };
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int a{ triangles_[current][i] };
+                int b{ triangles_[current][(i + 1) % 3] };
+                int neighbor{ neighbors_[current][i] };
+
+                if (neighbor == -1 || constrained_edges_.count(edge_key(a, b)) != 0)
+                {
+                    // The point is inside the diametral circle when the angle it makes with the segment is obtuse
+                    if (dot_product(subtract(points_[a], point), subtract(points_[b], point)) < 0.f)
+                    {
+                        encroached.push_back({ a, b });
+                    }
+
+                    continue;
+                }
+
+                if (visited.count(neighbor) != 0)
+                {
+                    continue;
+                }
+
+                const std::array<int, 3>& pts{ triangles_[neighbor] };
+
+                if (incircle(points_[pts[0]], points_[pts[1]], points_[pts[2]], point) > 0.0)
+                {
+                    visited.insert(neighbor);
+                    cavity.push_back(neighbor);
+                }
+            }
+        }
+    }
+
+    void DelaunayGenerator::lloyd_relaxation(int iterations)
+    {
+        if (edge_index_.empty())
+        {
+            build_edge_index();
+        }
+
+        int num_points{ static_cast<int>(points_.size()) };
+        std::vector<Point3D> targets(num_points);
+        // One byte per vertex since the parallel pass writes neighboring entries from different threads
+        std::vector<char> movable(num_points, 0);
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            // The centroid of each Voronoi cell only reads the triangulation so every vertex is done in parallel
+            parallel_for(0, num_points, [&](int begin, int end)
+                {
+                    std::vector<int> fan{};
+
+                    for (int v = begin; v < end; ++v)
+                    {
+                        movable[v] = check_interior(v, fan);
+
+                        if (!movable[v])
+                        {
+                            continue;
+                        }
+
+                        // The circumcenters of the triangles around v in order are the corners of its cell
+                        double area{ 0.0 };
+                        double cx{ 0.0 };
+                        double cy{ 0.0 };
+
+                        Point3D origin{ points_[v] };
+                        Point3D previous{};
+
+                        for (size_t n = 0; n <= fan.size(); ++n)
+                        {
+                            const std::array<int, 3>& pts{ triangles_[fan[n % fan.size()]] };
+                            Point3D corner{ subtract(circumcenter(points_[pts[0]], points_[pts[1]], points_[pts[2]]), origin) };
+
+                            if (n > 0)
+                            {
+                                double cross{ static_cast<double>(previous.x) * corner.y - static_cast<double>(corner.x) * previous.y };
+                                area += cross;
+                                cx += (previous.x + corner.x) * cross;
+                                cy += (previous.y + corner.y) * cross;
+                            }
+
+                            previous = corner;
+                        }
+
+                        if (std::abs(area) < 1e-20)
+                        {
+                            movable[v] = 0;
+                            continue;
+                        }
+
+                        targets[v] = { static_cast<float>(origin.x + cx / (3.0 * area)), static_cast<float>(origin.y + cy / (3.0 * area)), origin.z };
+                    }
+                });
+
+            // Neighboring vertices move too so each move is only kept if the star of the
+            // vertex stays counter-clockwise with the positions at the time it is applied
+            std::vector<int> fan{};
+
+            for (int v = 0; v < num_points; ++v)
+            {
+                if (!movable[v])
+                {
+                    continue;
+                }
+
+                collect_fan(v, fan);
+
+                bool valid{ true };
+                for (auto tri : fan)
+                {
+                    int i{ triangles_[tri][0] == v ? 0 : (triangles_[tri][1] == v ? 1 : 2) };
+
+                    if (orientation(targets[v], points_[triangles_[tri][(i + 1) % 3]], points_[triangles_[tri][(i + 2) % 3]]) <= 0.0)
+                    {
+                        valid = false;
+                        break;
+                    }
+                }
+
+                if (valid)
+                {
+                    points_[v] = targets[v];
+                }
+            }
+
+            restore_delaunay_edges();
+        }
+    }
+
+    bool DelaunayGenerator::check_interior(int v, std::vector<int>& fan) const
+    {
+        if (v >= vertex_triangle_.size() || vertex_triangle_[v] == -1)
+        {
+            return false;
+        }
+
+        collect_fan(v, fan);
+
+        for (auto tri : fan)
+        {
+            int i{ triangles_[tri][0] == v ? 0 : (triangles_[tri][1] == v ? 1 : 2) };
+
+            // An open fan means v is on the boundary
+            if (neighbors_[tri][i] == -1 || neighbors_[tri][(i + 2) % 3] == -1)
+            {
+                return false;
+            }
+
+            if (!constrained_edges_.empty() && constrained_edges_.count(edge_key(v, triangles_[tri][(i + 1) % 3])) != 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int DelaunayGenerator::restore_delaunay_edges()
+    {
+        // Start with every interior edge and queue the outer edges of each swapped quad
+        std::vector<Edge> edges{};
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (neighbors_[t][i] != -1 && triangles_[t][i] < triangles_[t][(i + 1) % 3])
+                {
+                    edges.push_back({ triangles_[t][i], triangles_[t][(i + 1) % 3] });
+                }
+            }
+        }
+
+        int swaps{ 0 };
+
+        while (!edges.empty())
+        {
+            Edge edge{ edges.back() };
+            edges.pop_back();
+
+            if (constrained_edges_.count(edge_key(edge.n1, edge.n2)) != 0)
+            {
+                continue;
+            }
+
+            int tri_l{ find_edge(edge.n1, edge.n2) };
+            int tri_r{ find_edge(edge.n2, edge.n1) };
+
+            if (tri_l == -1 || tri_r == -1)
+            {
+                continue;
+            }
+
+            rotate_to_neighbor(tri_l, tri_r);
+
+            if (!check_delaunay(tri_l, tri_r))
+            {
+                continue;
+            }
+
+            swap_triangles(tri_l, tri_r);
+            ++swaps;
+
+            // The quad is now (p, v2, v3) and (p, v3, v1)
+            int p{ triangles_[tri_l][0] };
+            int v2{ triangles_[tri_l][1] };
+            int v3{ triangles_[tri_l][2] };
+            int v1{ triangles_[tri_r][2] };
+
+            edges.push_back({ p, v2 });
+            edges.push_back({ v2, v3 });
+            edges.push_back({ v3, v1 });
+            edges.push_back({ v1, p });
+        }
+
+        return swaps;
+    }
+
+    void DelaunayGenerator::smooth(SmoothingMethod method, int iterations)
+    {
+        // The topology does not change so one coloring serves every iteration
+        std::vector<int> colors{};
+        int num_colors{ color_vertices(colors) };
+
+        std::vector<std::vector<int>> color_groups(num_colors);
+        std::vector<int> fan{};
+
+        for (int v = 0; v < colors.size(); ++v)
+        {
+            if (colors[v] != -1 && check_interior(v, fan))
+            {
+                color_groups[colors[v]].push_back(v);
+            }
+        }
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (const auto& vertices : color_groups)
+            {
+                parallel_for(0, static_cast<int>(vertices.size()), [&](int begin, int end)
+                    {
+                        std::vector<int> fan{};
+
+                        for (int n = begin; n < end; ++n)
+                        {
+                            int v{ vertices[n] };
+
+                            collect_fan(v, fan);
+
+                            Point3D position{ smoothed_position(v, fan, method) };
+
+                            // Keep every triangle around v counter-clockwise
+                            if (star_quality(v, position, fan) > 0.0)
+                            {
+                                points_[v] = position;
+                            }
+                        }
+                    }, 1 << 10);
+            }
+        }
+    }
+
+    int DelaunayGenerator::color_vertices(std::vector<int>& colors) const
+    {
+        colors.assign(points_.size(), -1);
+
+        int num_colors{ 0 };
+        std::vector<int> fan{};
+        std::vector<bool> used{};
+
+        for (int v = 0; v < points_.size(); ++v)
+        {
+            if (v >= vertex_triangle_.size() || vertex_triangle_[v] == -1)
+            {
+                continue;
+            }
+
+            collect_fan(v, fan);
+
+            used.assign(num_colors + 1, false);
+
+            for (auto tri : fan)
+            {
+                for (auto u : triangles_[tri])
+                {
+                    if (u != v && colors[u] != -1)
+                    {
+                        used[colors[u]] = true;
+                    }
+                }
+            }
+
+            int color{ 0 };
+            while (used[color])
+            {
+                ++color;
+            }
+
+            colors[v] = color;
+            num_colors = std::max(num_colors, color + 1);
+        }
+
+        return num_colors;
+    }
+
+    Point3D DelaunayGenerator::smoothed_position(int v, const std::vector<int>& fan, SmoothingMethod method) const
+    {
+        Point3D origin{ points_[v] };
+
+        // Each triangle is (v, a, b) counter-clockwise so b follows a around v
+        auto ring = [&](int tri, int offset)
+            {
+                int i{ triangles_[tri][0] == v ? 0 : (triangles_[tri][1] == v ? 1 : 2) };
+                return triangles_[tri][(i + offset) % 3];
+            };
+
+        if (method == SmoothingMethod::Laplacian)
+        {
+            double x{ 0.0 };
+            double y{ 0.0 };
+
+            for (auto tri : fan)
+            {
+                x += points_[ring(tri, 1)].x;
+                y += points_[ring(tri, 1)].y;
+            }
+
+            return { static_cast<float>(x / fan.size()), static_cast<float>(y / fan.size()), origin.z };
+        }
+
+        if (method == SmoothingMethod::Angle)
+        {
+            double x{ 0.0 };
+            double y{ 0.0 };
+
+            for (auto tri : fan)
+            {
+                // Surrounding vertex p with next following it and previous before it around v
+                int p{ ring(tri, 1) };
+                int next{ ring(tri, 2) };
+                int previous{ -1 };
+
+                for (auto other : fan)
+                {
+                    if (ring(other, 2) == p)
+                    {
+                        previous = ring(other, 1);
+                        break;
+                    }
+                }
+
+                double px{ points_[p].x };
+                double py{ points_[p].y };
+
+                // The angle at p containing v runs counter-clockwise from next to previous
+                double start{ std::atan2(points_[next].y - py, points_[next].x - px) };
+                double sweep{ std::atan2(points_[previous].y - py, points_[previous].x - px) - start };
+
+                if (sweep <= 0.0)
+                {
+                    sweep += 2.0 * 3.14159265358979;
+                }
+
+                double bisector{ start + 0.5 * sweep };
+                double length{ std::hypot(origin.x - px, origin.y - py) };
+
+                x += px + length * std::cos(bisector);
+                y += py + length * std::sin(bisector);
+            }
+
+            return { static_cast<float>(x / fan.size()), static_cast<float>(y / fan.size()), origin.z };
+        }
+
+        // Compass search from the current position, shrinking the step whenever no direction improves
+        double step{ 0.0 };
+        for (auto tri : fan)
+        {
+            Point3D edge{ subtract(points_[ring(tri, 1)], origin) };
+            step += std::sqrt(dot_product(edge, edge));
+        }
+        step *= 0.25 / fan.size();
+
+        Point3D best{ origin };
+        double best_quality{ star_quality(v, origin, fan) };
+
+        const double directions[8][2]{ { 1, 0 }, { 0.7071, 0.7071 }, { 0, 1 }, { -0.7071, 0.7071 },
+            { -1, 0 }, { -0.7071, -0.7071 }, { 0, -1 }, { 0.7071, -0.7071 } };
+
+        for (int search = 0; search < 16; ++search)
+        {
+            Point3D center{ best };
+
+            for (const auto& direction : directions)
+            {
+                Point3D candidate{ static_cast<float>(center.x + step * direction[0]), static_cast<float>(center.y + step * direction[1]), origin.z };
+                double quality{ star_quality(v, candidate, fan) };
+
+                if (quality > best_quality)
+                {
+                    best = candidate;
+                    best_quality = quality;
+                }
+            }
+
+            if (best.x == center.x && best.y == center.y)
+            {
+                step *= 0.5;
+            }
+        }
+
+        return best;
+    }
+
+    double DelaunayGenerator::star_quality(int v, Point3D position, const std::vector<int>& fan) const
+    {
+        double worst{ 1.0 };
+
+        for (auto tri : fan)
+        {
+            int i{ triangles_[tri][0] == v ? 0 : (triangles_[tri][1] == v ? 1 : 2) };
+
+            worst = std::min(worst, triangle_quality(position, points_[triangles_[tri][(i + 1) % 3]], points_[triangles_[tri][(i + 2) % 3]]));
+        }
+
+        return worst;
+    }
+
+    void DelaunayGenerator::remesh(std::vector<MetricTensor>& metric, int iterations)
+    {
+        if (metric.size() < points_.size())
+        {
+            std::cerr << "Error: remesh needs a metric tensor for every point" << std::endl;
+            return;
+        }
+
+        // Operations in a batch run concurrently so the edge index is rebuilt afterward instead
+        bool indexed{ !edge_index_.empty() };
+        edge_index_.clear();
+
+        if (vertex_triangle_.size() != points_.size())
+        {
+            build_vertex_triangles();
+        }
+
+        // Each loop stops once a pass finds nothing to do, capped in case operations keep undoing each other
+        constexpr int max_passes{ 32 };
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (int pass = 0; pass < max_passes && remesh_splits(metric) > 0; ++pass)
+            {
+            }
+
+            for (int pass = 0; pass < max_passes && remesh_collapses(metric) > 0; ++pass)
+            {
+            }
+
+            for (int pass = 0; pass < max_passes && remesh_swaps(metric) > 0; ++pass)
+            {
+            }
+        }
+
+        if (indexed)
+        {
+            build_edge_index();
+        }
+    }
+
+    template <typename Func>
+    std::vector<DelaunayGenerator::RemeshOperation> DelaunayGenerator::collect_operations(Func&& func) const
+    {
+        int num_triangles{ static_cast<int>(triangles_.size()) };
+        int num_parts{ std::max(1, std::min(4 * thread_count(), num_triangles / 1024)) };
+        int part_size{ (num_triangles + num_parts - 1) / num_parts };
+
+        std::vector<std::vector<RemeshOperation>> parts(num_parts);
+
+        parallel_for(0, num_parts, [&](int begin, int end)
+            {
+                for (int part = begin; part < end; ++part)
+                {
+                    int last{ std::min(num_triangles, (part + 1) * part_size) };
+
+                    for (int t = part * part_size; t < last; ++t)
+                    {
+                        for (int i = 0; i < 3; ++i)
+                        {
+                            // Visit interior edges from the side where they go up and hull edges from their only side
+                            if (triangles_[t][i] > triangles_[t][(i + 1) % 3] && neighbors_[t][i] != -1)
+                            {
+                                continue;
+                            }
+
+                            RemeshOperation operation{ 0.f, t, i };
+
+                            if (func(t, i, operation))
+                            {
+                                parts[part].push_back(operation);
+                            }
+                        }
+                    }
+                }
+            }, 1);
+
+        std::vector<RemeshOperation> operations{};
+
+        for (const auto& part : parts)
+        {
+            operations.insert(operations.end(), part.begin(), part.end());
+        }
+
+        std::sort(operations.begin(), operations.end(), [](const RemeshOperation& l, const RemeshOperation& r) { return l.priority > r.priority; });
+
+        return operations;
+    }
+
+    template <typename Func>
+    std::vector<DelaunayGenerator::RemeshOperation> DelaunayGenerator::select_independent(const std::vector<RemeshOperation>& operations, Func&& vertices) const
+    {
+        std::vector<char> claimed(points_.size(), 0);
+        std::vector<RemeshOperation> selected{};
+        std::vector<int> list{};
+
+        for (const auto& operation : operations)
+        {
+            vertices(operation, list);
+
+            bool free{ true };
+            for (auto v : list)
+            {
+                free = free && claimed[v] == 0;
+            }
+
+            if (!free)
+            {
+                continue;
+            }
+
+            for (auto v : list)
+            {
+                claimed[v] = 1;
+            }
+
+            selected.push_back(operation);
+        }
+
+        return selected;
+    }
+
+    int DelaunayGenerator::remesh_splits(std::vector<MetricTensor>& metric)
+    {
+        // Splitting at 4/3 leaves halves of at least 2/3 which collapses will not undo
+        // since merging them back would recreate the long edge
+        std::vector<RemeshOperation> operations{ collect_operations([&](int t, int i, RemeshOperation& operation)
+            {
+                operation.priority = static_cast<float>(metric_length(triangles_[t][i], triangles_[t][(i + 1) % 3], metric));
+                return operation.priority > 4.f / 3.f;
+            }) };
+
+        // The quad around the edge holds every vertex and triangle a split touches
+        std::vector<RemeshOperation> selected{ select_independent(operations, [&](const RemeshOperation& operation, std::vector<int>& list)
+            {
+                list.assign(triangles_[operation.tri].begin(), triangles_[operation.tri].end());
+
+                int opp{ neighbors_[operation.tri][operation.edge] };
+
+                if (opp != -1)
+                {
+                    list.insert(list.end(), triangles_[opp].begin(), triangles_[opp].end());
+                }
+            }) };
+
+        int num_selected{ static_cast<int>(selected.size()) };
+
+        // Reserve the new point and triangles of each split so the splits can run concurrently
+        std::vector<int> first_triangle(num_selected + 1, static_cast<int>(triangles_.size()));
+        std::vector<Edge> split_edges(num_selected);
+
+        for (int n = 0; n < num_selected; ++n)
+        {
+            const RemeshOperation& operation{ selected[n] };
+
+            split_edges[n] = { triangles_[operation.tri][operation.edge], triangles_[operation.tri][(operation.edge + 1) % 3] };
+            first_triangle[n + 1] = first_triangle[n] + (neighbors_[operation.tri][operation.edge] != -1 ? 2 : 1);
+        }
+
+        int first_point{ static_cast<int>(points_.size()) };
+
+        points_.resize(points_.size() + num_selected);
+        metric.resize(points_.size());
+        vertex_triangle_.resize(points_.size(), -1);
+        triangles_.resize(first_triangle[num_selected]);
+        neighbors_.resize(triangles_.size());
+
+        parallel_for(0, num_selected, [&](int begin, int end)
+            {
+                for (int n = begin; n < end; ++n)
+                {
+                    int a{ split_edges[n].n1 };
+                    int b{ split_edges[n].n2 };
+                    int p{ first_point + n };
+
+                    points_[p] = { 0.5f * (points_[a].x + points_[b].x), 0.5f * (points_[a].y + points_[b].y), 0.5f * (points_[a].z + points_[b].z) };
+                    metric[p] = { 0.5f * (metric[a].m11 + metric[b].m11), 0.5f * (metric[a].m12 + metric[b].m12), 0.5f * (metric[a].m22 + metric[b].m22) };
+
+                    int tri_1{ first_triangle[n] };
+                    int opp_1{ first_triangle[n + 1] - first_triangle[n] == 2 ? tri_1 + 1 : -1 };
+
+                    split_edge_slots(p, selected[n].tri, selected[n].edge, tri_1, opp_1);
+                }
+            }, 1 << 10);
+
+        // Split constraints keep both halves
+        for (int n = 0; n < num_selected; ++n)
+        {
+            int a{ split_edges[n].n1 };
+            int b{ split_edges[n].n2 };
+
+            if (constrained_edges_.erase(edge_key(a, b)) != 0)
+            {
+                constrained_edges_.insert(edge_key(a, first_point + n));
+                constrained_edges_.insert(edge_key(first_point + n, b));
+            }
+        }
+
+        num_steiner_points_ += num_selected;
+
+        return num_selected;
+    }
+
+    int DelaunayGenerator::remesh_collapses(const std::vector<MetricTensor>& metric)
+    {
+        std::vector<RemeshOperation> operations{ collect_operations([&](int t, int i, RemeshOperation& operation)
+            {
+                int a{ triangles_[t][i] };
+                int b{ triangles_[t][(i + 1) % 3] };
+
+                if (neighbors_[t][i] == -1)
+                {
+                    return false;
+                }
+
+                double length{ metric_length(a, b, metric) };
+
+                if (length >= 0.8)
+                {
+                    return false;
+                }
+
+                // Shorter edges first, merging whichever end is free to move
+                operation.priority = static_cast<float>(-length);
+
+                std::vector<int> fan{};
+
+                if (check_collapse(a, b, 4.0 / 3.0, metric, fan))
+                {
+                    operation.u = a;
+                    operation.v = b;
+                    return true;
+                }
+
+                if (check_collapse(b, a, 4.0 / 3.0, metric, fan))
+                {
+                    operation.u = b;
+                    operation.v = a;
+                    return true;
+                }
+
+                return false;
+            }) };
+
+        // The triangles around both ends hold every vertex and triangle a collapse touches
+        std::vector<int> fan{};
+
+        std::vector<RemeshOperation> selected{ select_independent(operations, [&](const RemeshOperation& operation, std::vector<int>& list)
+            {
+                list.clear();
+
+                for (int end : { operation.u, operation.v })
+                {
+                    collect_fan(end, fan);
+
+                    for (auto tri : fan)
+                    {
+                        list.insert(list.end(), triangles_[tri].begin(), triangles_[tri].end());
+                    }
+                }
+            }) };
+
+        int num_selected{ static_cast<int>(selected.size()) };
+
+        parallel_for(0, num_selected, [&](int begin, int end)
+            {
+                std::vector<int> fan{};
+
+                for (int n = begin; n < end; ++n)
+                {
+                    collect_fan(selected[n].u, fan);
+                    collapse_edge(selected[n].u, selected[n].v, fan);
+                }
+            }, 1 << 10);
+
+        if (num_selected > 0)
+        {
+            compact_triangles();
+        }
+
+        return num_selected;
+    }
+
+    int DelaunayGenerator::remesh_swaps(const std::vector<MetricTensor>& metric)
+    {
+        std::vector<RemeshOperation> operations{ collect_operations([&](int t, int i, RemeshOperation& operation)
+            {
+                int n{ neighbors_[t][i] };
+
+                int a{ triangles_[t][i] };
+                int b{ triangles_[t][(i + 1) % 3] };
+                int c{ triangles_[t][(i + 2) % 3] };
+
+                if (n == -1 || constrained_edges_.count(edge_key(a, b)) != 0)
+                {
+                    return false;
+                }
+
+                int d{ triangles_[n][0] + triangles_[n][1] + triangles_[n][2] - a - b };
+
+                // The quad must be convex for the swapped triangles (a, d, c) and (b, c, d) to be valid
+                if (orientation(points_[a], points_[d], points_[c]) <= 0.0 || orientation(points_[b], points_[c], points_[d]) <= 0.0)
+                {
+                    return false;
+                }
+
+                double before{ std::min(metric_quality(a, b, c, metric), metric_quality(b, a, d, metric)) };
+                double after{ std::min(metric_quality(a, d, c, metric), metric_quality(b, c, d, metric)) };
+
+                // Require a clear gain so swaps cannot cycle
+                operation.priority = static_cast<float>(after - before);
+                return after > before + 1e-3;
+            }) };
+
+        std::vector<RemeshOperation> selected{ select_independent(operations, [&](const RemeshOperation& operation, std::vector<int>& list)
+            {
+                int opp{ neighbors_[operation.tri][operation.edge] };
+
+                list.assign(triangles_[operation.tri].begin(), triangles_[operation.tri].end());
+                list.insert(list.end(), triangles_[opp].begin(), triangles_[opp].end());
+            }) };
+
+        int num_selected{ static_cast<int>(selected.size()) };
+
+        parallel_for(0, num_selected, [&](int begin, int end)
+            {
+                for (int n = begin; n < end; ++n)
+                {
+                    int tri_l{ selected[n].tri };
+                    int tri_r{ neighbors_[tri_l][selected[n].edge] };
+
+                    rotate_to_neighbor(tri_l, tri_r);
+                    swap_triangles(tri_l, tri_r);
+                }
+            }, 1 << 10);
+
+        return num_selected;
+    }
+
+    double DelaunayGenerator::metric_length(int a, int b, const std::vector<MetricTensor>& metric) const
+    {
+        double m11{ 0.5 * (metric[a].m11 + metric[b].m11) };
+        double m12{ 0.5 * (metric[a].m12 + metric[b].m12) };
+        double m22{ 0.5 * (metric[a].m22 + metric[b].m22) };
+
+        double ex{ static_cast<double>(points_[b].x) - points_[a].x };
+        double ey{ static_cast<double>(points_[b].y) - points_[a].y };
+
+        return std::sqrt(std::max(0.0, m11 * ex * ex + 2.0 * m12 * ex * ey + m22 * ey * ey));
+    }
+
+    double DelaunayGenerator::metric_quality(int a, int b, int c, const std::vector<MetricTensor>& metric) const
+    {
+        double m11{ (metric[a].m11 + metric[b].m11 + metric[c].m11) / 3.0 };
+        double m12{ (metric[a].m12 + metric[b].m12 + metric[c].m12) / 3.0 };
+        double m22{ (metric[a].m22 + metric[b].m22 + metric[c].m22) / 3.0 };
+
+        auto sqr_length = [&](int p, int q)
+            {
+                double ex{ static_cast<double>(points_[q].x) - points_[p].x };
+                double ey{ static_cast<double>(points_[q].y) - points_[p].y };
+
+                return m11 * ex * ex + 2.0 * m12 * ex * ey + m22 * ey * ey;
+            };
+
+        double sum{ sqr_length(a, b) + sqr_length(b, c) + sqr_length(c, a) };
+        double area{ 0.5 * orientation(points_[a], points_[b], points_[c]) * std::sqrt(std::max(0.0, m11 * m22 - m12 * m12)) };
+
+        return sum == 0.0 ? 0.0 : 4.0 * 1.7320508075688772 * area / sum;
+    }
+
+    bool DelaunayGenerator::check_collapse(int u, int v, double max_length, const std::vector<MetricTensor>& metric, std::vector<int>& fan) const
+    {
+        // u must be free to move (surrounded by triangles and not on a constraint)
+        if (!check_interior(u, fan))
+        {
+            return false;
+        }
+
+        int shared{ 0 };
+        std::vector<int> ring{};
+
+        for (auto tri : fan)
+        {
+            int i{ triangles_[tri][0] == u ? 0 : (triangles_[tri][1] == u ? 1 : 2) };
+            int next{ triangles_[tri][(i + 1) % 3] };
+            int previous{ triangles_[tri][(i + 2) % 3] };
+
+            ring.push_back(next);
+
+            if (next == v || previous == v)
+            {
+                ++shared;
+                continue;
+            }
+
+            // The triangles that remain must stay counter-clockwise with u moved onto v
+            if (orientation(points_[v], points_[next], points_[previous]) <= 0.0)
+            {
+                return false;
+            }
+
+            if (metric_length(v, next, metric) >= max_length)
+            {
+                return false;
+            }
+        }
+
+        if (shared != 2)
+        {
+            return false;
+        }
+
+        // Link condition: only the two vertices opposite edge u-v may be next to both ends
+        std::vector<int> fan_v{};
+        collect_fan(v, fan_v);
+
+        std::vector<int> ring_v{};
+        for (auto tri : fan_v)
+        {
+            ring_v.insert(ring_v.end(), triangles_[tri].begin(), triangles_[tri].end());
+        }
+
+        return std::count_if(ring.begin(), ring.end(), [&](int w)
+            {
+                return w != v && std::find(ring_v.begin(), ring_v.end(), w) != ring_v.end();
+            }) == 2;
+    }
+
+    void DelaunayGenerator::collapse_edge(int u, int v, const std::vector<int>& fan)
+    {
+        // (u, v, c) and (u, d, v) are the triangles on edge u-v
+        int tri_1{ -1 };
+        int tri_2{ -1 };
+
+        for (auto tri : fan)
+        {
+            int i{ triangles_[tri][0] == u ? 0 : (triangles_[tri][1] == u ? 1 : 2) };
+
+            if (triangles_[tri][(i + 1) % 3] == v)
+            {
+                rotate_vertices(tri, i);
+                tri_1 = tri;
+            }
+            else if (triangles_[tri][(i + 2) % 3] == v)
+            {
+                rotate_vertices(tri, i);
+                tri_2 = tri;
+            }
+        }
+
+        int c{ triangles_[tri_1][2] };
+        int d{ triangles_[tri_2][1] };
+
+        // The neighbors on either side of each removed triangle become neighbors of each other
+        int n_a{ neighbors_[tri_1][1] };
+        int n_b{ neighbors_[tri_1][2] };
+        int n_c{ neighbors_[tri_2][0] };
+        int n_d{ neighbors_[tri_2][1] };
+
+        if (n_a != -1)
+        {
+            update_adjacent(n_a, tri_1, n_b);
+        }
+        update_adjacent(n_b, tri_1, n_a);
+
+        update_adjacent(n_c, tri_2, n_d);
+        if (n_d != -1)
+        {
+            update_adjacent(n_d, tri_2, n_c);
+        }
+
+        for (auto tri : fan)
+        {
+            if (tri != tri_1 && tri != tri_2)
+            {
+                std::replace(triangles_[tri].begin(), triangles_[tri].end(), u, v);
+            }
+        }
+
+        triangles_[tri_1] = { -1, -1, -1 };
+        triangles_[tri_2] = { -1, -1, -1 };
+        neighbors_[tri_1] = { -1, -1, -1 };
+        neighbors_[tri_2] = { -1, -1, -1 };
+
+        // n_b and n_c are around u so they exist and now contain v
+        vertex_triangle_[u] = -1;
+        vertex_triangle_[v] = n_b;
+        vertex_triangle_[c] = n_b;
+        vertex_triangle_[d] = n_c;
+    }
+
+    void DelaunayGenerator::compact_triangles()
+    {
+        int num_triangles{ static_cast<int>(triangles_.size()) };
+
+        std::vector<int> remap(num_triangles, -1);
+        int count{ 0 };
+
+        for (int t = 0; t < num_triangles; ++t)
+        {
+            if (triangles_[t][0] != -1)
+            {
+                remap[t] = count++;
+            }
+        }
+
+        std::vector<std::array<int, 3>> triangles(count);
+        std::vector<std::array<int, 3>> neighbors(count);
+
+        parallel_for(0, num_triangles, [&](int begin, int end)
+            {
+                for (int t = begin; t < end; ++t)
+                {
+                    if (remap[t] == -1)
+                    {
+                        continue;
+                    }
+
+                    triangles[remap[t]] = triangles_[t];
+
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        neighbors[remap[t]][i] = neighbors_[t][i] == -1 ? -1 : remap[neighbors_[t][i]];
+                    }
+                }
+            });
+
+        parallel_for(0, static_cast<int>(vertex_triangle_.size()), [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    if (vertex_triangle_[v] != -1)
+                    {
+                        vertex_triangle_[v] = remap[vertex_triangle_[v]];
+                    }
+                }
+            });
+
+        triangles_ = std::move(triangles);
+        neighbors_ = std::move(neighbors);
+    }
+
+    void DelaunayGenerator::renumber(RenumberingMethod method)
+    {
+        if (vertex_triangle_.size() != points_.size())
+        {
+            build_vertex_triangles();
+        }
+
+        std::vector<int> order{ method == RenumberingMethod::Hilbert ? hilbert_order() : cuthill_mckee_order() };
+
+        int num_points{ static_cast<int>(points_.size()) };
+        int num_triangles{ static_cast<int>(triangles_.size()) };
+
+        std::vector<int> new_point(num_points, -1);
+
+        for (int i = 0; i < order.size(); ++i)
+        {
+            new_point[order[i]] = i;
+        }
+
+        int next{ static_cast<int>(order.size()) };
+
+        for (int v = 0; v < num_points; ++v)
+        {
+            if (new_point[v] == -1)
+            {
+                new_point[v] = next++;
+            }
+        }
+
+        // Rename the vertices of each triangle and key it by its smallest vertex
+        std::vector<std::uint64_t> keys(num_triangles);
+
+        parallel_for(0, num_triangles, [&](int begin, int end)
+            {
+                for (int t = begin; t < end; ++t)
+                {
+                    for (auto& v : triangles_[t])
+                    {
+                        v = new_point[v];
+                    }
+
+                    int smallest{ std::min({ triangles_[t][0], triangles_[t][1], triangles_[t][2] }) };
+                    keys[t] = (static_cast<std::uint64_t>(smallest) << 32) | static_cast<std::uint32_t>(t);
+                }
+            });
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<int> new_triangle(num_triangles);
+
+        for (int t = 0; t < num_triangles; ++t)
+        {
+            new_triangle[static_cast<std::uint32_t>(keys[t])] = t;
+        }
+
+        std::vector<Point3D> points(num_points);
+        std::vector<int> vertex_triangle(num_points);
+        std::vector<std::array<int, 3>> triangles(num_triangles);
+        std::vector<std::array<int, 3>> neighbors(num_triangles);
+
+        parallel_for(0, num_points, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    points[new_point[v]] = points_[v];
+                    vertex_triangle[new_point[v]] = vertex_triangle_[v] == -1 ? -1 : new_triangle[vertex_triangle_[v]];
+                }
+            });
+
+        parallel_for(0, num_triangles, [&](int begin, int end)
+            {
+                for (int t = begin; t < end; ++t)
+                {
+                    int old{ static_cast<int>(static_cast<std::uint32_t>(keys[t])) };
+
+                    triangles[t] = triangles_[old];
+
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        neighbors[t][i] = neighbors_[old][i] == -1 ? -1 : new_triangle[neighbors_[old][i]];
+                    }
+                }
+            });
+
+        points_ = std::move(points);
+        vertex_triangle_ = std::move(vertex_triangle);
+        triangles_ = std::move(triangles);
+        neighbors_ = std::move(neighbors);
+
+        for (auto& edge : edges_)
+        {
+            edge = { new_point[edge.n1], new_point[edge.n2] };
+        }
+
+        std::unordered_set<std::uint64_t> constrained_edges{};
+        constrained_edges.reserve(constrained_edges_.size());
+
+        for (auto key : constrained_edges_)
+        {
+            constrained_edges.insert(edge_key(new_point[key >> 32], new_point[key & 0xffffffff]));
+        }
+
+        constrained_edges_ = std::move(constrained_edges);
+
+        for (auto& location : point_ordering_)
+        {
+            location = new_point[location];
+        }
+
+        if (!edge_index_.empty())
+        {
+            build_edge_index();
+        }
+    }
+
+    std::vector<int> DelaunayGenerator::hilbert_order() const
+    {
+        int num_points{ static_cast<int>(points_.size()) };
+
+        float min_x{ std::numeric_limits<float>::max() };
+        float min_y{ std::numeric_limits<float>::max() };
+        float max_x{ std::numeric_limits<float>::lowest() };
+        float max_y{ std::numeric_limits<float>::lowest() };
+
+        for (int v = 0; v < num_points; ++v)
+        {
+            if (vertex_triangle_[v] != -1)
+            {
+                min_x = std::min(min_x, points_[v].x);
+                min_y = std::min(min_y, points_[v].y);
+                max_x = std::max(max_x, points_[v].x);
+                max_y = std::max(max_y, points_[v].y);
+            }
+        }
+
+        // Points are snapped to a 2^16 grid over the square containing the box
+        constexpr std::uint32_t grid_size{ 1 << 16 };
+
+        float extent{ std::max(max_x - min_x, max_y - min_y) };
+        float scale{ extent > 0.f ? (grid_size - 1) / extent : 0.f };
+
+        std::vector<std::uint64_t> keys(num_points, std::numeric_limits<std::uint64_t>::max());
+
+        parallel_for(0, num_points, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    if (vertex_triangle_[v] == -1)
+                    {
+                        continue;
+                    }
+
+                    std::uint32_t x{ static_cast<std::uint32_t>((points_[v].x - min_x) * scale) };
+                    std::uint32_t y{ static_cast<std::uint32_t>((points_[v].y - min_y) * scale) };
+                    std::uint32_t d{ 0 };
+
+                    // Distance along the curve, rotating each quadrant so the curve stays continuous
+                    for (std::uint32_t s = grid_size / 2; s > 0; s /= 2)
+                    {
+                        std::uint32_t rx{ (x & s) != 0 ? 1u : 0u };
+                        std::uint32_t ry{ (y & s) != 0 ? 1u : 0u };
+
+                        d += s * s * ((3 * rx) ^ ry);
+
+                        if (ry == 0)
+                        {
+                            if (rx == 1)
+                            {
+                                x = grid_size - 1 - x;
+                                y = grid_size - 1 - y;
+                            }
+
+                            std::swap(x, y);
+                        }
+                    }
+
+                    keys[v] = (static_cast<std::uint64_t>(d) << 32) | static_cast<std::uint32_t>(v);
+                }
+            });
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<int> order{};
+        order.reserve(num_points);
+
+        for (auto key : keys)
+        {
+            if (key == std::numeric_limits<std::uint64_t>::max())
+            {
+                break;
+            }
+
+            order.push_back(static_cast<int>(static_cast<std::uint32_t>(key)));
+        }
+
+        return order;
+    }
+
+    std::vector<int> DelaunayGenerator::cuthill_mckee_order() const
+    {
+        int num_points{ static_cast<int>(points_.size()) };
+
+        // Edge graph in compressed rows, each edge is found once from its owning triangle
+        std::vector<int> offsets(num_points + 1, 0);
+
+        auto for_each_edge = [&](auto&& func)
+            {
+                for (int t = 0; t < triangles_.size(); ++t)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        int a{ triangles_[t][i] };
+                        int b{ triangles_[t][(i + 1) % 3] };
+
+                        if (a < b || neighbors_[t][i] == -1)
+                        {
+                            func(a, b);
+                        }
+                    }
+                }
+            };
+
+        for_each_edge([&](int a, int b)
+            {
+                ++offsets[a + 1];
+                ++offsets[b + 1];
+            });
+
+        for (int v = 0; v < num_points; ++v)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+
+        std::vector<int> adjacent(offsets[num_points]);
+        std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+
+        for_each_edge([&](int a, int b)
+            {
+                adjacent[fill[a]++] = b;
+                adjacent[fill[b]++] = a;
+            });
+
+        auto degree = [&](int v) { return offsets[v + 1] - offsets[v]; };
+
+        // Visit lower degree vertices first within each level
+        parallel_for(0, num_points, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    std::sort(adjacent.begin() + offsets[v], adjacent.begin() + offsets[v + 1], [&](int l, int r)
+                        {
+                            return degree(l) < degree(r) || (degree(l) == degree(r) && l < r);
+                        });
+                }
+            });
+
+        // Breadth first search from start appending to order, returns the number of levels
+        // and sets last_level to the index in order where the last level begins
+        std::vector<int> stamp(num_points, -1);
+        int search{ 0 };
+
+        auto breadth_first = [&](int start, std::vector<int>& order, size_t& last_level)
+            {
+                int levels{ 0 };
+
+                order.push_back(start);
+                stamp[start] = search;
+
+                for (size_t level = 0; level < order.size(); ++levels)
+                {
+                    size_t level_end{ order.size() };
+                    last_level = level;
+
+                    for (; level < level_end; ++level)
+                    {
+                        int v{ order[level] };
+
+                        for (int k = offsets[v]; k < offsets[v + 1]; ++k)
+                        {
+                            if (stamp[adjacent[k]] != search)
+                            {
+                                stamp[adjacent[k]] = search;
+                                order.push_back(adjacent[k]);
+                            }
+                        }
+                    }
+                }
+
+                ++search;
+                return levels;
+            };
+
+        // Each component starts from its lowest degree vertex
+        std::vector<int> by_degree{};
+
+        for (int v = 0; v < num_points; ++v)
+        {
+            if (degree(v) > 0)
+            {
+                by_degree.push_back(v);
+            }
+        }
+
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](int l, int r) { return degree(l) < degree(r); });
+
+        std::vector<char> placed(num_points, 0);
+        std::vector<int> order{};
+        std::vector<int> component{};
+        std::vector<int> trial{};
+
+        order.reserve(num_points);
+
+        for (auto start : by_degree)
+        {
+            if (placed[start] != 0)
+            {
+                continue;
+            }
+
+            component.clear();
+            size_t last_level{ 0 };
+            int levels{ breadth_first(start, component, last_level) };
+
+            // Move to the lowest degree vertex of the last level while that adds levels
+            // so the search starts from a pseudo-peripheral vertex (George and Liu)
+            while (true)
+            {
+                int candidate{ component[last_level] };
+
+                for (size_t i = last_level; i < component.size(); ++i)
+                {
+                    candidate = degree(component[i]) < degree(candidate) ? component[i] : candidate;
+                }
+
+                trial.clear();
+                size_t trial_last{ 0 };
+                int trial_levels{ breadth_first(candidate, trial, trial_last) };
+
+                if (trial_levels <= levels)
+                {
+                    break;
+                }
+
+                std::swap(component, trial);
+                levels = trial_levels;
+                last_level = trial_last;
+            }
+
+            for (auto v : component)
+            {
+                placed[v] = 1;
+                order.push_back(v);
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+
+        return order;
+    }
+
+    void DelaunayGenerator::remove_exterior()
+    {
+        // Triangles sharing a vertex with the super triangle are already gone so the
+        // region outside the boundary is everything reachable from the convex hull
+        std::vector<bool> exterior(triangles_.size(), false);
+        std::stack<int> tri_stack{};
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                bool constrained{ constrained_edges_.count(edge_key(triangles_[t][i], triangles_[t][(i + 1) % 3])) != 0 };
+
+                if (neighbors_[t][i] == -1 && !constrained && !exterior[t])
+                {
+                    exterior[t] = true;
+                    tri_stack.push(t);
+                }
+            }
+        }
+
+        for (auto hole : holes_)
+        {
+            int t{ find_enclosing_triangle(hole) };
+
+            if (t != -1 && !exterior[t])
+            {
+                exterior[t] = true;
+                tri_stack.push(t);
+            }
+        }
+
+        // Flood fill across edges that are not constraints
+        while (!tri_stack.empty())
+        {
+            int t = tri_stack.top();
+            tri_stack.pop();
+
+            for (int i = 0; i < 3; ++i)
+            {
+                int neighbor{ neighbors_[t][i] };
+
+                if (neighbor == -1 || exterior[neighbor])
+                {
+                    continue;
+                }
+
+                if (constrained_edges_.count(edge_key(triangles_[t][i], triangles_[t][(i + 1) % 3])) != 0)
+                {
+                    continue;
+                }
+
+                exterior[neighbor] = true;
+                tri_stack.push(neighbor);
+            }
+        }
+
+        // Compact the surviving triangles keeping their relative order
+        std::vector<int> new_index(triangles_.size(), -1);
+        int count{ 0 };
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            if (!exterior[t])
+            {
+                new_index[t] = count++;
+            }
+        }
+
+        for (int t = 0; t < triangles_.size(); ++t)
+        {
+            if (exterior[t])
+            {
+                continue;
+            }
+
+            std::array<int, 3> adj{};
+            for (int i = 0; i < 3; ++i)
+            {
+                adj[i] = neighbors_[t][i] == -1 ? -1 : new_index[neighbors_[t][i]];
+            }
+
+            triangles_[new_index[t]] = triangles_[t];
+            neighbors_[new_index[t]] = adj;
+        }
+
+        triangles_.resize(count);
+        neighbors_.resize(count);
+
+        build_vertex_triangles();
+
+        if (!edge_index_.empty())
+        {
+            build_edge_index();
+        }
+    }
+
+    DelaunayGenerator::ConstraintCrossing DelaunayGenerator::walk_constraint(int start, int end)
+    {
+        ConstraintCrossing crossing{};
+
+        Point3D p_start{ points_[start] };
+        Point3D p_end{ points_[end] };
+
+        // The constraint edge is already a part of the triangulation
+        if (has_edge(start, end))
+        {
+            crossing.end = end;
+            return crossing;
+        }
+
+        // Go around the triangles containing start in a circle and try to find
+        // a vertex on the constraint or an edge that intersects the constraint
+        std::vector<int> search_tris{};
+        collect_fan(start, search_tris);
+
+        int current{ -1 };
+        int edge{ -1 };
+        int right{ -1 };
+        int left{ -1 };
+
+        for (auto search_tri : search_tris)
+        {
+            int i{ triangles_[search_tri][0] == start ? 0 : (triangles_[search_tri][1] == start ? 1 : 2) };
+
+            int x{ triangles_[search_tri][(i + 1) % 3] };
+            int y{ triangles_[search_tri][(i + 2) % 3] };
+
+            double orient_x{ orientation(p_start, p_end, points_[x]) };
+            double orient_y{ orientation(p_start, p_end, points_[y]) };
+
+            // A vertex lying on the constraint splits it into two pieces
+            if (orient_x == 0.0 && dot_product(subtract(points_[x], p_start), subtract(p_end, p_start)) > 0.f)
+            {
+                crossing.end = x;
+                return crossing;
+            }
+
+            if (orient_y == 0.0 && dot_product(subtract(points_[y], p_start), subtract(p_end, p_start)) > 0.f)
+            {
+                crossing.end = y;
+                return crossing;
+            }
+
+            // The constraint leaves through the edge opposite start when x is
+            // to the right of the constraint and y is to the left
+            if (orient_x < 0.0 && orient_y > 0.0)
+            {
+                current = search_tri;
+                edge = (i + 1) % 3;
+                right = x;
+                left = y;
+                break;
+            }
+        }
+
+        if (current == -1)
+        {
+            return crossing;
+        }
+
+        crossing.triangles.push_back(current);
+
+        while (true)
+        {
+            if (constrained_edges_.count(edge_key(right, left)) != 0)
+            {
+                std::cerr << "Error: constraint edges intersect" << std::endl;
+                crossing.end = -1;
+                return crossing;
+            }
+
+            crossing.edges.push_back({ right, left });
+
+            if (crossing.right_chain.empty() || crossing.right_chain.back() != right)
+            {
+                crossing.right_chain.push_back(right);
+            }
+            if (crossing.left_chain.empty() || crossing.left_chain.back() != left)
+            {
+                crossing.left_chain.push_back(left);
+            }
+
+            int next{ neighbors_[current][edge] };
+
+            if (next == -1)
+            {
+                // The constraint leaves the triangulated region
+                crossing.end = -1;
+                return crossing;
+            }
+
+            // The shared edge runs from left to right in the next triangle
+            int k{ 0 };
+            while (triangles_[next][k] != left)
+            {
+                ++k;
+            }
 
-            // Delete the enclosing triangle and create 3 new triangles between
-            // the enclosing vertices and the new vertex p (Always make p the first vertex)
-            // replace enclosing triangle with the first new one and add the other two to the vector
-            // Keep vertex indices ordered counter-clockwise for each triangle 
-            triangles_[enclosing_tri_idx] = { p, enclosing_tri[0], enclosing_tri[1] };
-            triangles_.push_back({ p, enclosing_tri[1], enclosing_tri[2] });
-            triangles_.push_back({ p, enclosing_tri[2], enclosing_tri[0] });
+            int z{ triangles_[next][(k + 2) % 3] };
 
-            // Indices for the new triangles
-            int tri_0{ enclosing_tri_idx };
-            int tri_1{ static_cast<int>(triangles_.size()) - 2 };
-            int tri_2{ static_cast<int>(triangles_.size()) - 1 };
+            crossing.triangles.push_back(next);
 
-            /* // Push the new triangles onto the stack
-            tri_stack.push(tri_0);
-            tri_stack.push(tri_1);
-            tri_stack.push(tri_2); */
+            if (z == end)
+            {
+                crossing.end = end;
+                return crossing;
+            }
 
-            // The triangles adjacent to the original triangle become the opposite adjacent neighbor
-            // to the new triangles i.e. they share the edge that does not include the new point
-            int opp_adj_0 = enclosing_adj[0];;
-            int opp_adj_1 = enclosing_adj[1];
-            int opp_adj_2 = enclosing_adj[2];
+            double orient_z{ orientation(p_start, p_end, points_[z]) };
 
-            // When adding to the adjacency list make the opposite adjacent triangle to p
-            // the middle adjacency entry so we know when popping a triangle t from the stack
-            // that the opposite adjacent edge to point triangles[t][0] is adjacency[t][1] (not 2)
+            if (orient_z == 0.0)
+            {
+                crossing.end = z;
+                return crossing;
+            }
 
-            // The statement "In general for element I in the stack, the opposite adjacent triangle
-            // is given by E(2, I)" Confused me since fortran starts arrays at 1 not 0 and the paper
-            // didn't specify a relative position i.e. middle vs last but it turns out to be middle
-            // so actually we need E(1, I) to be opposite adjacent of p not E(2, I)
+            current = next;
 
-            // Update existing adjancency entry
-            neighbors_[tri_0][0] = tri_2;
-            neighbors_[tri_0][1] = opp_adj_0;
-            neighbors_[tri_0][2] = tri_1;
+            if (orient_z > 0.0)
+            {
+                // z is on the left so the constraint crosses edge right-z next
+                edge = (k + 1) % 3;
+                left = z;
+            }
+            else
+            {
+                // z is on the right so the constraint crosses edge z-left next
+                edge = (k + 2) % 3;
+                right = z;
+            }
+        }
+    }
 
-            //adjacency[tri_1][0] = tri_0;
-            //adjacency[tri_1][1] = opp_adj_1;
-            //adjacency[tri_1][2] = tri_2;
+    bool DelaunayGenerator::insert_constraint_flip(int start, const ConstraintCrossing& crossing)
+    {
+        int end{ crossing.end };
 
-            //adjacency[tri_2][0] = tri_1;
-            //adjacency[tri_2][1] = opp_adj_2;
-            //adjacency[tri_2][2] = tri_0;
+        Point3D p_start{ points_[start] };
+        Point3D p_end{ points_[end] };
 
-            // Add adjacency entries for the two new triangles
-            neighbors_.push_back({ tri_0, opp_adj_1, tri_2 });
-            neighbors_.push_back({ tri_1, opp_adj_2, tri_0 });
+        std::deque<Edge> intersecting{ crossing.edges.begin(), crossing.edges.end() };
+        std::vector<Edge> new_edges{};
 
+        // While there are still intersecting edges
+        while (!intersecting.empty())
+        {
+            // Remove an edge from the edge list that intersects the constraint
+            Edge edge{ intersecting.front() };
+            intersecting.pop_front();
 
-            // Place the new triangles containing p in the stack as long as the edges opposite
-            // p have a neighboring triangle (i.e. is not on a boundary t = -1)
-            // While doing this update the adjacency list for the enclosing triangles neighbors
-            // as long as they exist (!= -1) The first one enclosing_adj[0] does not need to be 
-            // updated since it already points to tri_0 since it was reused but it wont hurt
+            int tri_l{ find_edge(edge.n1, edge.n2) };
+            int tri_r{ find_edge(edge.n2, edge.n1) };
 
-            if (opp_adj_0 != -1)
+            // A crossed edge on the boundary cannot be flipped
+            if (tri_l == -1 || tri_r == -1)
             {
-                tri_stack.push(tri_0);
+                std::cerr << "Error: Constraint crosses an edge without a triangle on both sides" << std::endl;
+                return false;
             }
-            if (opp_adj_1 != -1)
+
+            // Check if the two triangles sharing this edge form a convex quadrilateral
+            // If they do not form a convex quadrilateral, place the edge back on the list and continue
+            if (!check_convex(tri_l, tri_r))
             {
-                // Update opposite adjancent 1's neighbor entry that used to point
-                // to enclosing triangle to now point toward triangle 1
-                update_adjacent(opp_adj_1, enclosing_tri_idx, tri_1);
+                intersecting.push_back(edge);
+                continue;
+            }
+
+            // If they do form a convex quadrilateral, swap the diagonal of the two triangles
+            rotate_to_neighbor(tri_l, tri_r);
+            swap_triangles(tri_l, tri_r);
 
-                tri_stack.push(tri_1);
+            Edge diagonal{ triangles_[tri_l][0], triangles_[tri_l][2] };
+
+            // If the new edge still intersects the constraint, add it to intersection list,
+            // otherwise add it to a list of newly created edges
+            if (check_intersection(points_[diagonal.n1], points_[diagonal.n2], p_start, p_end))
+            {
+                intersecting.push_back(diagonal);
             }
-            if (opp_adj_2 != -1)
+            else
             {
-                // Update opposite adjancent 2's neighbor entry that used to point
-                // to enclosing triangle to now point toward triangle 2
-                update_adjacent(opp_adj_2, enclosing_tri_idx, tri_2);
-
-                tri_stack.push(tri_2);
+                new_edges.push_back(diagonal);
             }
+        }
+
+        // Restore Delaunay Condition
 
+        // Loop over newly created edges until no more swaps take place
+        bool swapped{ true };
+
+        while (swapped)
+        {
+            swapped = false;
 
-            // Check Delaunay condition and swap as needed propagating via the stack
-            while (!tri_stack.empty())
+            for (auto& edge : new_edges)
             {
-                int tri_l = tri_stack.top();
-                tri_stack.pop();
+                // if the new edge is not the constrained edge, check if the triangles
+                // that share the edge satisfy the Delaunay Condition
+                bool is_constraint{ (edge.n1 == start && edge.n2 == end) || (edge.n1 == end && edge.n2 == start) };
+
+                if (is_constraint || constrained_edges_.count(edge_key(edge.n1, edge.n2)) != 0)
+                {
+                    continue;
+                }
+
+                int tri_l{ find_edge(edge.n1, edge.n2) };
+                int tri_r{ find_edge(edge.n2, edge.n1) };
 
-                // the point that was added when tri_l was formed
-                int point_p = triangles_[tri_l][0];
+                if (tri_r == -1)
+                {
+                    continue;
+                }
 
-                // The triangle opposite adjacent to the point p
-                int tri_r = neighbors_[tri_l][1];
+                rotate_to_neighbor(tri_l, tri_r);
 
-                // Check if point p is inside the circumcircle of triangle r
-                if (tri_r != -1 && check_delaunay(tri_l, tri_r))
+                // If they do not, then swap the diagonal, replacing the edge in the new edge list
+                if (check_delaunay(tri_l, tri_r))
                 {
-                    // Swap the diagonal edge by updating the points of l and r
-                    // then update the adjancies of the effected neighbors
                     swap_triangles(tri_l, tri_r);
 
-                    // There are now potentially two triangles adjacent to l and r (A, B)
-                    // that are opposite p. place the l on the stack if A exists and r on the stack if B exists
-                    if (neighbors_[tri_l][1] != -1)
-                    {
-                        tri_stack.push(tri_l);
-                    }
-                    if (neighbors_[tri_r][1] != -1)
-                    {
-                        tri_stack.push(tri_r);
-                    }
+                    edge = { triangles_[tri_l][0], triangles_[tri_l][2] };
+                    swapped = true;
                 }
             }
         }
 
-        // Remove triangles that include a vertex from the super triangle
-        int current{ 0 };
-        int last{ static_cast<int>(triangles_.size() - 1) };
+        return true;
+    }
 
-        while (current <= last)
-        {
-            bool should_remove{ false };
+    bool DelaunayGenerator::insert_constraint_cavity(int start, const ConstraintCrossing& crossing)
+    {
+        int end{ crossing.end };
+
+        // Record the triangles outside the cavity keyed by the directed cavity boundary edge
+        std::unordered_set<int> cavity{ crossing.triangles.begin(), crossing.triangles.end() };
+        std::unordered_map<std::uint64_t, int> outside{};
 
-            // Check if any point in the current triangle is a point in the super triangle
+        for (auto tri : crossing.triangles)
+        {
             for (int i = 0; i < 3; ++i)
             {
-                for (int j = 0; j < 3; ++j)
-                {
-                    // Curious if avoiding a conditional statement here
-                    // improves performance in any way
-                    /* if (triangles_[current][i] == super_triangle[j])
-                    {
-                        should_remove = true;
-                    } */
+                int neighbor{ neighbors_[tri][i] };
 
-                    // if set to true keep it true otherwise check the condition
-                    bool match{ triangles_[current][i] == super_triangle[j] };
-                    should_remove = should_remove || match;
+                if (neighbor == -1 || cavity.count(neighbor) == 0)
+                {
+                    std::uint64_t key{ (static_cast<std::uint64_t>(triangles_[tri][i]) << 32) | static_cast<std::uint32_t>(triangles_[tri][(i + 1) % 3]) };
+                    outside[key] = neighbor;
                 }
             }
+        }
 
-            if (should_remove)
-            {
-                // Swap the current triangle with the last triangle
-                swap_triangle_positions(current, last);
+        // Retriangulate the pseudo-polygons on each side of the constraint
+        // Both chains are passed so that they lie to the left of the base edge
+        std::vector<std::array<int, 3>> new_tris{};
+        new_tris.reserve(crossing.triangles.size());
 
-                // Remove the last triangle (the current triangle)
-                pop_triangle();
-                --last;
-            }
-            else
-            {
-                // If a swap was performed need to check current again
-                ++current;
-            }
+        triangulate_pseudo_polygon(start, end, crossing.left_chain, new_tris);
 
+        std::vector<int> right_chain{ crossing.right_chain.rbegin(), crossing.right_chain.rend() };
+        triangulate_pseudo_polygon(end, start, right_chain, new_tris);
 
+        if (new_tris.size() != crossing.triangles.size())
+        {
+            std::cerr << "Error: cavity retriangulation produced the wrong number of triangles" << std::endl;
+            return false;
         }
-    }
-
-    void DelaunayGenerator::apply_constraint()
-    {
-        // Make a list of triangle indices keyed by vertex index
-        // to give a starting search triangle for a given vertex
-        // There is one triangle per vertex not all triangles the
-        // vertex is a part of
 
-        std::vector<int> starting_tris(triangles_.size(), -1);
+        // Reuse the slots of the deleted triangles for the new ones
+        std::unordered_map<std::uint64_t, int> new_edges{};
 
-        for (int t = 0; t < triangles_.size(); ++t)
+        for (int n = 0; n < new_tris.size(); ++n)
         {
+            int tri{ crossing.triangles[n] };
+            triangles_[tri] = new_tris[n];
+
             for (int i = 0; i < 3; ++i)
             {
-                int v = triangles_[t][i];
-
-                if (starting_tris[v] == -1)
-                {
-                    starting_tris[v] = t;
-                }
+                std::uint64_t key{ (static_cast<std::uint64_t>(new_tris[n][i]) << 32) | static_cast<std::uint32_t>(new_tris[n][(i + 1) % 3]) };
+                new_edges[key] = tri;
+                vertex_triangle_[new_tris[n][i]] = tri;
             }
         }
 
-        // Check that all of the vertices are assigned a triangle
-        for (auto t : starting_tris)
+        if (!edge_index_.empty())
         {
-            if (t == -1)
+            for (auto edge : crossing.edges)
             {
-                std::cerr << "Error: failed to create vertex to triangle list while applying constraints" << std::endl;
-                return;
+                edge_index_.erase(edge.n1, edge.n2);
             }
-        }
 
+            for (auto tri : crossing.triangles)
+            {
+                index_triangle(tri);
+            }
+        }
 
-        // Loop over the constraining edges
-        for (int constraint = 0; constraint < edges_.size(); ++constraint)
+        // Stitch the neighbors together, either to another new triangle sharing
+        // the reversed edge or to the triangle that was outside the cavity
+        for (auto tri : crossing.triangles)
         {
-            // If the edge already exists in the triangulation
-            // skip to the next edge
-            // Otherwise find all of the edges in the triangulation
-            // that cross the target edge to remove them
-            // It is recommended to make a list that holds the triangles each vertex
-            // is a part of (inverse of triangles list)
-
-            int con_start = edges_[constraint].n1;
-            int con_end = edges_[constraint].n2;
-
-            // Find all of the triangles that contain the constraint start vertex
-            std::vector<int> search_tris{};
-
-            int previous{ -1 };
-            int current{ starting_tris[con_start] };
-
-            while (current != previous)
+            for (int i = 0; i < 3; ++i)
             {
-                search_tris.push_back(current);
+                int u{ triangles_[tri][i] };
+                int v{ triangles_[tri][(i + 1) % 3] };
 
-                previous = current;
+                auto twin = new_edges.find((static_cast<std::uint64_t>(v) << 32) | static_cast<std::uint32_t>(u));
 
-                // Check each neighbor of the current triangle
-                for (int n = 0; n < 3; ++n)
+                if (twin != new_edges.end())
                 {
-                    int neighbor = neighbors_[current][n];
+                    neighbors_[tri][i] = twin->second;
+                    continue;
+                }
 
-                    // Avoid neighbors that have already been checked
-                    if (neighbor == previous)
-                    {
-                        continue;
-                    }
+                int neighbor{ outside.at((static_cast<std::uint64_t>(u) << 32) | static_cast<std::uint32_t>(v)) };
+                neighbors_[tri][i] = neighbor;
 
-                    // Check that the neighbor contains the constraint start vertex
-                    for (int v = 0; v < 3; ++v)
+                if (neighbor != -1)
+                {
+                    for (int j = 0; j < 3; ++j)
                     {
-                        if (triangles_[n][v] == con_start)
+                        if (triangles_[neighbor][j] == v && triangles_[neighbor][(j + 1) % 3] == u)
                         {
-                            current = neighbor;
+                            neighbors_[neighbor][j] = tri;
                         }
                     }
                 }
             }
+        }
 
+        return true;
+    }
 
-            // Go around the triangles containing con_start in a circle and try to find either
-            // an edge that coincides with the constraint or an edge that intersects the constraint
-            bool found_match{ false };
-            bool found_intersection{ false };
-
-            for (auto search_tri : search_tris)
-            {
-
-
-                // Check each edge of the triangle looking for a match or intersection
-                for (int i = 0; i < 3; ++i)
-                {
-                    int e_start = triangles_[search_tri][i];
-                    int e_end = triangles_[search_tri][(i + 1) % 3];
-
-                    if (e_start == con_start && e_end == con_end)
-                    {
-                        found_match = true;
-                        break;
-                    }
+    void DelaunayGenerator::triangulate_pseudo_polygon(int a, int b, const std::vector<int>& chain,
+        std::vector<std::array<int, 3>>& result)
+    {
+        // Each sub-polygon is a base edge plus the range [first, last) of the chain
+        struct SubPolygon
+        {
+            int a{}, b{};
+            size_t first{}, last{};
+        };
 
-                    if (check_intersection(points_[e_start], points_[e_end], points_[con_start], points_[con_end]))
-                    {
-                        found_intersection = true;
-                        break;
-                    }
-                }
+        std::stack<SubPolygon> polygons{};
+        polygons.push({ a, b, 0, chain.size() });
 
-                if (found_match || found_intersection)
-                {
-                    break;
-                }
-            }
+        while (!polygons.empty())
+        {
+            SubPolygon poly{ polygons.top() };
+            polygons.pop();
 
-            // The constraint edge is already a part of the triangulation so skip to the next constraint
-            if (found_match)
+            if (poly.first == poly.last)
             {
                 continue;
             }
 
-            // If neither match nor intersection was found then the search list was not created correctly
-            if (!found_intersection)
+            // The vertex whose circumcircle with the base edge is empty of
+            // the remaining chain vertices forms a constrained Delaunay triangle
+            size_t c{ poly.first };
+
+            for (size_t i = poly.first + 1; i < poly.last; ++i)
             {
-                std::cerr << "Error: Failed to find a matching or intersecting triangle for the edge contraint" << std::endl;
-                return;
+                if (incircle(points_[poly.a], points_[poly.b], points_[chain[c]], points_[chain[i]]) > 0.0)
+                {
+                    c = i;
+                }
             }
 
-            // Walk from triangle to triangle in the direction of the constraint end point
-            // adding any intersecting edges along the way
+            result.push_back({ poly.a, poly.b, chain[c] });
+
+            polygons.push({ poly.a, chain[c], poly.first, c });
+            polygons.push({ chain[c], poly.b, c + 1, poly.last });
+        }
+    }
 
+    bool DelaunayGenerator::check_closed_constraints() const
+    {
+        // Union-find over the constraint vertices, an edge joining two vertices
+        // that are already connected closes a loop
+        std::unordered_map<int, int> parent{};
+        std::unordered_set<std::uint64_t> seen{};
 
-            // While there are still intersecting edges
+        auto find = [&](int v)
             {
-                // Remove an edge from the edge list that intersects the constraint
+                parent.try_emplace(v, v);
 
-                // Check if the two triangles sharing this edge form a convex quadrilateral
+                while (parent[v] != v)
+                {
+                    parent[v] = parent[parent[v]];
+                    v = parent[v];
+                }
 
-                // If they do not form a convex quadrilateral, place the edge back on the list and continue
+                return v;
+            };
 
-                // If they do form a convex quadrilateral, swap the diagonal of the two triangles
-                // If the new edge still intersects the constraint, add it to intersection list,
-                // otherwise add it to a list of newly created edges
+        for (auto edge : edges_)
+        {
+            // The same constraint given twice is not a loop
+            if (edge.n1 == edge.n2 || !seen.insert(edge_key(edge.n1, edge.n2)).second)
+            {
+                continue;
             }
 
-            // Restore Delaunay Condition
+            int a{ find(edge.n1) };
+            int b{ find(edge.n2) };
 
-            // Loop over newly created edges until no more swaps take place
+            if (a == b)
             {
-                // if the new edge is not the constrained edge, check if the triangles
-                // that share the edge satisfy the Delaunay Condition
-
-                // If they do not, then swap the diagonal, replacing the edge in the new edge list
+                return true;
             }
 
-            // Remove triangles that share a vertex with the super triangle or are outside the boundary
-            // Trace each boundary and mark triangles for deletion
+            parent[a] = b;
+        }
+
+        return false;
+    }
 
+    std::uint64_t DelaunayGenerator::edge_key(int a, int b)
+    {
+        if (a > b)
+        {
+            std::swap(a, b);
         }
+
+        return (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b);
     }
 
     void DelaunayGenerator::normalize_points()
@@ -580,6 +3343,11 @@ namespace moodysim
     }
 
     int DelaunayGenerator::find_enclosing_triangle(int p)
+    {
+        return find_enclosing_triangle(points_[p]);
+    }
+
+    int DelaunayGenerator::find_enclosing_triangle(Point3D point)
     {
         int result{ -1 };
 
@@ -597,7 +3365,7 @@ namespace moodysim
 
                 Point3D v1{ points_[triangles_[t][e]] }; // point where the edge starts
                 Point3D v2{ points_[triangles_[t][e2]] }; // point where the edge stops
-                Point3D vp{ points_[p] }; // search point
+                Point3D vp{ point }; // search point
 
                 // Subtract edge start to get vectors from start to end and from start to point
                 v2.x -= v1.x;
@@ -791,6 +3559,45 @@ namespace moodysim
         {
             update_adjacent(n_c, tri_l, tri_r);
         }
+
+        // v1 and v2 each lost one of the two triangles
+        vertex_triangle_[p] = tri_l;
+        vertex_triangle_[v2] = tri_l;
+        vertex_triangle_[v3] = tri_r;
+        vertex_triangle_[v1] = tri_r;
+
+        // The old diagonal is gone and edges A and C changed triangles
+        if (!edge_index_.empty())
+        {
+            edge_index_.erase(v1, v2);
+            index_triangle(tri_l);
+            index_triangle(tri_r);
+        }
+    }
+
+    void DelaunayGenerator::rotate_to_neighbor(int tri, int neighbor)
+    {
+        int i{ 0 };
+        while (neighbors_[tri][i] != neighbor)
+        {
+            ++i;
+        }
+
+        rotate_vertices(tri, (i + 2) % 3);
+    }
+
+    void DelaunayGenerator::rotate_vertices(int tri, int first)
+    {
+        // Shift the entries keeping the vertex order counter-clockwise
+        // and each neighbor opposite the same edge
+        std::array<int, 3> pts{ triangles_[tri] };
+        std::array<int, 3> adj{ neighbors_[tri] };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            triangles_[tri][i] = pts[(i + first) % 3];
+            neighbors_[tri][i] = adj[(i + first) % 3];
+        }
     }
 
     void DelaunayGenerator::swap_triangle_positions(int tri_a, int tri_b)
@@ -836,6 +3643,18 @@ namespace moodysim
         triangles_[tri_b] = triangle_a;
         neighbors_[tri_a] = neigh_b;
         neighbors_[tri_b] = neigh_a;
+
+        if (!vertex_triangle_.empty())
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                vertex_triangle_[triangles_[tri_a][i]] = tri_a;
+                vertex_triangle_[triangles_[tri_b][i]] = tri_b;
+            }
+        }
+
+        index_triangle(tri_a);
+        index_triangle(tri_b);
     }
 
     void DelaunayGenerator::pop_triangle()
@@ -851,6 +3670,42 @@ namespace moodysim
             }
         }
 
+        // Vertices pointing at the last triangle move to a neighbor sharing them
+        if (!vertex_triangle_.empty())
+        {
+            for (size_t i = 0; i < 3; ++i)
+            {
+                int v{ triangles_[last][i] };
+
+                if (vertex_triangle_[v] == static_cast<int>(last))
+                {
+                    int after{ neighbors_[last][i] };
+                    int before{ neighbors_[last][(i + 2) % 3] };
+
+                    vertex_triangle_[v] = after != -1 ? after : before;
+                }
+            }
+        }
+
+        // Edges shared with a neighbor now only belong to the neighbor
+        if (!edge_index_.empty())
+        {
+            for (size_t i = 0; i < 3; ++i)
+            {
+                int a{ triangles_[last][i] };
+                int b{ triangles_[last][(i + 1) % 3] };
+
+                if (neighbors_[last][i] != -1)
+                {
+                    edge_index_.insert(a, b, neighbors_[last][i]);
+                }
+                else
+                {
+                    edge_index_.erase(a, b);
+                }
+            }
+        }
+
         // Remove the last triangle and neighbor entries
         triangles_.pop_back();
         neighbors_.pop_back();
@@ -883,15 +3738,12 @@ namespace moodysim
 
     bool DelaunayGenerator::check_intersection(Point3D a1, Point3D a2, Point3D b1, Point3D b2)
     {
-        Point3D cross1 = cross_product(subtract(a2, a1), subtract(b2, a2));
-
-        Point3D cross2 = cross_product(subtract(a2, a1), subtract(b1, a2));
+        // The segments properly intersect when the end points of each segment lie
+        // strictly on opposite sides of the other segment
+        double side_b{ orientation(a1, a2, b1) * orientation(a1, a2, b2) };
+        double side_a{ orientation(b1, b2, a1) * orientation(b1, b2, a2) };
 
-        Point3D cross3 = cross_product(subtract(b2, b1), subtract(a2, b2));
-
-        Point3D cross4 = cross_product(subtract(b2, b1), subtract(a1, b2));
-
-        if (dot_product(cross1, cross2) > 0.f && dot_product(cross3, cross4) > 0.f)
+        if (side_b < 0.0 && side_a < 0.0)
         {
             return true;
         }
@@ -901,11 +3753,139 @@ namespace moodysim
 
     bool DelaunayGenerator::check_convex(int t1, int t2)
     {
+        // Find the shared edge v1-v2 and the vertex of each triangle opposite it
+        int i{ 0 };
+        while (neighbors_[t1][i] != t2)
+        {
+            ++i;
+        }
+
+        int v1{ triangles_[t1][i] };
+        int v2{ triangles_[t1][(i + 1) % 3] };
+        int p{ triangles_[t1][(i + 2) % 3] };
+
+        int v3{ -1 };
+        for (int j = 0; j < 3; ++j)
+        {
+            if (triangles_[t2][j] != v1 && triangles_[t2][j] != v2)
+            {
+                v3 = triangles_[t2][j];
+            }
+        }
+
+        // The quad is strictly convex when both diagonals cross each other
+        bool split_diagonal{ orientation(points_[p], points_[v3], points_[v1]) * orientation(points_[p], points_[v3], points_[v2]) < 0.0 };
+        bool split_edge{ orientation(points_[v1], points_[v2], points_[p]) * orientation(points_[v1], points_[v2], points_[v3]) < 0.0 };
+
+        return split_diagonal && split_edge;
+    }
+
+    void DelaunayGenerator::collect_fan(int v, int start, std::vector<int>& fan) const
+    {
+        fan.clear();
+
+        // Rotate around v crossing the edge leaving v in each triangle
+        int current{ start };
 
+        do
+        {
+            fan.push_back(current);
 
+            int i{ triangles_[current][0] == v ? 0 : (triangles_[current][1] == v ? 1 : 2) };
+            current = neighbors_[current][i];
+        } while (current != -1 && current != start);
 
+        // If a boundary was hit rotate the other way from start to pick up the rest
+        if (current == -1)
+        {
+            current = start;
 
+            while (true)
+            {
+                int i{ triangles_[current][0] == v ? 0 : (triangles_[current][1] == v ? 1 : 2) };
+                current = neighbors_[current][(i + 2) % 3];
 
-        return false;
+                if (current == -1)
+                {
+                    break;
+                }
+
+                fan.push_back(current);
+            }
+        }
+    }
+
+    void DelaunayGenerator::collect_fan(int v, std::vector<int>& fan) const
+    {
+        if (vertex_triangle_[v] == -1)
+        {
+            fan.clear();
+            return;
+        }
+
+        collect_fan(v, vertex_triangle_[v], fan);
+    }
+
+    int DelaunayGenerator::find_edge(int a, int b, int start)
+    {
+        std::vector<int> fan{};
+        collect_fan(a, start, fan);
+
+        for (auto tri : fan)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (triangles_[tri][i] == a && triangles_[tri][(i + 1) % 3] == b)
+                {
+                    return tri;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    int DelaunayGenerator::find_edge(int a, int b) const
+    {
+        int tri{ edge_index_.find(a, b) };
+
+        if (tri == -1)
+        {
+            return -1;
+        }
+
+        // The index holds either side of the edge
+        for (int i = 0; i < 3; ++i)
+        {
+            if (triangles_[tri][i] == a && triangles_[tri][(i + 1) % 3] == b)
+            {
+                return tri;
+            }
+
+            if (triangles_[tri][i] == b && triangles_[tri][(i + 1) % 3] == a)
+            {
+                return neighbors_[tri][i];
+            }
+        }
+
+        return -1;
+    }
+
+    void DelaunayGenerator::build_edge_index()
+    {
+        edge_index_.build(triangles_, neighbors_);
+    }
+
+    void DelaunayGenerator::index_triangle(int tri)
+    {
+        if (edge_index_.empty())
+        {
+            return;
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            edge_index_.insert(triangles_[tri][i], triangles_[tri][(i + 1) % 3], tri);
+        }
     }
-}
\ No newline at end of file
+}
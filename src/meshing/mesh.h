@@ -2,6 +2,16 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
+#include <cstddef>
+#include <stack>
+#include <queue>
+#include <unordered_set>
+#include <functional>
+
+#include "edgeindex.h"
+#include "sizefield.h"
+#include "generator.h"
 
 namespace moodysim
 {
@@ -16,12 +26,77 @@ namespace moodysim
         int n1{}, n2{};
     };
 
+    // Strategy used to insert a constraint edge into an existing triangulation
+    enum class ConstraintMode
+    {
+        Automatic,  // Pick per constraint based on the number of crossed edges
+        Flip,       // Flip crossing edges until the constraint appears (Sloan)
+        Cavity,     // Delete crossed triangles and retriangulate both sides (Anglada)
+        Conforming  // Split constraints with Steiner points until they are Delaunay edges
+    };
+
+    // Where refinement inserts the Steiner point that removes a bad triangle
+    enum class SteinerPlacement
+    {
+        Circumcenter,  // Circumcenter of the bad triangle (Ruppert)
+        OffCenter      // Point on the bisector of the shortest edge that just meets the angle bound (Ungor)
+    };
+
+    // Symmetric positive definite tensor, the length of edge e under it is sqrt(e^T M e)
+    struct MetricTensor
+    {
+        float m11{ 1.f }, m12{ 0.f }, m22{ 1.f };
+    };
+
+    // Rule used to pick the new position of a vertex when smoothing
+    enum class SmoothingMethod
+    {
+        Laplacian,    // Average of the surrounding vertices
+        Angle,        // Average of the positions bisecting the angle at each surrounding vertex (Zhou and Shimada)
+        Optimization  // Local search maximizing the worst triangle quality around the vertex
+    };
+
+    // Order given to the vertices by renumber
+    enum class RenumberingMethod
+    {
+        Hilbert,      // Position along a Hilbert curve through the bounding box
+        CuthillMcKee  // Reverse Cuthill-McKee breadth first order keeping the bandwidth of the edge graph small
+    };
+
+    // Everything a DelaunayGenerator needs to carry on where it stopped, see get_state
+    // The edge index is rebuilt and refinement queues are refilled by scanning the triangles
+    struct DelaunayState
+    {
+        std::vector<Point3D> points{};
+        std::vector<int> point_ordering{};
+        std::vector<Edge> edges{};
+        std::vector<Point3D> holes{};
+        std::vector<std::array<int, 3>> triangles{};
+        std::vector<std::array<int, 3>> neighbors{};
+        std::vector<int> vertex_triangles{};
+        std::vector<std::uint64_t> constrained_edges{};
+
+        int num_steiner_points{ 0 };
+        SteinerPlacement steiner_placement{ SteinerPlacement::Circumcenter };
+
+        // While triangulate is running the number of input points (-1 otherwise) and the next one to insert
+        int num_input_points{ -1 };
+        int next_point{ 0 };
+    };
+
     class SurfaceMeshData;
+    class PointSource;
 
     SurfaceMeshData generate_sample_mesh();
 
     std::vector<Point3D> generate_sample_points(float radius, int density);
 
+    // The points of generate_sample_points produced one at a time
+    Generator<Point3D> stream_sample_points(float radius, int density);
+
+    // Upper bound on the number of points from generate_sample_points, for reserving memory
+    size_t sample_points_bound(float radius, int density);
+
 
     // This class is not intended to be a public interface
     // it exposes more inner functionality for testing but is intended
@@ -30,10 +105,22 @@ namespace moodysim
     {
     public:
 
-        DelaunayGenerator(std::vector<Point3D> points, std::vector<Edge> edges)
-            : points_(std::move(points)), edges_(std::move(edges))
+        // Edges are constraints, when they form closed loops around the domain the triangles
+        // outside the loops and inside loops containing a hole point are removed
+        DelaunayGenerator(std::vector<Point3D> points, std::vector<Edge> edges, std::vector<Point3D> holes = {})
+            : points_(std::move(points)), edges_(std::move(edges)), holes_(std::move(holes))
         {}
 
+        // Read every point from source a chunk at a time straight into the points to triangulate
+        // so a generated cloud is never held in a second vector
+        explicit DelaunayGenerator(PointSource& source, std::vector<Edge> edges = {}, std::vector<Point3D> holes = {});
+
+        // Continue from a state saved with get_state
+        explicit DelaunayGenerator(DelaunayState state)
+        {
+            set_state(std::move(state));
+        }
+
         // Allow for state injection for testing purposes
         DelaunayGenerator(
             std::vector<Point3D> points,
@@ -44,13 +131,121 @@ namespace moodysim
         )
             : points_(std::move(points)), point_ordering_(std::move(point_ordering)),
             edges_(std::move(edges)), triangles_(std::move(triangles)), neighbors_(std::move(neighbors))
-        {}
+        {
+            build_vertex_triangles();
+        }
 
+        // Triangulate, apply the constraints and remove the exterior, then renumber if set_renumbering asked for it
         SurfaceMeshData generate_delaunay_mesh();
 
+        // Have generate_delaunay_mesh renumber the vertices and triangles with method before building the mesh,
+        // off by default so the vertices keep the input order
+        void set_renumbering(bool enabled, RenumberingMethod method = RenumberingMethod::Hilbert)
+        {
+            renumbering_ = enabled;
+            renumbering_method_ = method;
+        }
+
+        // Insert every point into a super triangle then remove it, picks up at the next point
+        // when the generator was restored from a checkpoint taken during triangulation
+        // and does nothing when the triangulation is already finished
         void triangulate();
 
-        void apply_constraint();
+        // Call checkpoint with the generator every interval points inserted by triangulate and every
+        // interval Steiner points added by refine, the generator is consistent at each call so
+        // get_state gives a state to resume from (an interval of 0 turns it off)
+        void set_checkpoint(std::function<void(const DelaunayGenerator&)> checkpoint, int interval)
+        {
+            checkpoint_ = std::move(checkpoint);
+            checkpoint_interval_ = interval;
+        }
+
+        // Copy the state into state reusing its memory so repeated snapshots do not allocate
+        void get_state(DelaunayState& state) const;
+
+        // Replace the state, the edge index is rebuilt if the triangulation was finished
+        void set_state(DelaunayState state);
+
+        // Insert point p into the current triangulation and restore the Delaunay condition
+        void insert_point(int p);
+
+        // Insert point p known to lie inside (or on an edge of) triangle tri
+        void insert_point(int p, int tri);
+
+        // Insert point p lying on the given edge of tri by splitting the edge and its neighbor
+        void split_edge(int p, int tri, int edge);
+
+        // Start a streamed triangulation (see StreamingDelaunay) with only a super triangle around the box
+        // so points can be added as they arrive, its corners are points 0 to 2
+        void begin_streaming(float xmin, float ymin, float xmax, float ymax);
+
+        // Append point and insert it, locating it by walking from a triangle of point near (-1 for none)
+        // Returns the index of the point, or -1 leaving it out if no triangle contains it
+        int add_point(Point3D point, int near);
+
+        // Remove the triangles flagged in evict appending them to evicted, triangles next to them are left
+        // with -1 neighbors like the hull. Points left in no triangle are dropped and the rest keep their
+        // order, point_remap gives the new index of each old point (-1 when dropped)
+        void evict_triangles(const std::vector<char>& evict, std::vector<std::array<int, 3>>& evicted, std::vector<int>& point_remap);
+
+        // Swap triangles popped from the stack until the Delaunay condition holds
+        // (the point at index 0 of each triangle is checked against its middle neighbor)
+        void restore_delaunay(std::stack<int>& tri_stack);
+
+        // Insert each edge in edges_ into the triangulation, a constraint that cannot be inserted is reported
+        // and skipped, returns false if any was skipped
+        bool apply_constraint(ConstraintMode mode = ConstraintMode::Automatic);
+
+        // Remove triangles reachable from the convex hull or a hole point without crossing a constraint
+        void remove_exterior();
+
+        // Split edges_ at Steiner points until every constraint is a union of Delaunay edges
+        // Returns false if a piece was too short to split, which is reported and left unconstrained
+        bool conform_constraints();
+
+        // Insert Steiner points (Ruppert) until no triangle has an angle below min_angle (degrees)
+        // Termination is only guaranteed up to about 20.7 degrees so the number of points is capped
+        // Returns the number of Steiner points added
+        int refine(float min_angle, int max_steiner_points = 1 << 24);
+
+        // Also split triangles whose circumradius exceeds the size field at their centroid
+        int refine(float min_angle, const SizeField& size_field, int max_steiner_points = 1 << 24);
+
+        // Choose where refine inserts points, off-centers usually need far fewer points than circumcenters
+        void set_steiner_placement(SteinerPlacement placement) { steiner_placement_ = placement; }
+
+        // Ratio of circumradius to shortest edge of a triangle (1 / sqrt(3) for equilateral)
+        double radius_edge_ratio(int tri) const;
+
+        // Move each interior vertex to the centroid of its Voronoi cell (Lloyd relaxation)
+        // and repair the triangulation with local swaps after each iteration
+        void lloyd_relaxation(int iterations);
+
+        // Check if v is surrounded by triangles and not on a constraint so it is free to move
+        bool check_interior(int v, std::vector<int>& fan) const;
+
+        // Swap every edge that is not a constraint until the Delaunay condition holds
+        // Returns the number of swaps
+        int restore_delaunay_edges();
+
+        // Move interior vertices to improve the shape of the triangles without changing the topology
+        // Vertices of one color share no triangle so each color is updated in parallel
+        void smooth(SmoothingMethod method = SmoothingMethod::Laplacian, int iterations = 1);
+
+        // Split long edges, collapse short ones, and swap edges until the edges are close to unit
+        // length under metric, which holds a tensor per point and grows with the new points
+        // Each pass applies a maximal set of operations sharing no vertices in parallel
+        // Collapsed points stay in points_ without triangles
+        void remesh(std::vector<MetricTensor>& metric, int iterations = 4);
+
+        // Reorder the points so vertices sharing triangles are close in memory, then sort the triangles
+        // by their smallest vertex, points without triangles move to the end
+        // point_ordering_ keeps mapping the input points to their new location
+        void renumber(RenumberingMethod method = RenumberingMethod::Hilbert);
+
+        // Greedy coloring where vertices sharing an edge get different colors
+        // Returns the number of colors (vertices without triangles get -1)
+        int color_vertices(std::vector<int>& colors) const;
 
         void normalize_points();
 
@@ -59,6 +254,7 @@ namespace moodysim
 
         // Find the triangle that encloses the point p
         int find_enclosing_triangle(int p);
+        int find_enclosing_triangle(Point3D point);
 
         // Update the adjacency entry such that the entry pointing
         // to old_neighbor now points to new_neighbor
@@ -70,10 +266,18 @@ namespace moodysim
         // Swap the diagonal of a quad
         void swap_triangles(int tri_l, int tri_r);
 
+        // Rotate the vertices and neighbors of tri so that neighbor becomes the middle
+        // neighbor entry as expected by check_delaunay and swap_triangles
+        void rotate_to_neighbor(int tri, int neighbor);
+
+        // Rotate the vertices and neighbors of tri so that index first becomes index 0
+        void rotate_vertices(int tri, int first);
+
         // Swap the position of two triangles in the triangles list and update neighbors 
         void swap_triangle_positions(int tri_a, int tri_b);
 
         // Remove the last triangle from triangles list and remove references from neighbors
+        // A vertex whose other triangles are not reached through the edges of the last one is left at -1
         void pop_triangle();
 
 
@@ -86,14 +290,169 @@ namespace moodysim
         // Check if two triangles form a convex quadrilateral
         bool check_convex(int t1, int t2);
 
+        // Collect every triangle containing vertex v starting from triangle start
+        void collect_fan(int v, int start, std::vector<int>& fan) const;
+
+        // Collect every triangle containing vertex v in O(degree) starting from vertex_triangle_
+        void collect_fan(int v, std::vector<int>& fan) const;
+
+        // Find the triangle containing the directed edge a-b (-1 if there is none)
+        // by walking around a from start, used before the edge index is built
+        int find_edge(int a, int b, int start);
+
+        // Find the triangle containing the directed edge a-b using the edge index
+        int find_edge(int a, int b) const;
+
+        // Check if the triangulation contains edge a-b in either direction
+        bool has_edge(int a, int b) const { return edge_index_.find(a, b) != -1; }
+
+        // Record one triangle containing each vertex (-1 for vertices not in any triangle)
+        // from scratch, afterwards it is kept up to date as triangles change
+        void build_vertex_triangles();
+
+        // Index every edge of the triangulation, afterwards the index is kept up to date
+        // by every operation that changes the triangles
+        void build_edge_index();
+
+        // Triangulate the pseudo-polygon formed by edge a-b and a chain of vertices
+        // lying to the left of a-b ordered from a to b
+        void triangulate_pseudo_polygon(int a, int b, const std::vector<int>& chain,
+            std::vector<std::array<int, 3>>& result);
+
+        // Number of points requested from a PointSource at a time
+        static constexpr size_t point_chunk_size{ 1 << 16 };
+
+        // Constraints crossing more edges than this are inserted by cavity retriangulation
+        static constexpr int cavity_crossing_threshold{ 32 };
+
         // Used by tests to check internal state
         const std::vector<Point3D>& get_points() const { return points_; }
         const std::vector<int>& get_point_ordering() const { return point_ordering_; }
         const std::vector<std::array<int, 3>>& get_triangles() const { return triangles_; }
         const std::vector<std::array<int, 3>>& get_neighbors() const { return neighbors_; }
+        int get_num_steiner_points() const { return num_steiner_points_; }
+        const EdgeIndex& get_edge_index() const { return edge_index_; }
+        const std::vector<int>& get_vertex_triangles() const { return vertex_triangle_; }
 
     private:
 
+        // The triangles and edges crossed while walking along a constraint from start to end
+        // (end is the first vertex reached that lies on the constraint)
+        struct ConstraintCrossing
+        {
+            int end{ -1 };
+            std::vector<int> triangles{};
+            std::vector<Edge> edges{};
+            std::vector<int> left_chain{};
+            std::vector<int> right_chain{};
+        };
+
+        ConstraintCrossing walk_constraint(int start, int end);
+
+        // Both return false leaving the constraint out if it could not be inserted
+        bool insert_constraint_flip(int start, const ConstraintCrossing& crossing);
+
+        bool insert_constraint_cavity(int start, const ConstraintCrossing& crossing);
+
+        // Check if edge a-b is missing or has a vertex inside its diametral circle
+        bool check_encroached(int a, int b);
+
+        // One flag per point, set for the input points that point_ordering_ tracks
+        std::vector<char> input_vertices() const;
+
+        // Insert a Steiner point on segment a-b, returns its index (-1 if it is too short)
+        // Points past the end of input_vertex are Steiner points
+        int split_segment(int a, int b, const std::vector<char>& input_vertex);
+
+        int refine(float min_angle, const SizeField* size_field, int max_steiner_points);
+
+        // A triangle waiting for refinement, stale once the triangle no longer has these vertices
+        // ratio is how far the triangle is past the quality or size bound (above 1 when bad)
+        struct BadTriangle
+        {
+            double ratio{};
+            int tri{};
+            std::array<int, 3> vertices{};
+
+            bool operator<(const BadTriangle& other) const { return ratio < other.ratio; }
+        };
+
+        void queue_bad_triangle(int tri, double max_ratio, const SizeField* size_field, std::priority_queue<BadTriangle>& bad_triangles);
+
+        // Point inserted to remove bad triangle tri using steiner_placement_
+        // the off-center lies offcenter_distance times the shortest edge length from its midpoint
+        Point3D steiner_point(int tri, double offcenter_distance) const;
+
+        // Check if edge a-b is a constraint or on the convex hull
+        bool check_segment(int a, int b) const;
+
+        // Walk from start toward point returning the triangle containing it, or -1 with the
+        // segment that was in the way (-1, -1 if the walk did not finish)
+        int locate_visible(int start, Point3D point, Edge& blocking) const;
+
+        // Segments on the boundary of the cavity of point that have point inside their diametral circle
+        void collect_encroached(int tri, Point3D point, std::vector<Edge>& encroached) const;
+
+        // Split, collapse, or swap of edge of tri, ranked by priority
+        // u and v give the direction of a collapse (u is merged into v)
+        struct RemeshOperation
+        {
+            float priority{};
+            int tri{}, edge{};
+            int u{ -1 }, v{ -1 };
+        };
+
+        // Each pass returns the number of operations applied
+        int remesh_splits(std::vector<MetricTensor>& metric);
+        int remesh_collapses(const std::vector<MetricTensor>& metric);
+        int remesh_swaps(const std::vector<MetricTensor>& metric);
+
+        // Evaluate func(tri, edge, operation) in parallel for each edge once, keeping operations it returns true for
+        // sorted by decreasing priority
+        template <typename Func>
+        std::vector<RemeshOperation> collect_operations(Func&& func) const;
+
+        // Greedily pick operations in order whose vertices (from vertices(operation, list)) are not claimed yet
+        template <typename Func>
+        std::vector<RemeshOperation> select_independent(const std::vector<RemeshOperation>& operations, Func&& vertices) const;
+
+        double metric_length(int a, int b, const std::vector<MetricTensor>& metric) const;
+
+        // triangle_quality measured under the average tensor of a, b, and c
+        double metric_quality(int a, int b, int c, const std::vector<MetricTensor>& metric) const;
+
+        // Check if merging u into v keeps the mesh valid and every new edge shorter than max_length
+        bool check_collapse(int u, int v, double max_length, const std::vector<MetricTensor>& metric, std::vector<int>& fan) const;
+
+        // Split edge of tri at p like split_edge using the preallocated triangles tri_1 and opp_1
+        // without updating the edge index and constraints or restoring the Delaunay condition
+        void split_edge_slots(int p, int tri, int edge, int tri_1, int opp_1);
+
+        // Merge u into v given the triangles fan around u, the two triangles on edge u-v are marked with -1
+        void collapse_edge(int u, int v, const std::vector<int>& fan);
+
+        // Remove triangles marked by collapse_edge and renumber the rest
+        void compact_triangles();
+
+        // Vertices in at least one triangle in their new order
+        std::vector<int> hilbert_order() const;
+        std::vector<int> cuthill_mckee_order() const;
+
+        // New position of interior vertex v with triangles fan using the given smoothing rule
+        Point3D smoothed_position(int v, const std::vector<int>& fan, SmoothingMethod method) const;
+
+        // Worst quality of the triangles in fan with vertex v moved to position
+        double star_quality(int v, Point3D position, const std::vector<int>& fan) const;
+
+        // Point the edge index entries for the edges of tri at tri
+        void index_triangle(int tri);
+
+        // Check if the constraints contain a closed loop, otherwise they enclose no region
+        bool check_closed_constraints() const;
+
+        // Map an edge to a key that is the same regardless of direction
+        static std::uint64_t edge_key(int a, int b);
+
         // The point cloud to triangulate
         // Must copy since they will get normalized and reordered
         std::vector<Point3D> points_{};
@@ -103,6 +462,9 @@ namespace moodysim
 
         std::vector<Edge> edges_{};
 
+        // A point inside each closed constraint loop that should be left empty
+        std::vector<Point3D> holes_{};
+
         // Each triangle is defined by three indices into the points vector
         std::vector<std::array<int, 3>> triangles_;
 
@@ -110,10 +472,35 @@ namespace moodysim
         // each entry is an index into the triangle vector (-1 denotes no neighbor)
         std::vector<std::array<int, 3>> neighbors_;
 
+        // One triangle containing each vertex (-1 for vertices not in any triangle)
+        // giving a starting point to walk the triangles around a vertex
+        std::vector<int> vertex_triangle_{};
+
+        // Edges that have been inserted as constraints and must not be swapped
+        std::unordered_set<std::uint64_t> constrained_edges_{};
+
+        // Maps each edge to a triangle containing it (empty until triangulation is finished)
+        EdgeIndex edge_index_{};
+
+        // Number of points added to conform to the constraints
+        int num_steiner_points_{ 0 };
+
+        SteinerPlacement steiner_placement_{ SteinerPlacement::Circumcenter };
+
+        bool renumbering_{ false };
+        RenumberingMethod renumbering_method_{ RenumberingMethod::Hilbert };
+
+        // Input points of a triangulation in progress (-1 otherwise) and the next one to insert
+        int num_input_points_{ -1 };
+        int next_point_{ 0 };
+
+        std::function<void(const DelaunayGenerator&)> checkpoint_{};
+        int checkpoint_interval_{ 0 };
+
     };
 
 
-    Point3D subtract(Point3D a, Point3D b)
+    inline Point3D subtract(Point3D a, Point3D b)
     {
         return Point3D{
             (a.x - b.x),
@@ -122,12 +509,12 @@ namespace moodysim
         };
     }
 
-    float dot_product(Point3D a, Point3D b)
+    inline float dot_product(Point3D a, Point3D b)
     {
         return a.x * b.x + a.y * b.y + a.z * b.z;
     }
 
-    Point3D cross_product(Point3D a, Point3D b)
+    inline Point3D cross_product(Point3D a, Point3D b)
     {
         return Point3D{
             (a.y * b.z - a.z * b.y),
@@ -135,4 +522,70 @@ namespace moodysim
             (a.x * b.y - a.y * b.x)
         };
     }
+
+    // Twice the signed area of triangle abc in the xy plane (positive when counter-clockwise)
+    // Evaluated in double precision so it is exact enough for float input
+    inline double orientation(Point3D a, Point3D b, Point3D c)
+    {
+        double acx{ static_cast<double>(a.x) - c.x };
+        double acy{ static_cast<double>(a.y) - c.y };
+        double bcx{ static_cast<double>(b.x) - c.x };
+        double bcy{ static_cast<double>(b.y) - c.y };
+
+        return acx * bcy - acy * bcx;
+    }
+
+    // Center of the circle through a, b, and c in the xy plane
+    inline Point3D circumcenter(Point3D a, Point3D b, Point3D c)
+    {
+        double bx{ static_cast<double>(b.x) - a.x };
+        double by{ static_cast<double>(b.y) - a.y };
+        double cx{ static_cast<double>(c.x) - a.x };
+        double cy{ static_cast<double>(c.y) - a.y };
+
+        double sqr_b{ bx * bx + by * by };
+        double sqr_c{ cx * cx + cy * cy };
+        double d{ 2.0 * (bx * cy - by * cx) };
+
+        return Point3D{
+            static_cast<float>(a.x + (cy * sqr_b - by * sqr_c) / d),
+            static_cast<float>(a.y + (bx * sqr_c - cx * sqr_b) / d),
+            a.z
+        };
+    }
+
+    // Positive when d lies inside the circumcircle of the counter-clockwise triangle abc
+    inline double incircle(Point3D a, Point3D b, Point3D c, Point3D d)
+    {
+        double adx{ static_cast<double>(a.x) - d.x };
+        double ady{ static_cast<double>(a.y) - d.y };
+        double bdx{ static_cast<double>(b.x) - d.x };
+        double bdy{ static_cast<double>(b.y) - d.y };
+        double cdx{ static_cast<double>(c.x) - d.x };
+        double cdy{ static_cast<double>(c.y) - d.y };
+
+        double ad{ adx * adx + ady * ady };
+        double bd{ bdx * bdx + bdy * bdy };
+        double cd{ cdx * cdx + cdy * cdy };
+
+        return ad * (bdx * cdy - cdx * bdy)
+            + bd * (cdx * ady - adx * cdy)
+            + cd * (adx * bdy - bdx * ady);
+    }
+
+    // Shape quality of triangle abc in the xy plane, 1 for equilateral and 0 when degenerate
+    // (negative when clockwise) computed as 4 sqrt(3) area over the sum of squared edge lengths
+    inline double triangle_quality(Point3D a, Point3D b, Point3D c)
+    {
+        double abx{ static_cast<double>(b.x) - a.x };
+        double aby{ static_cast<double>(b.y) - a.y };
+        double bcx{ static_cast<double>(c.x) - b.x };
+        double bcy{ static_cast<double>(c.y) - b.y };
+        double cax{ static_cast<double>(a.x) - c.x };
+        double cay{ static_cast<double>(a.y) - c.y };
+
+        double sum{ abx * abx + aby * aby + bcx * bcx + bcy * bcy + cax * cax + cay * cay };
+
+        return sum == 0.0 ? 0.0 : 2.0 * 1.7320508075688772 * orientation(a, b, c) / sum;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+#include "mesh.h"
+#include "generator.h"
+
+namespace moodysim
+{
+    // Supplies points a chunk at a time so a point cloud can be generated or read straight into its consumer
+    class PointSource
+    {
+    public:
+
+        virtual ~PointSource() = default;
+
+        // Append up to max_count points to points, returns how many were appended (0 once the source is used up)
+        virtual size_t read(std::vector<Point3D>& points, size_t max_count) = 0;
+
+        // Expected number of points (an upper bound is fine) used to reserve memory once, 0 when unknown
+        virtual size_t size_hint() const { return 0; }
+
+        // Start reading from the first point again, returns false if the source can only be read once
+        virtual bool rewind() { return false; }
+    };
+
+    // Source walking a range of points once, such as a Generator from a coroutine or a view of a vector
+    template <typename Range>
+    class RangePointSource : public PointSource
+    {
+    public:
+
+        explicit RangePointSource(Range range, size_t size_hint = 0)
+            : range_(std::move(range)), size_hint_(size_hint)
+        {}
+
+        size_t read(std::vector<Point3D>& points, size_t max_count) override
+        {
+            // A generator starts running when begin is called so only call it once
+            if (!current_)
+            {
+                current_.emplace(std::ranges::begin(range_));
+            }
+
+            auto& current{ *current_ };
+            size_t count{ 0 };
+
+            for (; count < max_count && current != std::ranges::end(range_); ++current, ++count)
+            {
+                points.push_back(*current);
+            }
+
+            return count;
+        }
+
+        size_t size_hint() const override
+        {
+            if constexpr (std::ranges::sized_range<const Range>)
+            {
+                return std::ranges::size(range_);
+            }
+            else
+            {
+                return size_hint_;
+            }
+        }
+
+    private:
+
+        Range range_;
+        size_t size_hint_{};
+
+        std::optional<std::ranges::iterator_t<Range>> current_{};
+    };
+}
@@ -0,0 +1,307 @@
+#include "quality.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    // Arccosine in degrees from Abramowitz and Stegun 4.4.45 (absolute error below 7e-5 radians)
+    // Branch free so the measuring loop vectorizes
+    static inline float acos_degrees(float x)
+    {
+        x = x > 1.f ? 1.f : (x < -1.f ? -1.f : x);
+
+        float a{ std::abs(x) };
+        float result{ std::sqrt(1.f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f - 0.0187293f * a))) };
+
+        return 57.2957795f * (x < 0.f ? 3.14159265f - result : result);
+    }
+
+    // Number of triangles measured together, the corners are gathered first so the math runs on contiguous arrays
+    static constexpr int quality_block{ 256 };
+
+    // corner(t, k) returns the position of corner k of triangle t
+    template <typename Corner>
+    static QualityReport measure_triangles(size_t num_triangles, Corner&& corner, int num_bins, int num_worst)
+    {
+        QualityReport report{};
+
+        // Every histogram has at least one bin
+        num_bins = std::max(1, num_bins);
+        size_t max_worst{ static_cast<size_t>(std::max(0, num_worst)) };
+
+        QualityMeasure* measures[5]{ &report.min_angle, &report.max_angle, &report.aspect_ratio, &report.area, &report.radius_edge_ratio };
+
+        for (auto measure : measures)
+        {
+            measure->values.resize(num_triangles);
+        }
+
+        int num_blocks{ static_cast<int>((num_triangles + quality_block - 1) / quality_block) };
+
+        parallel_for(0, num_blocks, [&](int begin, int end)
+            {
+                float x[3][quality_block];
+                float y[3][quality_block];
+                float z[3][quality_block];
+
+                float min_angle[quality_block];
+                float max_angle[quality_block];
+                float aspect_ratio[quality_block];
+                float area[quality_block];
+                float radius_edge_ratio[quality_block];
+
+                for (int block = begin; block < end; ++block)
+                {
+                    size_t first{ static_cast<size_t>(block) * quality_block };
+                    int count{ static_cast<int>(std::min<size_t>(quality_block, num_triangles - first)) };
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            Point3D p{ corner(first + i, k) };
+                            x[k][i] = p.x;
+                            y[k][i] = p.y;
+                            z[k][i] = p.z;
+                        }
+                    }
+
+                    // Pad the last block with a valid triangle so the loop below always runs the full block
+                    for (int i = count; i < quality_block; ++i)
+                    {
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            x[k][i] = k == 1 ? 1.f : 0.f;
+                            y[k][i] = k == 2 ? 1.f : 0.f;
+                            z[k][i] = 0.f;
+                        }
+                    }
+
+                    for (int i = 0; i < quality_block; ++i)
+                    {
+                        float abx{ x[1][i] - x[0][i] }, aby{ y[1][i] - y[0][i] }, abz{ z[1][i] - z[0][i] };
+                        float bcx{ x[2][i] - x[1][i] }, bcy{ y[2][i] - y[1][i] }, bcz{ z[2][i] - z[1][i] };
+                        float cax{ x[0][i] - x[2][i] }, cay{ y[0][i] - y[2][i] }, caz{ z[0][i] - z[2][i] };
+
+                        float ab2{ abx * abx + aby * aby + abz * abz };
+                        float bc2{ bcx * bcx + bcy * bcy + bcz * bcz };
+                        float ca2{ cax * cax + cay * cay + caz * caz };
+
+                        float nx{ aby * bcz - abz * bcy };
+                        float ny{ abz * bcx - abx * bcz };
+                        float nz{ abx * bcy - aby * bcx };
+                        float twice_area{ std::sqrt(nx * nx + ny * ny + nz * nz) };
+
+                        // Cosines of the angles at a, b, and c
+                        float cos_a{ -(abx * cax + aby * cay + abz * caz) / std::sqrt(ab2 * ca2) };
+                        float cos_b{ -(abx * bcx + aby * bcy + abz * bcz) / std::sqrt(ab2 * bc2) };
+                        float cos_c{ -(bcx * cax + bcy * cay + bcz * caz) / std::sqrt(bc2 * ca2) };
+
+                        float angle_a{ acos_degrees(cos_a) };
+                        float angle_b{ acos_degrees(cos_b) };
+                        float angle_c{ acos_degrees(cos_c) };
+
+                        float smallest{ angle_a < angle_b ? angle_a : angle_b };
+                        float largest{ angle_a > angle_b ? angle_a : angle_b };
+                        smallest = smallest < angle_c ? smallest : angle_c;
+                        largest = largest > angle_c ? largest : angle_c;
+
+                        float shortest2{ ab2 < bc2 ? ab2 : bc2 };
+                        float longest2{ ab2 > bc2 ? ab2 : bc2 };
+                        shortest2 = shortest2 < ca2 ? shortest2 : ca2;
+                        longest2 = longest2 > ca2 ? longest2 : ca2;
+
+                        // A zero length edge makes the angles NaN which fails both comparisons
+                        min_angle[i] = smallest >= 0.f ? smallest : 0.f;
+                        max_angle[i] = largest <= 180.f ? largest : 180.f;
+                        area[i] = 0.5f * twice_area;
+
+                        // sqrt(3) l^2 / (4 A) and (l_ab l_bc l_ca / (4 A)) / l_min
+                        aspect_ratio[i] = 0.8660254f * longest2 / twice_area;
+                        radius_edge_ratio[i] = 0.5f * std::sqrt(ab2 * bc2 * ca2 / shortest2) / twice_area;
+                    }
+
+                    std::copy(min_angle, min_angle + count, report.min_angle.values.data() + first);
+                    std::copy(max_angle, max_angle + count, report.max_angle.values.data() + first);
+                    std::copy(aspect_ratio, aspect_ratio + count, report.aspect_ratio.values.data() + first);
+                    std::copy(area, area + count, report.area.values.data() + first);
+                    std::copy(radius_edge_ratio, radius_edge_ratio + count, report.radius_edge_ratio.values.data() + first);
+                }
+            }, 16);
+
+        // Per block partial results merged afterward so no thread writes shared state
+        int num_parts{ std::max(1, std::min(4 * thread_count(), num_blocks)) };
+        size_t part_size{ (num_triangles + num_parts - 1) / num_parts };
+
+        for (auto measure : measures)
+        {
+            std::vector<float> part_min(num_parts, std::numeric_limits<float>::max());
+            std::vector<float> part_max(num_parts, std::numeric_limits<float>::lowest());
+            std::vector<double> part_sum(num_parts, 0.0);
+            std::vector<size_t> part_count(num_parts, 0);
+
+            const std::vector<float>& values{ measure->values };
+
+            parallel_for(0, num_parts, [&](int begin, int end)
+                {
+                    for (int part = begin; part < end; ++part)
+                    {
+                        size_t first{ part * part_size };
+                        size_t last{ std::min(num_triangles, first + part_size) };
+
+                        float low{ std::numeric_limits<float>::max() };
+                        float high{ std::numeric_limits<float>::lowest() };
+                        double sum{ 0.0 };
+                        size_t count{ 0 };
+
+                        for (size_t t = first; t < last; ++t)
+                        {
+                            float value{ values[t] };
+
+                            if (std::isfinite(value))
+                            {
+                                low = value < low ? value : low;
+                                high = value > high ? value : high;
+                                sum += value;
+                                ++count;
+                            }
+                        }
+
+                        part_min[part] = low;
+                        part_max[part] = high;
+                        part_sum[part] = sum;
+                        part_count[part] = count;
+                    }
+                }, 1);
+
+            double sum{ 0.0 };
+            size_t count{ 0 };
+
+            measure->min = std::numeric_limits<float>::max();
+            measure->max = std::numeric_limits<float>::lowest();
+
+            for (int part = 0; part < num_parts; ++part)
+            {
+                measure->min = std::min(measure->min, part_min[part]);
+                measure->max = std::max(measure->max, part_max[part]);
+                sum += part_sum[part];
+                count += part_count[part];
+            }
+
+            if (count == 0)
+            {
+                measure->min = measure->max = 0.f;
+            }
+
+            measure->mean = count == 0 ? 0.f : static_cast<float>(sum / count);
+
+            // Second pass bins the values now that the range is known
+            std::vector<std::vector<size_t>> part_histogram(num_parts, std::vector<size_t>(num_bins, 0));
+
+            float low{ measure->min };
+            float scale{ measure->max > low ? num_bins / (measure->max - low) : 0.f };
+
+            parallel_for(0, num_parts, [&](int begin, int end)
+                {
+                    for (int part = begin; part < end; ++part)
+                    {
+                        size_t first{ part * part_size };
+                        size_t last{ std::min(num_triangles, first + part_size) };
+
+                        size_t* histogram{ part_histogram[part].data() };
+
+                        for (size_t t = first; t < last; ++t)
+                        {
+                            float value{ values[t] };
+                            int bin{ std::isfinite(value) ? std::min(num_bins - 1, static_cast<int>((value - low) * scale)) : num_bins - 1 };
+
+                            ++histogram[bin];
+                        }
+                    }
+                }, 1);
+
+            measure->histogram.assign(num_bins, 0);
+
+            for (const auto& histogram : part_histogram)
+            {
+                for (int bin = 0; bin < num_bins; ++bin)
+                {
+                    measure->histogram[bin] += histogram[bin];
+                }
+            }
+        }
+
+        // Each part keeps its num_worst smallest angles in a max heap then the parts are merged
+        std::vector<std::vector<std::pair<float, int>>> part_worst(num_parts);
+
+        parallel_for(0, num_parts, [&](int begin, int end)
+            {
+                for (int part = begin; part < end; ++part)
+                {
+                    std::priority_queue<std::pair<float, int>> heap{};
+
+                    size_t first{ part * part_size };
+                    size_t last{ std::min(num_triangles, first + part_size) };
+
+                    for (size_t t = first; t < last && max_worst > 0; ++t)
+                    {
+                        std::pair<float, int> entry{ report.min_angle.values[t], static_cast<int>(t) };
+
+                        if (heap.size() < max_worst)
+                        {
+                            heap.push(entry);
+                        }
+                        else if (entry < heap.top())
+                        {
+                            heap.pop();
+                            heap.push(entry);
+                        }
+                    }
+
+                    for (; !heap.empty(); heap.pop())
+                    {
+                        part_worst[part].push_back(heap.top());
+                    }
+                }
+            }, 1);
+
+        std::vector<std::pair<float, int>> worst{};
+        for (const auto& part : part_worst)
+        {
+            worst.insert(worst.end(), part.begin(), part.end());
+        }
+
+        std::sort(worst.begin(), worst.end());
+        worst.resize(std::min(worst.size(), max_worst));
+
+        for (auto entry : worst)
+        {
+            report.worst.push_back(entry.second);
+        }
+
+        return report;
+    }
+
+    QualityReport measure_quality(const std::vector<Point3D>& points, const std::vector<std::array<int, 3>>& triangles, int num_bins, int num_worst)
+    {
+        return measure_triangles(triangles.size(), [&](size_t t, int k) { return points[triangles[t][k]]; }, num_bins, num_worst);
+    }
+
+    QualityReport measure_quality(const SurfaceMeshData& mesh, int num_bins, int num_worst)
+    {
+        const auto& vertices{ mesh.get_vertices() };
+        const auto& indices{ mesh.get_indices() };
+
+        return measure_triangles(indices.size() / 3, [&](size_t t, int k)
+            {
+                const SMVertex& vertex{ vertices[indices[3 * t + k]] };
+                return Point3D{ vertex.x, vertex.y, vertex.z };
+            }, num_bins, num_worst);
+    }
+}
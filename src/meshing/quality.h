@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+
+#include "mesh.h"
+#include "surfacemeshdata.h"
+
+namespace moodysim
+{
+    // One quality measure over all triangles
+    struct QualityMeasure
+    {
+        // Value for each triangle (infinite for degenerate triangles where the measure is undefined)
+        std::vector<float> values{};
+
+        // Summary of the finite values
+        float min{}, max{}, mean{};
+
+        // Counts over [min, max] split into equal bins, non-finite values go in the last bin
+        std::vector<size_t> histogram{};
+    };
+
+    struct QualityReport
+    {
+        // Angles in degrees
+        QualityMeasure min_angle{};
+        QualityMeasure max_angle{};
+
+        // Longest edge over shortest altitude scaled so an equilateral triangle is 1
+        QualityMeasure aspect_ratio{};
+
+        QualityMeasure area{};
+
+        // Circumradius over shortest edge (1 / sqrt(3) for equilateral)
+        QualityMeasure radius_edge_ratio{};
+
+        // Triangles with the smallest minimum angle, worst first
+        std::vector<int> worst{};
+    };
+
+    // Measure every triangle in parallel, angles use a polynomial arccosine accurate to about 0.004 degrees
+    // num_bins below 1 is taken as 1 and num_worst below 0 as 0
+    QualityReport measure_quality(const std::vector<Point3D>& points, const std::vector<std::array<int, 3>>& triangles, int num_bins = 20, int num_worst = 10);
+
+    QualityReport measure_quality(const SurfaceMeshData& mesh, int num_bins = 20, int num_worst = 10);
+}
@@ -0,0 +1,574 @@
+#include "sampling.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    // Candidates tried around an active point before it is retired (Bridson)
+    static constexpr int poisson_attempts{ 30 };
+
+    // Width of a parallel tile in grid cells, tiles filled together are this far apart
+    // which must exceed the two cells read around each candidate
+    static constexpr int poisson_tile_cells{ 32 };
+
+    // Cells of size min_distance / sqrt(2) hold at most one point so a candidate only
+    // has to be compared with the points in the 5 by 5 cells around it
+    struct PoissonGrid
+    {
+        float xmin{}, ymin{};
+        float cell_size{};
+        int nx{}, ny{};
+
+        std::vector<Point3D> cells{};
+        std::vector<char> occupied{};
+
+        int cell_x(float x) const { return std::clamp(static_cast<int>((x - xmin) / cell_size), 0, nx - 1); }
+        int cell_y(float y) const { return std::clamp(static_cast<int>((y - ymin) / cell_size), 0, ny - 1); }
+
+        bool check(Point3D point, float sqr_distance) const
+        {
+            int cx{ cell_x(point.x) };
+            int cy{ cell_y(point.y) };
+
+            for (int j = std::max(0, cy - 2); j <= std::min(ny - 1, cy + 2); ++j)
+            {
+                for (int i = std::max(0, cx - 2); i <= std::min(nx - 1, cx + 2); ++i)
+                {
+                    size_t cell{ static_cast<size_t>(j) * nx + i };
+
+                    if (occupied[cell] != 0)
+                    {
+                        float dx{ cells[cell].x - point.x };
+                        float dy{ cells[cell].y - point.y };
+
+                        if (dx * dx + dy * dy < sqr_distance)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        void insert(Point3D point)
+        {
+            size_t cell{ static_cast<size_t>(cell_y(point.y)) * nx + cell_x(point.x) };
+
+            cells[cell] = point;
+            occupied[cell] = 1;
+        }
+    };
+
+    // Rectangle of cells [i0, i1) x [j0, j1) filled by one thread
+    struct PoissonTile
+    {
+        int i0{}, j0{}, i1{}, j1{};
+    };
+
+    // Grow points from the active list with candidates restricted to tile, then throw darts
+    // at the tile until poisson_attempts in a row fail so parts not reached from the active list are filled too
+    template <typename Inside>
+    static void fill_tile(PoissonGrid& grid, const PoissonTile& tile, Inside&& inside, float min_distance,
+        std::vector<Point3D>& active, std::vector<Point3D>& points, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+
+        float x0{ grid.xmin + tile.i0 * grid.cell_size };
+        float y0{ grid.ymin + tile.j0 * grid.cell_size };
+        float x1{ grid.xmin + tile.i1 * grid.cell_size };
+        float y1{ grid.ymin + tile.j1 * grid.cell_size };
+
+        float sqr_distance{ min_distance * min_distance };
+
+        auto accept = [&](Point3D candidate)
+            {
+                if (candidate.x < x0 || candidate.x >= x1 || candidate.y < y0 || candidate.y >= y1)
+                {
+                    return false;
+                }
+
+                if (!inside(candidate.x, candidate.y) || !grid.check(candidate, sqr_distance))
+                {
+                    return false;
+                }
+
+                grid.insert(candidate);
+                points.push_back(candidate);
+                active.push_back(candidate);
+
+                return true;
+            };
+
+        auto grow = [&]()
+            {
+                while (!active.empty())
+                {
+                    size_t index{ static_cast<size_t>(unit(rng) * active.size()) };
+                    index = std::min(index, active.size() - 1);
+
+                    Point3D center{ active[index] };
+                    bool found{ false };
+
+                    // Uniform over the annulus between min_distance and twice that
+                    for (int attempt = 0; attempt < poisson_attempts && !found; ++attempt)
+                    {
+                        float angle{ 6.2831853f * unit(rng) };
+                        float distance{ min_distance * std::sqrt(1.f + 3.f * unit(rng)) };
+
+                        found = accept({ center.x + distance * std::cos(angle), center.y + distance * std::sin(angle), 0.f });
+                    }
+
+                    if (!found)
+                    {
+                        active[index] = active.back();
+                        active.pop_back();
+                    }
+                }
+            };
+
+        grow();
+
+        for (int failures = 0; failures < poisson_attempts;)
+        {
+            Point3D dart{ x0 + (x1 - x0) * unit(rng), y0 + (y1 - y0) * unit(rng), 0.f };
+
+            if (accept(dart))
+            {
+                grow();
+                failures = 0;
+            }
+            else
+            {
+                ++failures;
+            }
+        }
+    }
+
+    // Sample the box starting from the fixed points, tile_cells wide tiles are filled in parallel
+    template <typename Inside>
+    static std::vector<Point3D> sample_poisson_disk(Inside&& inside, float xmin, float ymin, float xmax, float ymax,
+        float min_distance, unsigned int seed, const std::vector<Point3D>& fixed, int tile_cells)
+    {
+        PoissonGrid grid{};
+
+        grid.xmin = xmin;
+        grid.ymin = ymin;
+        grid.cell_size = min_distance / std::sqrt(2.f);
+        grid.nx = std::max(1, static_cast<int>(std::ceil((xmax - xmin) / grid.cell_size)));
+        grid.ny = std::max(1, static_cast<int>(std::ceil((ymax - ymin) / grid.cell_size)));
+        grid.cells.resize(static_cast<size_t>(grid.nx) * grid.ny);
+        grid.occupied.assign(grid.cells.size(), 0);
+
+        for (auto point : fixed)
+        {
+            grid.insert(point);
+        }
+
+        int tiles_x{ (grid.nx + tile_cells - 1) / tile_cells };
+        int tiles_y{ (grid.ny + tile_cells - 1) / tile_cells };
+
+        std::vector<std::vector<Point3D>> tile_points(static_cast<size_t>(tiles_x) * tiles_y);
+
+        // Tiles of one phase have even or odd coordinates in both directions so they never touch
+        for (int phase = 0; phase < 4; ++phase)
+        {
+            std::vector<int> tiles{};
+
+            for (int ty = phase / 2; ty < tiles_y; ty += 2)
+            {
+                for (int tx = phase % 2; tx < tiles_x; tx += 2)
+                {
+                    tiles.push_back(ty * tiles_x + tx);
+                }
+            }
+
+            parallel_for(0, static_cast<int>(tiles.size()), [&](int begin, int end)
+                {
+                    std::vector<Point3D> active{};
+
+                    for (int n = begin; n < end; ++n)
+                    {
+                        int index{ tiles[n] };
+                        int tx{ index % tiles_x };
+                        int ty{ index / tiles_x };
+
+                        PoissonTile tile{ tx * tile_cells, ty * tile_cells, std::min(grid.nx, (tx + 1) * tile_cells), std::min(grid.ny, (ty + 1) * tile_cells) };
+
+                        // Continue from the points already placed within two cells of the tile
+                        // (neighboring tiles or fixed points) so the seams are filled like the rest
+                        active.clear();
+
+                        for (int j = std::max(0, tile.j0 - 2); j < std::min(grid.ny, tile.j1 + 2); ++j)
+                        {
+                            for (int i = std::max(0, tile.i0 - 2); i < std::min(grid.nx, tile.i1 + 2); ++i)
+                            {
+                                size_t cell{ static_cast<size_t>(j) * grid.nx + i };
+
+                                if (grid.occupied[cell] != 0)
+                                {
+                                    active.push_back(grid.cells[cell]);
+                                }
+                            }
+                        }
+
+                        std::mt19937 rng{ seed * 2654435761u + static_cast<unsigned int>(index) };
+
+                        fill_tile(grid, tile, inside, min_distance, active, tile_points[index], rng);
+                    }
+                }, 1);
+        }
+
+        std::vector<Point3D> points{ fixed };
+
+        for (const auto& tile : tile_points)
+        {
+            points.insert(points.end(), tile.begin(), tile.end());
+        }
+
+        return points;
+    }
+
+    // Sorted x intervals where the horizontal line at y is inside the polygon (even-odd rule)
+    static void polygon_intervals(const std::vector<Point3D>& polygon, float y, std::vector<float>& crossings, std::vector<std::array<float, 2>>& intervals)
+    {
+        crossings.clear();
+        intervals.clear();
+
+        for (size_t k = 0; k < polygon.size(); ++k)
+        {
+            Point3D p{ polygon[k] };
+            Point3D q{ polygon[(k + 1) % polygon.size()] };
+
+            // Half open in y so a line through a vertex counts it once
+            if ((p.y <= y && y < q.y) || (q.y <= y && y < p.y))
+            {
+                crossings.push_back(p.x + (y - p.y) * (q.x - p.x) / (q.y - p.y));
+            }
+        }
+
+        std::sort(crossings.begin(), crossings.end());
+
+        for (size_t k = 0; k + 1 < crossings.size(); k += 2)
+        {
+            intervals.push_back({ crossings[k], crossings[k + 1] });
+        }
+    }
+
+    // Keep the parts of intervals that are also inside other, both sorted and disjoint
+    static void intersect_intervals(std::vector<std::array<float, 2>>& intervals, const std::vector<std::array<float, 2>>& other)
+    {
+        std::vector<std::array<float, 2>> result{};
+
+        for (size_t a = 0, b = 0; a < intervals.size() && b < other.size();)
+        {
+            float low{ std::max(intervals[a][0], other[b][0]) };
+            float high{ std::min(intervals[a][1], other[b][1]) };
+
+            if (low < high)
+            {
+                result.push_back({ low, high });
+            }
+
+            (intervals[a][1] < other[b][1]) ? ++a : ++b;
+        }
+
+        intervals = std::move(result);
+    }
+
+    // Points spaced about spacing apart along the segment from a to b, not including b
+    static void sample_segment(Point3D a, Point3D b, float spacing, std::vector<Point3D>& points)
+    {
+        float dx{ b.x - a.x };
+        float dy{ b.y - a.y };
+
+        int count{ std::max(1, static_cast<int>(std::round(std::sqrt(dx * dx + dy * dy) / spacing))) };
+
+        for (int i = 0; i < count; ++i)
+        {
+            float t{ static_cast<float>(i) / count };
+            points.push_back({ a.x + t * dx, a.y + t * dy, 0.f });
+        }
+    }
+
+    std::vector<Point3D> generate_lattice_points(const LatticeShape& shape, float spacing, bool perimeter)
+    {
+        if (spacing <= 0.f)
+        {
+            std::cerr << "Error: lattice spacing must be positive" << std::endl;
+            return {};
+        }
+
+        if ((shape.type == LatticeShapeType::Polygon && shape.polygon.size() < 3) || (shape.type == LatticeShapeType::DistanceField && !shape.distance))
+        {
+            std::cerr << "Error: lattice shape is missing its polygon or distance function" << std::endl;
+            return {};
+        }
+
+        float xmin{ shape.xmin };
+        float ymin{ shape.ymin };
+        float xmax{ shape.xmax };
+        float ymax{ shape.ymax };
+
+        if (shape.type == LatticeShapeType::Circle)
+        {
+            xmin = shape.cx - shape.radius;
+            ymin = shape.cy - shape.radius;
+            xmax = shape.cx + shape.radius;
+            ymax = shape.cy + shape.radius;
+        }
+        else if (shape.type == LatticeShapeType::Polygon)
+        {
+            xmin = ymin = std::numeric_limits<float>::max();
+            xmax = ymax = std::numeric_limits<float>::lowest();
+
+            for (auto vertex : shape.polygon)
+            {
+                xmin = std::min(xmin, vertex.x);
+                ymin = std::min(ymin, vertex.y);
+                xmax = std::max(xmax, vertex.x);
+                ymax = std::max(ymax, vertex.y);
+            }
+        }
+
+        // Lattice points closer than this to the boundary would make slivers with the perimeter points
+        float margin{ perimeter && shape.type != LatticeShapeType::DistanceField ? 0.5f * spacing : 0.f };
+
+        // Odd rows are shifted half a spacing, the lattice is centered in the box
+        float row_spacing{ 0.8660254f * spacing };
+        int rows{ static_cast<int>((ymax - ymin) / row_spacing) + 1 };
+        int columns{ static_cast<int>((xmax - xmin) / spacing) + 1 };
+
+        float y0{ ymin + 0.5f * ((ymax - ymin) - (rows - 1) * row_spacing) };
+        float x0{ xmin + 0.5f * ((xmax - xmin) - (columns - 1) * spacing) };
+
+        auto row_y = [&](int j) { return y0 + j * row_spacing; };
+        auto row_x = [&](int j) { return x0 + (j % 2 == 1 ? 0.5f * spacing : 0.f); };
+
+        // Counting pass finds the runs of lattice indices [first, last) inside the shape in each row
+        std::vector<std::vector<std::array<int, 2>>> spans(rows);
+        std::vector<size_t> offsets(rows + 1, 0);
+
+        parallel_for(0, rows, [&](int begin, int end)
+            {
+                std::vector<float> crossings{};
+                std::vector<std::array<float, 2>> intervals{};
+                std::vector<std::array<float, 2>> other{};
+
+                for (int j = begin; j < end; ++j)
+                {
+                    float y{ row_y(j) };
+                    float x_first{ row_x(j) };
+
+                    intervals.clear();
+
+                    switch (shape.type)
+                    {
+                    case LatticeShapeType::Circle:
+                    {
+                        float dy{ y - shape.cy };
+                        float inner{ shape.radius - margin };
+
+                        if (dy * dy < inner * inner)
+                        {
+                            float half{ std::sqrt(inner * inner - dy * dy) };
+                            intervals.push_back({ shape.cx - half, shape.cx + half });
+                        }
+
+                        break;
+                    }
+                    case LatticeShapeType::Rectangle:
+                    {
+                        if (y >= ymin + margin && y <= ymax - margin)
+                        {
+                            intervals.push_back({ xmin + margin, xmax - margin });
+                        }
+
+                        break;
+                    }
+                    case LatticeShapeType::Polygon:
+                    {
+                        // Shrink the intervals of this line and the lines margin above and below
+                        // which keeps points about margin away from the edges in every direction
+                        polygon_intervals(shape.polygon, y, crossings, intervals);
+
+                        for (float dy : { -margin, margin })
+                        {
+                            if (dy != 0.f)
+                            {
+                                polygon_intervals(shape.polygon, y + dy, crossings, other);
+                                intersect_intervals(intervals, other);
+                            }
+                        }
+
+                        for (auto& interval : intervals)
+                        {
+                            interval = { interval[0] + margin, interval[1] - margin };
+                        }
+
+                        break;
+                    }
+                    case LatticeShapeType::DistanceField:
+                    {
+                        // Runs of lattice points where the distance is negative
+                        for (int i = 0; i < columns;)
+                        {
+                            while (i < columns && shape.distance(x_first + i * spacing, y) >= 0.f)
+                            {
+                                ++i;
+                            }
+
+                            int first{ i };
+
+                            while (i < columns && shape.distance(x_first + i * spacing, y) < 0.f)
+                            {
+                                ++i;
+                            }
+
+                            if (first < i)
+                            {
+                                spans[j].push_back({ first, i });
+                            }
+                        }
+
+                        break;
+                    }
+                    }
+
+                    for (auto interval : intervals)
+                    {
+                        int first{ std::max(0, static_cast<int>(std::ceil((interval[0] - x_first) / spacing))) };
+                        int last{ std::min(columns, static_cast<int>(std::floor((interval[1] - x_first) / spacing)) + 1) };
+
+                        if (first < last)
+                        {
+                            spans[j].push_back({ first, last });
+                        }
+                    }
+
+                    for (auto span : spans[j])
+                    {
+                        offsets[j + 1] += span[1] - span[0];
+                    }
+                }
+            }, 16);
+
+        for (int j = 0; j < rows; ++j)
+        {
+            offsets[j + 1] += offsets[j];
+        }
+
+        // Perimeter points step around circles with a rotation so there is one cosine and sine in total
+        std::vector<Point3D> boundary{};
+
+        if (perimeter)
+        {
+            if (shape.type == LatticeShapeType::Circle)
+            {
+                int count{ std::max(3, static_cast<int>(std::round(6.283185307179586 * shape.radius / spacing))) };
+
+                double cosine{ std::cos(6.283185307179586 / count) };
+                double sine{ std::sin(6.283185307179586 / count) };
+                double x{ shape.radius };
+                double y{ 0.0 };
+
+                for (int i = 0; i < count; ++i)
+                {
+                    boundary.push_back({ shape.cx + static_cast<float>(x), shape.cy + static_cast<float>(y), 0.f });
+
+                    double next_x{ cosine * x - sine * y };
+                    y = sine * x + cosine * y;
+                    x = next_x;
+                }
+            }
+            else if (shape.type == LatticeShapeType::Rectangle)
+            {
+                Point3D corners[4]{ { xmin, ymin, 0.f }, { xmax, ymin, 0.f }, { xmax, ymax, 0.f }, { xmin, ymax, 0.f } };
+
+                for (int k = 0; k < 4; ++k)
+                {
+                    sample_segment(corners[k], corners[(k + 1) % 4], spacing, boundary);
+                }
+            }
+            else if (shape.type == LatticeShapeType::Polygon)
+            {
+                for (size_t k = 0; k < shape.polygon.size(); ++k)
+                {
+                    sample_segment(shape.polygon[k], shape.polygon[(k + 1) % shape.polygon.size()], spacing, boundary);
+                }
+            }
+        }
+
+        std::vector<Point3D> points(offsets[rows] + boundary.size());
+
+        // Each row writes its own block so the rows are filled in parallel without push_back
+        parallel_for(0, rows, [&](int begin, int end)
+            {
+                for (int j = begin; j < end; ++j)
+                {
+                    Point3D* out{ points.data() + offsets[j] };
+
+                    float y{ row_y(j) };
+                    float x_first{ row_x(j) };
+
+                    for (auto span : spans[j])
+                    {
+                        for (int i = span[0]; i < span[1]; ++i)
+                        {
+                            *out++ = { x_first + i * spacing, y, 0.f };
+                        }
+                    }
+                }
+            }, 16);
+
+        std::copy(boundary.begin(), boundary.end(), points.begin() + offsets[rows]);
+
+        return points;
+    }
+
+    std::vector<Point3D> generate_poisson_disk_points(float radius, float min_distance, unsigned int seed)
+    {
+        if (radius <= 0.f || min_distance <= 0.f)
+        {
+            std::cerr << "Error: Poisson disk sampling needs a positive radius and distance" << std::endl;
+            return {};
+        }
+
+        // Perimeter points with chords no shorter than min_distance
+        std::vector<Point3D> perimeter{};
+
+        int perimeter_size{ min_distance >= 2.f * radius ? 1 : static_cast<int>(3.14159265f / std::asin(0.5f * min_distance / radius)) };
+
+        for (int i = 0; i < perimeter_size; ++i)
+        {
+            float angle{ 6.2831853f * i / perimeter_size };
+            perimeter.push_back({ radius * std::cos(angle), radius * std::sin(angle), 0.f });
+        }
+
+        float sqr_radius{ radius * radius };
+        auto inside = [sqr_radius](float x, float y) { return x * x + y * y <= sqr_radius; };
+
+        // A single tile covering the circle keeps this the serial O(n) algorithm
+        return sample_poisson_disk(inside, -radius, -radius, radius, radius, min_distance, seed, perimeter, 1 << 30);
+    }
+
+    std::vector<Point3D> generate_poisson_disk_points(const std::function<bool(float, float)>& inside,
+        float xmin, float ymin, float xmax, float ymax, float min_distance, unsigned int seed)
+    {
+        if (min_distance <= 0.f || xmax <= xmin || ymax <= ymin)
+        {
+            std::cerr << "Error: Poisson disk sampling needs a positive distance and a non-empty box" << std::endl;
+            return {};
+        }
+
+        return sample_poisson_disk(inside, xmin, ymin, xmax, ymax, min_distance, seed, {}, poisson_tile_cells);
+    }
+}
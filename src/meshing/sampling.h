@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "mesh.h"
+
+namespace moodysim
+{
+    // Kind of domain filled by generate_lattice_points
+    enum class LatticeShapeType
+    {
+        Circle,
+        Rectangle,
+        Polygon,
+        DistanceField
+    };
+
+    // Domain filled by generate_lattice_points, only the fields of the chosen type are used
+    struct LatticeShape
+    {
+        LatticeShapeType type{ LatticeShapeType::Circle };
+
+        // Circle
+        float cx{}, cy{};
+        float radius{ 1.f };
+
+        // Rectangle, or the box searched for the distance field
+        float xmin{ -1.f }, ymin{ -1.f }, xmax{ 1.f }, ymax{ 1.f };
+
+        // Polygon vertices in order (either orientation), the last connects back to the first
+        std::vector<Point3D> polygon{};
+
+        // Signed distance to the boundary, negative inside
+        std::function<float(float, float)> distance{};
+    };
+
+    // Hexagonal lattice of the given spacing filling shape, with perimeter set the boundary also gets points
+    // about spacing apart and lattice points within half a spacing of it are left out (distance fields have no perimeter)
+    // Rows are filled in parallel at offsets from a counting pass that finds the spans of each row inside the shape
+    std::vector<Point3D> generate_lattice_points(const LatticeShape& shape, float spacing, bool perimeter = true);
+
+    // Points at least min_distance apart filling the circle of the given radius (Bridson)
+    // Points are placed around the perimeter first then grown inward one at a time using a background grid
+    // Unlike the lattice of generate_sample_points no four points are co-circular so the triangulation has no ties
+    std::vector<Point3D> generate_poisson_disk_points(float radius, float min_distance, unsigned int seed = 0);
+
+    // Points at least min_distance apart filling the part of the box where inside(x, y) is true
+    // The box is cut into square tiles filled in parallel in four phases so tiles filled
+    // at the same time are a tile apart and never see each other's points
+    // The result only depends on seed, not on the number of threads
+    std::vector<Point3D> generate_poisson_disk_points(const std::function<bool(float, float)>& inside,
+        float xmin, float ymin, float xmax, float ymax, float min_distance, unsigned int seed = 0);
+}
@@ -0,0 +1,63 @@
+#include "sizefield.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace moodysim
+{
+    SizeField::SizeField(std::vector<float> values, int nx, int ny, float xmin, float ymin, float xmax, float ymax)
+        : values_(std::move(values)), nx_(nx), ny_(ny), xmin_(xmin), ymin_(ymin), xmax_(xmax), ymax_(ymax)
+    {
+        // An axis with a single sample never divides by its extent
+        bool valid_x{ nx_ == 1 || (nx_ > 1 && xmax_ > xmin_) };
+        bool valid_y{ ny_ == 1 || (ny_ > 1 && ymax_ > ymin_) };
+
+        if (!valid_x || !valid_y || values_.size() != static_cast<size_t>(nx_) * ny_)
+        {
+            std::cerr << "Error: Size field grid of " << nx << " by " << ny << " does not match its "
+                << values_.size() << " values or extent" << std::endl;
+            values_.clear();
+        }
+    }
+
+    float SizeField::operator()(float x, float y) const
+    {
+        if (function_)
+        {
+            return function_(x, y);
+        }
+
+        if (values_.empty())
+        {
+            return std::numeric_limits<float>::max();
+        }
+
+        // Position in grid cells clamped to the grid
+        float u{ nx_ > 1 ? (x - xmin_) / (xmax_ - xmin_) * (nx_ - 1) : 0.f };
+        float v{ ny_ > 1 ? (y - ymin_) / (ymax_ - ymin_) * (ny_ - 1) : 0.f };
+
+        u = std::clamp(u, 0.f, static_cast<float>(nx_ - 1));
+        v = std::clamp(v, 0.f, static_cast<float>(ny_ - 1));
+
+        // The cell starts at most one sample before the last, which for a single sample is the sample itself
+        int i{ std::min(static_cast<int>(u), std::max(nx_ - 2, 0)) };
+        int j{ std::min(static_cast<int>(v), std::max(ny_ - 2, 0)) };
+
+        int next_i{ std::min(i + 1, nx_ - 1) };
+        int next_j{ std::min(j + 1, ny_ - 1) };
+
+        float fu{ u - i };
+        float fv{ v - j };
+
+        float h00{ values_[j * nx_ + i] };
+        float h10{ values_[j * nx_ + next_i] };
+        float h01{ values_[next_j * nx_ + i] };
+        float h11{ values_[next_j * nx_ + next_i] };
+
+        float bottom{ h00 + fu * (h10 - h00) };
+        float top{ h01 + fu * (h11 - h01) };
+
+        return bottom + fv * (top - bottom);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+namespace moodysim
+{
+    // Target element size over the domain given either by a callable h(x, y)
+    // or by values on a regular grid that are interpolated bilinearly
+    class SizeField
+    {
+    public:
+
+        explicit SizeField(std::function<float(float, float)> function)
+            : function_(std::move(function))
+        {}
+
+        // values holds nx * ny samples row by row starting at (xmin, ymin)
+        // points outside the grid use the nearest edge of the grid, a single row or column is constant across it
+        // A grid that does not match its values or has an empty extent is reported and gives no size limit
+        SizeField(std::vector<float> values, int nx, int ny, float xmin, float ymin, float xmax, float ymax);
+
+        float operator()(float x, float y) const;
+
+    private:
+
+        std::function<float(float, float)> function_{};
+
+        std::vector<float> values_{};
+        int nx_{}, ny_{};
+        float xmin_{}, ymin_{}, xmax_{}, ymax_{};
+    };
+}
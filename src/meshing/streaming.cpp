@@ -0,0 +1,328 @@
+#include "streaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    StreamingDelaunay::StreamingDelaunay(StreamingMeshSink& sink, float xmin, float ymin, float xmax, float ymax, int grid_size)
+        : sink_(sink), xmin_(xmin), ymin_(ymin), grid_size_(std::max(grid_size, 1))
+    {
+        cell_width_ = (xmax - xmin) / grid_size_;
+        cell_height_ = (ymax - ymin) / grid_size_;
+
+        // A box that is flat along an axis still needs cells of some size
+        cell_width_ = cell_width_ > 0.f ? cell_width_ : 1.f;
+        cell_height_ = cell_height_ > 0.f ? cell_height_ : 1.f;
+
+        finalized_.assign(grid_size_ * grid_size_, 0);
+        cell_point_.assign(grid_size_ * grid_size_, -1);
+
+        delaunay_.begin_streaming(xmin, ymin, xmax, ymax);
+        stream_index_.assign(delaunay_.get_points().size(), -1);
+    }
+
+    int StreamingDelaunay::cell_index(Point3D point) const
+    {
+        float last{ static_cast<float>(grid_size_ - 1) };
+
+        int i{ static_cast<int>(std::clamp((point.x - xmin_) / cell_width_, 0.f, last)) };
+        int j{ static_cast<int>(std::clamp((point.y - ymin_) / cell_height_, 0.f, last)) };
+
+        return j * grid_size_ + i;
+    }
+
+    void StreamingDelaunay::add_point(Point3D point)
+    {
+        int cell{ cell_index(point) };
+
+        // Points arrive close to the previous point of their cell so the walk from it is short
+        int near{ cell_point_[cell] != -1 ? cell_point_[cell] : last_point_ };
+        int p{ delaunay_.add_point(point, near) };
+
+        if (p != -1)
+        {
+            stream_index_.push_back(num_points_);
+            cell_point_[cell] = p;
+            last_point_ = p;
+        }
+
+        // A point that could not be inserted is still written so the indices match the stream
+        new_points_.push_back(point);
+        ++num_points_;
+
+        peak_triangles_ = std::max(peak_triangles_, delaunay_.get_triangles().size());
+        peak_points_ = std::max(peak_points_, delaunay_.get_points().size());
+    }
+
+    void StreamingDelaunay::finalize_cell(int cell)
+    {
+        if (cell < 0 || cell >= static_cast<int>(finalized_.size()))
+        {
+            return;
+        }
+
+        finalized_[cell] = 1;
+
+        if (delaunay_.get_triangles().size() >= eviction_threshold_)
+        {
+            evict(false);
+        }
+    }
+
+    void StreamingDelaunay::finish()
+    {
+        std::fill(finalized_.begin(), finalized_.end(), 1);
+        evict(true);
+    }
+
+    bool StreamingDelaunay::check_final(int tri, const std::vector<int>& open_cells) const
+    {
+        const auto& triangle{ delaunay_.get_triangles()[tri] };
+        const auto& points{ delaunay_.get_points() };
+
+        Point3D a{ points[triangle[0]] };
+        Point3D b{ points[triangle[1]] };
+        Point3D c{ points[triangle[2]] };
+
+        // Circumcircle in double since triangles on the super triangle have huge ones
+        double bx{ static_cast<double>(b.x) - a.x };
+        double by{ static_cast<double>(b.y) - a.y };
+        double cx{ static_cast<double>(c.x) - a.x };
+        double cy{ static_cast<double>(c.y) - a.y };
+
+        double sqr_b{ bx * bx + by * by };
+        double sqr_c{ cx * cx + cy * cy };
+        double d{ 2.0 * (bx * cy - by * cx) };
+
+        if (d == 0.0)
+        {
+            return false;
+        }
+
+        double ux{ (cy * sqr_b - by * sqr_c) / d };
+        double uy{ (bx * sqr_c - cx * sqr_b) / d };
+
+        double center_x{ a.x + ux };
+        double center_y{ a.y + uy };
+
+        // Widened a little so rounding never lets a circle reaching into an active cell through
+        double radius{ std::sqrt(ux * ux + uy * uy) * (1.0 + 1e-6) };
+
+        if (!std::isfinite(radius))
+        {
+            return false;
+        }
+
+        double last{ static_cast<double>(grid_size_ - 1) };
+
+        // Cells outside the box never get points so only the rows and columns inside it are checked
+        int first_row{ static_cast<int>(std::clamp(std::floor((center_y - radius - ymin_) / cell_height_), 0.0, last + 1.0)) };
+        int last_row{ static_cast<int>(std::clamp(std::floor((center_y + radius - ymin_) / cell_height_), -1.0, last)) };
+
+        for (int j = first_row; j <= last_row; ++j)
+        {
+            // Widest part of the circle across the row
+            double y0{ ymin_ + static_cast<double>(j) * cell_height_ };
+            double y1{ y0 + cell_height_ };
+            double dy{ center_y < y0 ? y0 - center_y : (center_y > y1 ? center_y - y1 : 0.0) };
+
+            if (dy > radius)
+            {
+                continue;
+            }
+
+            double half_width{ std::sqrt(radius * radius - dy * dy) };
+
+            int first_column{ static_cast<int>(std::clamp(std::floor((center_x - half_width - xmin_) / cell_width_), 0.0, last + 1.0)) };
+            int last_column{ static_cast<int>(std::clamp(std::floor((center_x + half_width - xmin_) / cell_width_), -1.0, last)) };
+
+            if (first_column > last_column)
+            {
+                continue;
+            }
+
+            const int* row{ open_cells.data() + j * (grid_size_ + 1) };
+
+            if (row[last_column + 1] - row[first_column] > 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void StreamingDelaunay::evict(bool all)
+    {
+        int num_triangles{ static_cast<int>(delaunay_.get_triangles().size()) };
+
+        std::vector<char> evict(num_triangles, all ? 1 : 0);
+
+        if (!all)
+        {
+            // Count the cells that are not finalized along each row so a span of a row is checked at once
+            std::vector<int> open_cells(grid_size_ * (grid_size_ + 1), 0);
+
+            for (int j = 0; j < grid_size_; ++j)
+            {
+                int* row{ open_cells.data() + j * (grid_size_ + 1) };
+
+                for (int i = 0; i < grid_size_; ++i)
+                {
+                    row[i + 1] = row[i] + (finalized_[j * grid_size_ + i] ? 0 : 1);
+                }
+            }
+
+            parallel_for(0, num_triangles, [&](int begin, int end)
+                {
+                    for (int t = begin; t < end; ++t)
+                    {
+                        evict[t] = check_final(t, open_cells) ? 1 : 0;
+                    }
+                });
+        }
+
+        std::vector<std::array<int, 3>> evicted{};
+        std::vector<int> point_remap{};
+
+        delaunay_.evict_triangles(evict, evicted, point_remap);
+
+        // Points go first so every triangle written indexes points the sink already has
+        if (!new_points_.empty())
+        {
+            sink_.write_points(new_points_);
+            new_points_.clear();
+        }
+
+        std::vector<std::array<std::int64_t, 3>> triangles{};
+        triangles.reserve(evicted.size());
+
+        for (const auto& triangle : evicted)
+        {
+            std::array<std::int64_t, 3> indices{ stream_index_[triangle[0]], stream_index_[triangle[1]], stream_index_[triangle[2]] };
+
+            // Triangles on the super triangle are not part of the mesh
+            if (indices[0] != -1 && indices[1] != -1 && indices[2] != -1)
+            {
+                triangles.push_back(indices);
+            }
+        }
+
+        if (!triangles.empty())
+        {
+            sink_.write_triangles(triangles);
+            num_triangles_written_ += static_cast<std::int64_t>(triangles.size());
+        }
+
+        // The remaining points kept their order so they only move toward the front
+        for (size_t v = 0; v < point_remap.size(); ++v)
+        {
+            if (point_remap[v] != -1)
+            {
+                stream_index_[point_remap[v]] = stream_index_[v];
+            }
+        }
+
+        stream_index_.resize(delaunay_.get_points().size());
+
+        for (auto& point : cell_point_)
+        {
+            point = point == -1 ? -1 : point_remap[point];
+        }
+
+        last_point_ = last_point_ == -1 ? -1 : point_remap[last_point_];
+
+        eviction_threshold_ = std::max(min_eviction_, 2 * delaunay_.get_triangles().size());
+    }
+
+    bool stream_triangulate(PointSource& source, StreamingMeshSink& sink, int grid_size)
+    {
+        if (!source.rewind())
+        {
+            std::cerr << "Error: A streamed triangulation has to read its point source more than once" << std::endl;
+            return false;
+        }
+
+        std::vector<Point3D> chunk{};
+        chunk.reserve(DelaunayGenerator::point_chunk_size);
+
+        // First pass finds the box
+        float xmin{ std::numeric_limits<float>::max() };
+        float ymin{ std::numeric_limits<float>::max() };
+        float xmax{ std::numeric_limits<float>::lowest() };
+        float ymax{ std::numeric_limits<float>::lowest() };
+
+        while (source.read(chunk, DelaunayGenerator::point_chunk_size) > 0)
+        {
+            for (auto point : chunk)
+            {
+                xmin = std::min(xmin, point.x);
+                ymin = std::min(ymin, point.y);
+                xmax = std::max(xmax, point.x);
+                ymax = std::max(ymax, point.y);
+            }
+
+            chunk.clear();
+        }
+
+        if (xmin > xmax)
+        {
+            return true;
+        }
+
+        StreamingDelaunay delaunay{ sink, xmin, ymin, xmax, ymax, grid_size };
+
+        // Second pass counts the points in each cell
+        std::vector<std::int64_t> remaining(delaunay.get_grid_size() * delaunay.get_grid_size(), 0);
+
+        source.rewind();
+
+        while (source.read(chunk, DelaunayGenerator::point_chunk_size) > 0)
+        {
+            for (auto point : chunk)
+            {
+                ++remaining[delaunay.cell_index(point)];
+            }
+
+            chunk.clear();
+        }
+
+        // Empty cells are finalized from the start
+        for (int cell = 0; cell < static_cast<int>(remaining.size()); ++cell)
+        {
+            if (remaining[cell] == 0)
+            {
+                delaunay.finalize_cell(cell);
+            }
+        }
+
+        // Third pass triangulates finalizing each cell after its last point
+        source.rewind();
+
+        while (source.read(chunk, DelaunayGenerator::point_chunk_size) > 0)
+        {
+            for (auto point : chunk)
+            {
+                int cell{ delaunay.cell_index(point) };
+
+                delaunay.add_point(point);
+
+                if (--remaining[cell] == 0)
+                {
+                    delaunay.finalize_cell(cell);
+                }
+            }
+
+            chunk.clear();
+        }
+
+        delaunay.finish();
+
+        return true;
+    }
+}
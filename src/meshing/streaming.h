@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.h"
+#include "pointsource.h"
+
+namespace moodysim
+{
+    // Receives the output of a StreamingDelaunay a batch at a time
+    class StreamingMeshSink
+    {
+    public:
+
+        virtual ~StreamingMeshSink() = default;
+
+        // Points in the order they were added, the first point of the first call has index 0
+        virtual void write_points(std::span<const Point3D> points) = 0;
+
+        // Counter-clockwise triangles indexing points that were already written
+        virtual void write_triangles(std::span<const std::array<std::int64_t, 3>> triangles) = 0;
+    };
+
+    // Delaunay triangulation of a point stream too large to hold in memory (Isenburg et al.)
+    // The box around the points is cut into a grid of cells and a cell is finalized once no more points
+    // will arrive in it. A triangle whose circumcircle only touches finalized cells (or the outside of the box)
+    // can no longer change so it is written to the sink and removed along with the points left without triangles,
+    // only the triangles along the front between finalized and active cells stay in memory
+    class StreamingDelaunay
+    {
+    public:
+
+        StreamingDelaunay(StreamingMeshSink& sink, float xmin, float ymin, float xmax, float ymax, int grid_size);
+
+        // The point must lie in the box and in a cell that is not finalized yet
+        void add_point(Point3D point);
+
+        // No more points will be added to the cell
+        void finalize_cell(int cell);
+
+        // Finalize every cell and write the remaining triangles, leaving out those on the super triangle
+        void finish();
+
+        // Cell of the grid containing point, j * grid_size + i for column i and row j
+        int cell_index(Point3D point) const;
+
+        int get_grid_size() const { return grid_size_; }
+        std::int64_t get_num_points() const { return num_points_; }
+        std::int64_t get_num_triangles_written() const { return num_triangles_written_; }
+        size_t get_num_resident_triangles() const { return delaunay_.get_triangles().size(); }
+        size_t get_peak_resident_triangles() const { return peak_triangles_; }
+        size_t get_peak_resident_points() const { return peak_points_; }
+
+        // Finalized triangles are only looked for once the resident triangles doubled since the last time
+        // and are at least min_triangles so the scans cost a constant amount per triangle
+        void set_min_eviction(size_t min_triangles)
+        {
+            min_eviction_ = min_triangles;
+            eviction_threshold_ = min_triangles;
+        }
+
+    private:
+
+        // Write and remove the finalized triangles, or every triangle when all is set
+        void evict(bool all);
+
+        // Check if the circumcircle of tri only covers finalized cells
+        // open_cells holds a running count of the cells not finalized along each row
+        bool check_final(int tri, const std::vector<int>& open_cells) const;
+
+        StreamingMeshSink& sink_;
+
+        DelaunayGenerator delaunay_{ std::vector<Point3D>{}, std::vector<Edge>{} };
+
+        float xmin_{}, ymin_{};
+        float cell_width_{}, cell_height_{};
+        int grid_size_{};
+
+        std::vector<char> finalized_{};
+
+        // Index of each resident point in the stream (-1 for the super triangle)
+        std::vector<std::int64_t> stream_index_{};
+
+        // Last resident point added to each cell (-1 for none) to start the walk to the next one from
+        std::vector<int> cell_point_{};
+        int last_point_{ -1 };
+
+        // Points added since the last write
+        std::vector<Point3D> new_points_{};
+
+        std::int64_t num_points_{ 0 };
+        std::int64_t num_triangles_written_{ 0 };
+
+        size_t min_eviction_{ 1 << 14 };
+        size_t eviction_threshold_{ 1 << 14 };
+        size_t peak_triangles_{ 0 };
+        size_t peak_points_{ 0 };
+    };
+
+    // Triangulate the points of source with a StreamingDelaunay, reading the source three times to find the box,
+    // to count the points in each cell, and to add the points finalizing each cell after its last point
+    // Memory stays small when nearby points are close together in the source
+    // Returns false if the source cannot be rewound
+    bool stream_triangulate(PointSource& source, StreamingMeshSink& sink, int grid_size = 64);
+}
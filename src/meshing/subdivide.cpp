@@ -0,0 +1,452 @@
+#include "subdivide.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <span>
+
+#include "parallel.h"
+
+namespace moodysim
+{
+    // Half-edge h = 3f + i runs from corner i to corner i + 1 of face f
+    static inline int next_half_edge(int h)
+    {
+        return h % 3 == 2 ? h - 2 : h + 1;
+    }
+
+    static inline int previous_half_edge(int h)
+    {
+        return h % 3 == 0 ? h + 2 : h - 1;
+    }
+
+    // Connectivity of one level, found by looking through the few half-edges leaving each vertex
+    // instead of hashing vertex pairs
+    struct SubdivisionTopology
+    {
+        // Half-edges leaving each vertex in compressed rows
+        std::vector<int> offsets{};
+        std::vector<int> outgoing{};
+
+        // Half-edge running the other way along the same edge (-1 on the boundary)
+        std::vector<int> twins{};
+
+        // Number of the edge under each half-edge, edges are numbered in order of the half-edge owning them
+        // (the lower of the two, or the only one on the boundary)
+        std::vector<int> edges{};
+        int num_edges{};
+    };
+
+    static SubdivisionTopology build_topology(std::span<const unsigned int> indices, int num_vertices)
+    {
+        SubdivisionTopology topology{};
+
+        int num_half_edges{ static_cast<int>(indices.size()) };
+
+        topology.offsets.assign(num_vertices + 1, 0);
+        topology.outgoing.resize(num_half_edges);
+        topology.twins.resize(num_half_edges);
+        topology.edges.resize(num_half_edges);
+
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    std::atomic_ref<int>{ topology.offsets[indices[h] + 1] }.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+        for (int v = 0; v < num_vertices; ++v)
+        {
+            topology.offsets[v + 1] += topology.offsets[v];
+        }
+
+        std::vector<int> cursor(topology.offsets.begin(), topology.offsets.end() - 1);
+
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    int slot{ std::atomic_ref<int>{ cursor[indices[h]] }.fetch_add(1, std::memory_order_relaxed) };
+                    topology.outgoing[slot] = h;
+                }
+            });
+
+        // Rows are filled in any order so sort them to keep the result independent of the threads
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    std::sort(topology.outgoing.begin() + topology.offsets[v], topology.outgoing.begin() + topology.offsets[v + 1]);
+                }
+            });
+
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    unsigned int a{ indices[h] };
+                    unsigned int b{ indices[next_half_edge(h)] };
+
+                    int twin{ -1 };
+
+                    for (int k = topology.offsets[b]; k < topology.offsets[b + 1] && twin == -1; ++k)
+                    {
+                        int g{ topology.outgoing[k] };
+                        twin = indices[next_half_edge(g)] == a ? g : -1;
+                    }
+
+                    topology.twins[h] = twin;
+                }
+            });
+
+        // Number the owned half-edges with a prefix sum over contiguous parts
+        int num_parts{ std::max(1, std::min(4 * thread_count(), num_half_edges / (1 << 14))) };
+        int part_size{ (num_half_edges + num_parts - 1) / num_parts };
+
+        std::vector<int> part_offsets(num_parts + 1, 0);
+
+        auto owned = [&](int h) { return topology.twins[h] == -1 || h < topology.twins[h]; };
+
+        parallel_for(0, num_parts, [&](int begin, int end)
+            {
+                for (int part = begin; part < end; ++part)
+                {
+                    int last{ std::min(num_half_edges, (part + 1) * part_size) };
+
+                    for (int h = part * part_size; h < last; ++h)
+                    {
+                        part_offsets[part + 1] += owned(h) ? 1 : 0;
+                    }
+                }
+            }, 1);
+
+        for (int part = 0; part < num_parts; ++part)
+        {
+            part_offsets[part + 1] += part_offsets[part];
+        }
+
+        topology.num_edges = part_offsets[num_parts];
+
+        parallel_for(0, num_parts, [&](int begin, int end)
+            {
+                for (int part = begin; part < end; ++part)
+                {
+                    int last{ std::min(num_half_edges, (part + 1) * part_size) };
+                    int edge{ part_offsets[part] };
+
+                    for (int h = part * part_size; h < last; ++h)
+                    {
+                        if (owned(h))
+                        {
+                            topology.edges[h] = edge++;
+                        }
+                    }
+                }
+            }, 1);
+
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    if (!owned(h))
+                    {
+                        topology.edges[h] = topology.edges[topology.twins[h]];
+                    }
+                }
+            });
+
+        return topology;
+    }
+
+    // Weighted sum of vertex positions and colors
+    struct VertexBlend
+    {
+        double x{}, y{}, z{};
+        double r{}, g{}, b{};
+
+        void add(const SMVertex& vertex, double weight)
+        {
+            x += weight * vertex.x;
+            y += weight * vertex.y;
+            z += weight * vertex.z;
+            r += weight * vertex.r;
+            g += weight * vertex.g;
+            b += weight * vertex.b;
+        }
+
+        SMVertex get() const
+        {
+            return SMVertex{
+                static_cast<float>(x), static_cast<float>(y), static_cast<float>(z),
+                static_cast<float>(r), static_cast<float>(g), static_cast<float>(b)
+            };
+        }
+    };
+
+    // Boundary neighbors of v, the ends of the boundary edges leaving and entering it (-1 for an interior vertex)
+    static void boundary_neighbors(int v, std::span<const unsigned int> indices, const SubdivisionTopology& topology, int& after, int& before)
+    {
+        after = -1;
+        before = -1;
+
+        for (int k = topology.offsets[v]; k < topology.offsets[v + 1]; ++k)
+        {
+            int h{ topology.outgoing[k] };
+            int previous{ previous_half_edge(h) };
+
+            if (topology.twins[h] == -1)
+            {
+                after = static_cast<int>(indices[next_half_edge(h)]);
+            }
+
+            if (topology.twins[previous] == -1)
+            {
+                before = static_cast<int>(indices[previous]);
+            }
+        }
+    }
+
+    // Midpoint and Loop levels add a vertex on each edge and split each triangle into 4
+    static SurfaceMeshData subdivide_edges(const SurfaceMeshData& mesh, bool smooth)
+    {
+        const auto& vertices{ mesh.get_vertices() };
+        const auto& indices{ mesh.get_indices() };
+
+        int num_vertices{ static_cast<int>(vertices.size()) };
+        int num_faces{ static_cast<int>(indices.size() / 3) };
+
+        SubdivisionTopology topology{ build_topology(indices, num_vertices) };
+
+        std::vector<SMVertex> new_vertices(num_vertices + topology.num_edges);
+        std::vector<unsigned int> new_indices(12 * static_cast<size_t>(num_faces));
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    int degree{ topology.offsets[v + 1] - topology.offsets[v] };
+
+                    if (!smooth || degree == 0)
+                    {
+                        new_vertices[v] = vertices[v];
+                        continue;
+                    }
+
+                    int after{};
+                    int before{};
+                    boundary_neighbors(v, indices, topology, after, before);
+
+                    VertexBlend blend{};
+
+                    if (after != -1 || before != -1)
+                    {
+                        // Boundary vertices follow the curve through their boundary neighbors
+                        blend.add(vertices[v], 0.75);
+                        blend.add(vertices[after != -1 ? after : v], 0.125);
+                        blend.add(vertices[before != -1 ? before : v], 0.125);
+                    }
+                    else
+                    {
+                        // Loop's weights with each neighbor at the end of one outgoing half-edge
+                        double cosine{ 0.375 + 0.25 * std::cos(2.0 * 3.14159265358979323846 / degree) };
+                        double beta{ (0.625 - cosine * cosine) / degree };
+
+                        blend.add(vertices[v], 1.0 - degree * beta);
+
+                        for (int k = topology.offsets[v]; k < topology.offsets[v + 1]; ++k)
+                        {
+                            blend.add(vertices[indices[next_half_edge(topology.outgoing[k])]], beta);
+                        }
+                    }
+
+                    new_vertices[v] = blend.get();
+                }
+            });
+
+        int num_half_edges{ static_cast<int>(indices.size()) };
+
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    int twin{ topology.twins[h] };
+
+                    if (twin != -1 && twin < h)
+                    {
+                        continue;
+                    }
+
+                    const SMVertex& a{ vertices[indices[h]] };
+                    const SMVertex& b{ vertices[indices[next_half_edge(h)]] };
+
+                    VertexBlend blend{};
+
+                    if (smooth && twin != -1)
+                    {
+                        // 3/8 of each end and 1/8 of each opposite corner
+                        blend.add(a, 0.375);
+                        blend.add(b, 0.375);
+                        blend.add(vertices[indices[previous_half_edge(h)]], 0.125);
+                        blend.add(vertices[indices[previous_half_edge(twin)]], 0.125);
+                    }
+                    else
+                    {
+                        blend.add(a, 0.5);
+                        blend.add(b, 0.5);
+                    }
+
+                    new_vertices[num_vertices + topology.edges[h]] = blend.get();
+                }
+            });
+
+        parallel_for(0, num_faces, [&](int begin, int end)
+            {
+                for (int f = begin; f < end; ++f)
+                {
+                    unsigned int a{ indices[3 * f] };
+                    unsigned int b{ indices[3 * f + 1] };
+                    unsigned int c{ indices[3 * f + 2] };
+
+                    unsigned int ab{ static_cast<unsigned int>(num_vertices + topology.edges[3 * f]) };
+                    unsigned int bc{ static_cast<unsigned int>(num_vertices + topology.edges[3 * f + 1]) };
+                    unsigned int ca{ static_cast<unsigned int>(num_vertices + topology.edges[3 * f + 2]) };
+
+                    // Corner triangles keep the orientation of the face, the middle one joins the new vertices
+                    unsigned int* out{ new_indices.data() + 12 * static_cast<size_t>(f) };
+
+                    out[0] = a; out[1] = ab; out[2] = ca;
+                    out[3] = b; out[4] = bc; out[5] = ab;
+                    out[6] = c; out[7] = ca; out[8] = bc;
+                    out[9] = ab; out[10] = bc; out[11] = ca;
+                }
+            });
+
+        return SurfaceMeshData{ std::move(new_vertices), std::move(new_indices) };
+    }
+
+    // Sqrt3 levels add a vertex at each face centroid and make one triangle per half-edge
+    static SurfaceMeshData subdivide_sqrt3(const SurfaceMeshData& mesh)
+    {
+        const auto& vertices{ mesh.get_vertices() };
+        const auto& indices{ mesh.get_indices() };
+
+        int num_vertices{ static_cast<int>(vertices.size()) };
+        int num_faces{ static_cast<int>(indices.size() / 3) };
+        int num_half_edges{ static_cast<int>(indices.size()) };
+
+        SubdivisionTopology topology{ build_topology(indices, num_vertices) };
+
+        std::vector<SMVertex> new_vertices(num_vertices + num_faces);
+        std::vector<unsigned int> new_indices(indices.size() * 3);
+
+        parallel_for(0, num_vertices, [&](int begin, int end)
+            {
+                for (int v = begin; v < end; ++v)
+                {
+                    int degree{ topology.offsets[v + 1] - topology.offsets[v] };
+
+                    int after{};
+                    int before{};
+                    boundary_neighbors(v, indices, topology, after, before);
+
+                    if (degree == 0 || after != -1 || before != -1)
+                    {
+                        new_vertices[v] = vertices[v];
+                        continue;
+                    }
+
+                    double alpha{ (4.0 - 2.0 * std::cos(2.0 * 3.14159265358979323846 / degree)) / 9.0 };
+
+                    VertexBlend blend{};
+                    blend.add(vertices[v], 1.0 - alpha);
+
+                    for (int k = topology.offsets[v]; k < topology.offsets[v + 1]; ++k)
+                    {
+                        blend.add(vertices[indices[next_half_edge(topology.outgoing[k])]], alpha / degree);
+                    }
+
+                    new_vertices[v] = blend.get();
+                }
+            });
+
+        parallel_for(0, num_faces, [&](int begin, int end)
+            {
+                for (int f = begin; f < end; ++f)
+                {
+                    VertexBlend blend{};
+
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        blend.add(vertices[indices[3 * f + i]], 1.0 / 3.0);
+                    }
+
+                    new_vertices[num_vertices + f] = blend.get();
+                }
+            });
+
+        // Half-edge a-b of face f with centroid m_f makes (b, m_f, m_g) when face g is across it
+        // so the pair of triangles over each old edge is its flip, boundary half-edges make (a, b, m_f)
+        parallel_for(0, num_half_edges, [&](int begin, int end)
+            {
+                for (int h = begin; h < end; ++h)
+                {
+                    int twin{ topology.twins[h] };
+
+                    unsigned int a{ indices[h] };
+                    unsigned int b{ indices[next_half_edge(h)] };
+                    unsigned int centroid{ static_cast<unsigned int>(num_vertices + h / 3) };
+
+                    unsigned int* out{ new_indices.data() + 3 * static_cast<size_t>(h) };
+
+                    if (twin == -1)
+                    {
+                        out[0] = a; out[1] = b; out[2] = centroid;
+                    }
+                    else
+                    {
+                        out[0] = b; out[1] = centroid; out[2] = static_cast<unsigned int>(num_vertices + twin / 3);
+                    }
+                }
+            });
+
+        return SurfaceMeshData{ std::move(new_vertices), std::move(new_indices) };
+    }
+
+    static SurfaceMeshData subdivide_level(const SurfaceMeshData& mesh, SubdivisionScheme scheme)
+    {
+        switch (scheme)
+        {
+        case SubdivisionScheme::Midpoint:
+            return subdivide_edges(mesh, false);
+        case SubdivisionScheme::Loop:
+            return subdivide_edges(mesh, true);
+        default:
+            return subdivide_sqrt3(mesh);
+        }
+    }
+
+    SurfaceMeshData subdivide(const SurfaceMeshData& mesh, SubdivisionScheme scheme, int levels)
+    {
+        if (mesh.get_indices().size() % 3 != 0)
+        {
+            std::cerr << "Error: mesh indices do not form whole triangles" << std::endl;
+            return mesh;
+        }
+
+        if (levels <= 0)
+        {
+            return mesh;
+        }
+
+        SurfaceMeshData result{ subdivide_level(mesh, scheme) };
+
+        for (int level = 1; level < levels; ++level)
+        {
+            result = subdivide_level(result, scheme);
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+
+#include "surfacemeshdata.h"
+
+namespace moodysim
+{
+    // Rule used to refine every triangle of a mesh
+    enum class SubdivisionScheme
+    {
+        Midpoint,  // Split each triangle into 4 at the edge midpoints, positions are unchanged
+        Loop,      // Split like Midpoint and smooth with the Loop weights (approximating, for smooth surfaces)
+        Sqrt3      // Insert each triangle centroid, smooth the old vertices, and flip the old edges (Kobbelt)
+    };
+
+    // Subdivide mesh levels times, each level multiplies the triangles by 4 (Midpoint and Loop) or 3 (Sqrt3)
+    // Boundary edges are split at their midpoint, Loop keeps boundary vertices on a cubic B-spline curve
+    // and Sqrt3 keeps them fixed, colors are blended like positions
+    SurfaceMeshData subdivide(const SurfaceMeshData& mesh, SubdivisionScheme scheme, int levels = 1);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "mesh.h"
+#include "asciipoints.h"
+
+// Write text to a file in the temporary directory and return its path
+std::string write_text_file(const std::string& name, const std::string& text)
+{
+    std::string path{ (std::filesystem::temp_directory_path() / name).string() };
+
+    std::ofstream file{ path, std::ios::binary };
+    file << text;
+
+    return path;
+}
+
+TEST(AsciiPoints, Xyz)
+{
+    using namespace moodysim;
+
+    std::string path{ write_text_file("points.xyz", "# scan\n1 2 3 7\n\n  -4.5\t+5e-1 6 8\r\n# end\n7 8 9 9") };
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    ASSERT_EQ(cloud.points.size(), 3);
+    EXPECT_EQ(cloud.points[1].x, -4.5f);
+    EXPECT_EQ(cloud.points[1].y, 0.5f);
+    EXPECT_EQ(cloud.points[1].z, 6.f);
+    EXPECT_EQ(cloud.points[2].z, 9.f);
+
+    ASSERT_EQ(cloud.attributes.size(), 1);
+    EXPECT_EQ(cloud.attributes[0][0], 7.f);
+    EXPECT_EQ(cloud.attributes[0][2], 9.f);
+
+    // A malformed line fails the whole load
+    path = write_text_file("points.xyz", "1 2 3\n4 5x 6\n");
+    EXPECT_FALSE(load_ascii_points(path, cloud));
+    EXPECT_TRUE(cloud.points.empty());
+
+    std::filesystem::remove(path);
+}
+
+TEST(AsciiPoints, Csv)
+{
+    using namespace moodysim;
+
+    // Columns picked by name in any order
+    std::string path{ write_text_file("points.csv", "id, \"Y\", X, intensity\n0, 1.5, 2.5, 10\n1, -1, -2, 20\n") };
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    ASSERT_EQ(cloud.points.size(), 2);
+    EXPECT_EQ(cloud.points[0].x, 2.5f);
+    EXPECT_EQ(cloud.points[0].y, 1.5f);
+    EXPECT_EQ(cloud.points[0].z, 0.f);
+    EXPECT_EQ(cloud.points[1].x, -2.f);
+
+    ASSERT_EQ(cloud.attribute_names.size(), 2);
+    EXPECT_EQ(cloud.attribute_names[1], "intensity");
+    EXPECT_EQ(cloud.attributes[0][1], 1.f);
+    EXPECT_EQ(cloud.attributes[1][1], 20.f);
+
+    // Without a header the columns are x, y, z
+    path = write_text_file("points.csv", "1,2,3\n4,5,6\n");
+    ASSERT_TRUE(load_ascii_points(path, cloud, AsciiPointFormat::Csv));
+
+    ASSERT_EQ(cloud.points.size(), 2);
+    EXPECT_EQ(cloud.points[1].z, 6.f);
+
+    std::filesystem::remove(path);
+}
+
+TEST(AsciiPoints, Ply)
+{
+    using namespace moodysim;
+
+    std::string text{
+        "ply\n"
+        "format ascii 1.0\n"
+        "comment made by hand\n"
+        "element camera 1\n"
+        "property float focal\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property uchar red\n"
+        "element face 1\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n"
+        "35\n"
+        "0 0 0 255\n"
+        "1 0 0 128\n"
+        "0 1 0.5 0\n"
+        "3 0 1 2\n" };
+
+    std::string path{ write_text_file("points.ply", text) };
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    ASSERT_EQ(cloud.points.size(), 3);
+    EXPECT_EQ(cloud.points[1].x, 1.f);
+    EXPECT_EQ(cloud.points[2].z, 0.5f);
+
+    ASSERT_EQ(cloud.attribute_names.size(), 1);
+    EXPECT_EQ(cloud.attribute_names[0], "red");
+    EXPECT_EQ(cloud.attributes[0][1], 128.f);
+
+    // Binary PLY is not text
+    path = write_text_file("points.ply", "ply\nformat binary_little_endian 1.0\nelement vertex 0\nend_header\n");
+    EXPECT_FALSE(load_ascii_points(path, cloud));
+
+    std::filesystem::remove(path);
+}
+
+TEST(AsciiPoints, RoundTrip)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected{ generate_sample_points(1.f, 100) };
+
+    std::string path{ (std::filesystem::temp_directory_path() / "points_round_trip.xyz").string() };
+
+    {
+        std::ofstream file{ path };
+        file.precision(9);
+
+        for (auto point : expected)
+        {
+            file << point.x << ' ' << point.y << ' ' << point.z << '\n';
+        }
+    }
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    // Nine significant digits round trip a float exactly
+    ASSERT_EQ(cloud.points.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), cloud.points.begin(), [](Point3D l, Point3D r) { return l.x == r.x && l.y == r.y && l.z == r.z; }));
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <filesystem>
+
+#include "mesh.h"
+#include "checkpoint.h"
+#include "surfacemeshdata.h"
+
+TEST(Checkpoint, ResumeTriangulation)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> points{ generate_sample_points(1.f, 20) };
+
+    DelaunayGenerator expected_gen{ points, {} };
+    expected_gen.triangulate();
+
+    // Keep every snapshot taken while triangulating
+    std::vector<DelaunayState> snapshots{};
+
+    DelaunayGenerator delaunay_gen{ points, {} };
+    delaunay_gen.set_checkpoint([&](const DelaunayGenerator& generator)
+        {
+            generator.get_state(snapshots.emplace_back());
+        }, 500);
+
+    delaunay_gen.triangulate();
+
+    ASSERT_EQ(snapshots.size(), points.size() / 500);
+    EXPECT_EQ(snapshots[2].next_point, 1500);
+    EXPECT_EQ(snapshots[2].num_input_points, points.size());
+
+    // A job preempted after the third snapshot picks up from the file and finishes the same way
+    std::string path{ (std::filesystem::temp_directory_path() / "delaunay.checkpoint").string() };
+
+    ASSERT_TRUE(write_checkpoint(path, snapshots[2]));
+
+    DelaunayState state{};
+    ASSERT_TRUE(read_checkpoint(path, state));
+
+    DelaunayGenerator resumed_gen{ std::move(state) };
+    resumed_gen.triangulate();
+
+    EXPECT_TRUE(resumed_gen.get_triangles() == expected_gen.get_triangles());
+    EXPECT_TRUE(resumed_gen.get_neighbors() == expected_gen.get_neighbors());
+    EXPECT_EQ(resumed_gen.get_edge_index().size(), expected_gen.get_edge_index().size());
+
+    // Not a checkpoint
+    std::filesystem::resize_file(path, 100);
+    EXPECT_FALSE(read_checkpoint(path, state));
+
+    std::filesystem::remove(path);
+}
+
+TEST(Checkpoint, AsynchronousWriter)
+{
+    using namespace moodysim;
+
+    // Square with constraints on its sides and a jittered interior
+    std::vector<Point3D> points{ { -1.f, -1.f, 0.f }, { 1.f, -1.f, 0.f }, { 1.f, 1.f, 0.f }, { -1.f, 1.f, 0.f } };
+    std::vector<Edge> edges{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+
+    for (int k = 0; k < 400; ++k)
+    {
+        points.push_back({ 0.95f * std::sin(1.7f * k), 0.95f * std::cos(2.3f * k + 0.5f), 0.f });
+    }
+
+    std::string path{ (std::filesystem::temp_directory_path() / "delaunay_async.checkpoint").string() };
+
+    DelaunayGenerator delaunay_gen{ points, edges };
+
+    {
+        CheckpointWriter writer{ path };
+
+        delaunay_gen.set_checkpoint([&](const DelaunayGenerator& generator) { writer.submit(generator); }, 100);
+
+        delaunay_gen.triangulate();
+        delaunay_gen.apply_constraint();
+
+        EXPECT_GT(delaunay_gen.refine(25.f), 0);
+        ASSERT_TRUE(writer.flush());
+
+        EXPECT_GT(writer.get_num_written(), 0);
+    }
+
+    // The last checkpoint was taken during refinement, resuming rebuilds the queue and finishes the job
+    DelaunayState state{};
+    ASSERT_TRUE(read_checkpoint(path, state));
+
+    EXPECT_EQ(state.num_input_points, -1);
+    EXPECT_LT(state.num_steiner_points, delaunay_gen.get_num_steiner_points());
+
+    DelaunayGenerator resumed_gen{ std::move(state) };
+    resumed_gen.refine(25.f);
+
+    double max_ratio{ 1.0 / (2.0 * std::sin(25.0 * 3.14159265358979 / 180.0)) };
+
+    bool refined{ true };
+    for (size_t t = 0; t < resumed_gen.get_triangles().size(); ++t)
+    {
+        refined = refined && resumed_gen.radius_edge_ratio(static_cast<int>(t)) <= max_ratio * 1.001;
+    }
+
+    EXPECT_TRUE(refined);
+
+    // The resumed job is exported without triangulating again
+    size_t num_triangles{ resumed_gen.get_triangles().size() };
+    SurfaceMeshData mesh{ resumed_gen.generate_delaunay_mesh() };
+
+    EXPECT_EQ(mesh.get_indices().size(), 3 * num_triangles);
+    EXPECT_EQ(mesh.get_vertices().size(), resumed_gen.get_points().size());
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "decimate.h"
+#include "surfacemeshdata.h"
+#include "meshfixtures.h"
+
+// Sum of the areas of the triangles projected onto the xy plane (negative for clockwise triangles)
+double projected_area(const moodysim::SurfaceMeshData& mesh, bool& all_counter_clockwise)
+{
+    const auto& vertices{ mesh.get_vertices() };
+    const auto& indices{ mesh.get_indices() };
+
+    double area{ 0.0 };
+    all_counter_clockwise = true;
+
+    for (size_t f = 0; f < indices.size(); f += 3)
+    {
+        const auto& a{ vertices[indices[f]] };
+        const auto& b{ vertices[indices[f + 1]] };
+        const auto& c{ vertices[indices[f + 2]] };
+
+        double twice_area{ (static_cast<double>(b.x) - a.x) * (c.y - a.y) - (static_cast<double>(b.y) - a.y) * (c.x - a.x) };
+
+        all_counter_clockwise = all_counter_clockwise && twice_area > 0.0;
+        area += 0.5 * twice_area;
+    }
+
+    return area;
+}
+
+TEST(Decimate, PlanarGrid)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_height_field(100, [](float, float) { return 0.f; }) };
+
+    MeshDecimator decimator{ mesh };
+    SurfaceMeshData result{ decimator.decimate(200) };
+
+    bool counter_clockwise{};
+    double area{ projected_area(result, counter_clockwise) };
+
+    EXPECT_LE(result.get_indices().size() / 3, 200);
+    EXPECT_LT(result.get_vertices().size(), mesh.get_vertices().size());
+    EXPECT_TRUE(counter_clockwise);
+
+    // The boundary of a flat mesh is kept so the area does not change
+    EXPECT_NEAR(area, 4.0, 1e-4);
+
+    // Every index refers to a vertex in the compacted mesh
+    for (auto index : result.get_indices())
+    {
+        EXPECT_LT(index, result.get_vertices().size());
+    }
+}
+
+TEST(Decimate, ErrorBound)
+{
+    using namespace moodysim;
+
+    // A ridge along x = 0 should keep its vertices while the flat sides collapse
+    auto height = [](float x, float) { return 0.5f * std::max(0.f, 0.5f - std::abs(x)); };
+
+    SurfaceMeshData mesh{ make_height_field(64, height) };
+
+    MeshDecimator decimator{ mesh };
+    SurfaceMeshData result{ decimator.decimate(0, 1e-8) };
+
+    bool counter_clockwise{};
+    double area{ projected_area(result, counter_clockwise) };
+
+    EXPECT_LT(result.get_indices().size(), mesh.get_indices().size() / 10);
+    EXPECT_TRUE(counter_clockwise);
+    EXPECT_NEAR(area, 4.0, 1e-4);
+
+    // Every remaining vertex is still on the surface
+    double worst{ 0.0 };
+    for (const auto& vertex : result.get_vertices())
+    {
+        worst = std::max(worst, static_cast<double>(std::abs(vertex.z - height(vertex.x, vertex.y))));
+    }
+
+    EXPECT_LT(worst, 1e-3);
+}
@@ -1,8 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
 #include "mesh.h"
+#include "pointsource.h"
 #include "graphics.h"
 #include "surfacemeshdata.h"
+#include "meshfixtures.h"
 
 // Utility function to check if two triangle or neighbor sets are equal
 bool array_compare_equal(const std::vector<std::array<int, 3>>& expected, const std::vector<std::array<int, 3>>& result)
@@ -28,6 +35,197 @@ bool array_compare_equal(const std::vector<std::array<int, 3>>& expected, const
     return true;
 }
 
+// Utility function to check if a triangle set contains the edge a-b in either direction
+bool contains_edge(const std::vector<std::array<int, 3>>& triangles, int a, int b)
+{
+    for (const auto& triangle : triangles)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            int u{ triangle[i] };
+            int v{ triangle[(i + 1) % 3] };
+
+            if ((u == a && v == b) || (u == b && v == a))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Utility function to check that every neighbor entry points back across the same edge
+bool neighbors_consistent(const std::vector<std::array<int, 3>>& triangles, const std::vector<std::array<int, 3>>& neighbors)
+{
+    for (int t = 0; t < triangles.size(); ++t)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            int n{ neighbors[t][i] };
+
+            if (n == -1)
+            {
+                continue;
+            }
+
+            int u{ triangles[t][i] };
+            int v{ triangles[t][(i + 1) % 3] };
+
+            bool found{ false };
+            for (int j = 0; j < 3; ++j)
+            {
+                if (triangles[n][j] == v && triangles[n][(j + 1) % 3] == u && neighbors[n][j] == t)
+                {
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Utility function to check that no triangle has the apex of a neighbor inside its circumcircle
+bool is_delaunay(const std::vector<moodysim::Point3D>& points, const std::vector<std::array<int, 3>>& triangles, const std::vector<std::array<int, 3>>& neighbors)
+{
+    for (int t = 0; t < triangles.size(); ++t)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            int n{ neighbors[t][i] };
+
+            if (n == -1)
+            {
+                continue;
+            }
+
+            for (int j = 0; j < 3; ++j)
+            {
+                int apex{ triangles[n][j] };
+
+                if (apex == triangles[t][0] || apex == triangles[t][1] || apex == triangles[t][2])
+                {
+                    continue;
+                }
+
+                if (moodysim::incircle(points[triangles[t][0]], points[triangles[t][1]], points[triangles[t][2]], points[apex]) > 1e-9)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Utility function to check that the edge index finds every directed edge in its triangle
+bool edge_index_consistent(const moodysim::DelaunayGenerator& delaunay_gen)
+{
+    const auto& triangles{ delaunay_gen.get_triangles() };
+    const auto& neighbors{ delaunay_gen.get_neighbors() };
+
+    size_t num_edges{ 0 };
+
+    for (int t = 0; t < triangles.size(); ++t)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            if (delaunay_gen.find_edge(triangles[t][i], triangles[t][(i + 1) % 3]) != t)
+            {
+                return false;
+            }
+
+            if (triangles[t][i] < triangles[t][(i + 1) % 3] || neighbors[t][i] == -1)
+            {
+                ++num_edges;
+            }
+        }
+    }
+
+    return num_edges == delaunay_gen.get_edge_index().size();
+}
+
+// Utility function to check that each vertex maps to a triangle containing it and that
+// vertices without a mapping are not used by any triangle
+bool vertex_triangles_consistent(const moodysim::DelaunayGenerator& delaunay_gen)
+{
+    const auto& triangles{ delaunay_gen.get_triangles() };
+    const auto& vertex_triangles{ delaunay_gen.get_vertex_triangles() };
+
+    std::vector<bool> used(vertex_triangles.size(), false);
+
+    for (const auto& triangle : triangles)
+    {
+        for (auto v : triangle)
+        {
+            used[v] = true;
+        }
+    }
+
+    for (int v = 0; v < vertex_triangles.size(); ++v)
+    {
+        int t{ vertex_triangles[v] };
+
+        if (t == -1)
+        {
+            if (used[v])
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        if (triangles[t][0] != v && triangles[t][1] != v && triangles[t][2] != v)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Utility function to find the smallest angle (degrees) of any triangle
+double smallest_angle(const std::vector<moodysim::Point3D>& points, const std::vector<std::array<int, 3>>& triangles)
+{
+    double result{ 180.0 };
+
+    for (const auto& triangle : triangles)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            moodysim::Point3D p{ points[triangle[i]] };
+            moodysim::Point3D u{ moodysim::subtract(points[triangle[(i + 1) % 3]], p) };
+            moodysim::Point3D v{ moodysim::subtract(points[triangle[(i + 2) % 3]], p) };
+
+            double cos_angle{ moodysim::dot_product(u, v) / std::sqrt(moodysim::dot_product(u, u) * moodysim::dot_product(v, v)) };
+            result = std::min(result, std::acos(std::clamp(cos_angle, -1.0, 1.0)) * 180.0 / 3.14159265358979);
+        }
+    }
+
+    return result;
+}
+
+// Average over all triangles of the smallest angle of each triangle in degrees
+double mean_smallest_angle(const std::vector<moodysim::Point3D>& points, const std::vector<std::array<int, 3>>& triangles)
+{
+    double total{ 0.0 };
+
+    for (const auto& triangle : triangles)
+    {
+        total += smallest_angle(points, { triangle });
+    }
+
+    return triangles.empty() ? 0.0 : total / triangles.size();
+}
+
 TEST(Delaunay, Normalization)
 {
     using namespace moodysim;
@@ -404,6 +602,1112 @@ TEST(Delaunay, EdgeConstraint)
     // Check that the resulting triangles and neighbors match expected
     /* EXPECT_TRUE(array_compare_equal(expected_triangles, delaunay_gen.get_triangles()));
     EXPECT_TRUE(array_compare_equal(expected_neighbors, delaunay_gen.get_neighbors())); */
+
+    EXPECT_TRUE(contains_edge(delaunay_gen.get_triangles(), 0, 1));
+    EXPECT_TRUE(neighbors_consistent(delaunay_gen.get_triangles(), delaunay_gen.get_neighbors()));
+}
+
+TEST(Delaunay, CheckConvex)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{
+        { 0.5f, -0.5f, 0.f },
+        { 0.f, 0.5f, 0.f },
+        { -0.5f, -0.5f, 0.f },
+        { -0.5f, 0.5f, 0.f },
+        { 1.f, -1.f, 0.f }
+    };
+
+    std::vector<std::array<int, 3>> input_triangles{
+        { 0, 1, 2 },
+        { 3, 2, 1 },
+        { 0, 4, 1 }
+    };
+
+    std::vector<std::array<int, 3>> input_neighbors{
+        { 2, 1, -1 },
+        { -1, 0, -1 },
+        { -1, -1, 0 }
+    };
+
+    DelaunayGenerator delaunay_gen{ input_points, {}, {}, input_triangles, input_neighbors };
+
+    // Point 3 is opposite the shared edge so the quad 0, 1, 3, 2 is convex
+    EXPECT_TRUE(delaunay_gen.check_convex(0, 1));
+
+    // Point 4 is far enough below point 0 to make a reflex corner at point 0
+    EXPECT_FALSE(delaunay_gen.check_convex(0, 2));
+}
+
+TEST(Delaunay, CheckIntersection)
+{
+    using namespace moodysim;
+
+    DelaunayGenerator delaunay_gen{ {}, {} };
+
+    EXPECT_TRUE(delaunay_gen.check_intersection({ -1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.f, 1.f, 0.f }));
+    EXPECT_FALSE(delaunay_gen.check_intersection({ -1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 0.5f, 0.f }, { 0.f, 1.f, 0.f }));
+
+    // Touching at an end point is not a crossing
+    EXPECT_FALSE(delaunay_gen.check_intersection({ -1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }));
+}
+
+TEST(Delaunay, ConstraintModesCoastline)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(4000, 6, input_points, input_edges);
+
+    for (auto mode : { ConstraintMode::Flip, ConstraintMode::Cavity, ConstraintMode::Automatic })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+
+        EXPECT_TRUE(delaunay_gen.apply_constraint(mode));
+
+        const auto& triangles{ delaunay_gen.get_triangles() };
+
+        for (auto edge : input_edges)
+        {
+            EXPECT_TRUE(contains_edge(triangles, edge.n1, edge.n2));
+        }
+
+        EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    }
+}
+
+TEST(Delaunay, SkipFailedConstraint)
+{
+    using namespace moodysim;
+
+    // Two triangles sharing the diagonal 1-3 and a point 4 that is in neither
+    std::vector<Point3D> input_points{
+        { 0.f, -1.f, 0.f },
+        { 1.f, 0.f, 0.f },
+        { 0.f, 1.f, 0.f },
+        { -1.f, 0.f, 0.f },
+        { 5.f, 5.f, 0.f }
+    };
+
+    std::vector<std::array<int, 3>> input_triangles{
+        { 0, 1, 3 },
+        { 1, 2, 3 }
+    };
+
+    std::vector<std::array<int, 3>> input_neighbors{
+        { -1, 1, -1 },
+        { -1, -1, 0 }
+    };
+
+    std::vector<Edge> input_edges{
+        { 4, 0 },
+        { 0, 2 }
+    };
+
+    DelaunayGenerator delaunay_gen{ input_points, {}, input_edges, input_triangles, input_neighbors };
+
+    // The first constraint is reported and the second is still inserted
+    EXPECT_FALSE(delaunay_gen.apply_constraint());
+
+    EXPECT_TRUE(contains_edge(delaunay_gen.get_triangles(), 0, 2));
+    EXPECT_TRUE(neighbors_consistent(delaunay_gen.get_triangles(), delaunay_gen.get_neighbors()));
+}
+
+TEST(Delaunay, ConformingConstraints)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(500, 4, input_points, input_edges);
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint(ConstraintMode::Conforming);
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& triangles{ delaunay_gen.get_triangles() };
+
+    EXPECT_GT(delaunay_gen.get_num_steiner_points(), 0);
+    EXPECT_EQ(points.size(), input_points.size() + 3 + delaunay_gen.get_num_steiner_points());
+    EXPECT_TRUE(is_delaunay(points, triangles, delaunay_gen.get_neighbors()));
+    EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+
+    // Each constraint is covered by a chain of edges through the Steiner points on it
+    int first_steiner{ static_cast<int>(input_points.size()) + 3 };
+
+    for (auto edge : input_edges)
+    {
+        Point3D a{ points[edge.n1] };
+        Point3D b{ points[edge.n2] };
+
+        std::vector<std::pair<float, int>> chain{ { 0.f, edge.n1 }, { 1.f, edge.n2 } };
+
+        for (int v = first_steiner; v < points.size(); ++v)
+        {
+            float length{ dot_product(subtract(b, a), subtract(b, a)) };
+            float t{ dot_product(subtract(points[v], a), subtract(b, a)) / length };
+            double off_line{ std::abs(orientation(a, b, points[v])) };
+
+            if (t > 0.f && t < 1.f && off_line < 1e-5 * length)
+            {
+                chain.push_back({ t, v });
+            }
+        }
+
+        std::sort(chain.begin(), chain.end());
+
+        for (size_t i = 1; i < chain.size(); ++i)
+        {
+            EXPECT_TRUE(contains_edge(triangles, chain[i - 1].second, chain[i].second));
+        }
+    }
+}
+
+TEST(Delaunay, ConformingShellsAfterRenumbering)
+{
+    using namespace moodysim;
+
+    // Point 6 encroaches the constraint 4-5, which conforming splits at its midpoint
+    std::vector<Point3D> input_points{
+        { -1.f, -1.f, 0.f },
+        { 1.f, -1.f, 0.f },
+        { 1.f, 1.f, 0.f },
+        { -1.f, 1.f, 0.f },
+        { -0.7f, 0.f, 0.f },
+        { 0.7f, 0.f, 0.f },
+        { 0.f, 0.2f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{ { 4, 5 } };
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint(ConstraintMode::Conforming);
+    EXPECT_EQ(delaunay_gen.get_num_steiner_points(), 1);
+
+    // Renumbering moves the midpoint in among the input points before refining splits the halves
+    delaunay_gen.renumber();
+    delaunay_gen.refine(30.f);
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& ordering{ delaunay_gen.get_point_ordering() };
+
+    float start{ points[ordering[4]].x };
+    float end{ points[ordering[5]].x };
+
+    // Each half has an input end so it is split on the 0.25 shell around that end, never at its midpoint
+    bool shell_split{ false };
+    bool midpoint_split{ false };
+
+    for (auto point : points)
+    {
+        if (std::abs(point.y) > 1e-6f || point.x <= start || point.x >= end)
+        {
+            continue;
+        }
+
+        float distance{ std::min(point.x - start, end - point.x) };
+
+        shell_split = shell_split || std::abs(distance - 0.25f) < 1e-5f;
+        midpoint_split = midpoint_split || std::abs(distance - 0.35f) < 1e-5f;
+    }
+
+    EXPECT_TRUE(shell_split);
+    EXPECT_FALSE(midpoint_split);
+}
+
+TEST(Delaunay, ConformingShortPieceReported)
+{
+    using namespace moodysim;
+
+    // The constraint 4-5 is far too short to split and its diametral circle holds point 6
+    std::vector<Point3D> input_points{
+        { -1.f, -1.f, 0.f },
+        { 1.f, -1.f, 0.f },
+        { 1.f, 1.f, 0.f },
+        { -1.f, 1.f, 0.f },
+        { 0.f, 0.f, 0.f },
+        { 1e-7f, 0.f, 0.f },
+        { 5e-8f, -1e-8f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{ { 4, 5 } };
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+
+    EXPECT_FALSE(delaunay_gen.apply_constraint(ConstraintMode::Conforming));
+
+    // The piece that was not recovered does not lock any edge
+    DelaunayState state{};
+    delaunay_gen.get_state(state);
+
+    EXPECT_TRUE(state.constrained_edges.empty());
+    EXPECT_TRUE(neighbors_consistent(delaunay_gen.get_triangles(), delaunay_gen.get_neighbors()));
+}
+
+TEST(Delaunay, EdgeIndex)
+{
+    using namespace moodysim;
+
+    EdgeIndex edge_index{};
+
+    // Enough edges to force several reallocations and long probe sequences
+    for (int i = 0; i < 1000; ++i)
+    {
+        edge_index.insert(i, i + 1, i);
+        edge_index.insert(i + 2, i, -i);
+    }
+
+    EXPECT_EQ(edge_index.size(), 2000);
+    EXPECT_EQ(edge_index.find(11, 10), 10);
+    EXPECT_EQ(edge_index.find(10, 12), -10);
+    EXPECT_EQ(edge_index.find(10, 13), -1);
+
+    // Erasing every other entry must not break the probe sequences of the rest
+    for (int i = 0; i < 1000; i += 2)
+    {
+        edge_index.erase(i, i + 1);
+    }
+
+    bool found_all{ true };
+    for (int i = 0; i < 1000; ++i)
+    {
+        found_all = found_all && edge_index.find(i, i + 1) == (i % 2 == 0 ? -1 : i);
+        found_all = found_all && edge_index.find(i, i + 2) == -i;
+    }
+
+    EXPECT_TRUE(found_all);
+    EXPECT_EQ(edge_index.size(), 1500);
+}
+
+TEST(Delaunay, EdgeIndexMaintained)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(2000, 5, input_points, input_edges);
+
+    for (auto mode : { ConstraintMode::Flip, ConstraintMode::Cavity, ConstraintMode::Conforming })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+        EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+
+        delaunay_gen.apply_constraint(mode);
+        EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+
+        if (mode != ConstraintMode::Conforming)
+        {
+            for (auto edge : input_edges)
+            {
+                EXPECT_TRUE(delaunay_gen.has_edge(edge.n2, edge.n1));
+            }
+        }
+    }
+}
+
+TEST(Delaunay, VertexTrianglesMaintained)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(2000, 5, input_points, input_edges);
+
+    for (auto mode : { ConstraintMode::Flip, ConstraintMode::Cavity, ConstraintMode::Conforming })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+        EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+
+        delaunay_gen.apply_constraint(mode);
+        EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+    }
+
+    // Walking the star of a vertex finds every triangle containing it
+    DelaunayGenerator delaunay_gen{ input_points, {} };
+    delaunay_gen.triangulate();
+
+    const auto& triangles{ delaunay_gen.get_triangles() };
+    std::vector<int> fan{};
+
+    bool stars_complete{ true };
+
+    for (int v = 0; v < input_points.size(); ++v)
+    {
+        delaunay_gen.collect_fan(v, fan);
+
+        int expected{ 0 };
+        for (const auto& triangle : triangles)
+        {
+            expected += (triangle[0] == v || triangle[1] == v || triangle[2] == v) ? 1 : 0;
+        }
+
+        stars_complete = stars_complete && fan.size() == expected;
+    }
+
+    EXPECT_TRUE(stars_complete);
+}
+
+TEST(Delaunay, SuperTriangleRemovalKeepsVertexTriangles)
+{
+    using namespace moodysim;
+
+    // Points in a thin ring put many vertices on the hull, where removing the triangles on the
+    // super triangle one at a time can split the fan of a vertex
+    bool consistent{ true };
+
+    for (unsigned int seed = 0; seed < 20; ++seed)
+    {
+        std::mt19937 rng{ seed };
+        std::uniform_real_distribution<float> angle{ 0.f, 6.2831853f };
+        std::uniform_real_distribution<float> radius{ 0.85f, 0.9f };
+
+        std::vector<Point3D> input_points{};
+
+        for (int i = 0; i < 60; ++i)
+        {
+            float a{ angle(rng) };
+            float r{ radius(rng) };
+            input_points.push_back({ r * std::cos(a), r * std::sin(a), 0.f });
+        }
+
+        DelaunayGenerator delaunay_gen{ input_points, {} };
+        delaunay_gen.triangulate();
+
+        consistent = consistent && vertex_triangles_consistent(delaunay_gen);
+    }
+
+    EXPECT_TRUE(consistent);
+}
+
+TEST(Delaunay, PolygonWithHole)
+{
+    using namespace moodysim;
+
+    // Outer square (0 - 3) and an inner square hole (4 - 7)
+    std::vector<Point3D> input_points{
+        { -0.8f, -0.8f, 0.f },
+        { 0.8f, -0.8f, 0.f },
+        { 0.8f, 0.8f, 0.f },
+        { -0.8f, 0.8f, 0.f },
+        { -0.3f, -0.3f, 0.f },
+        { 0.3f, -0.3f, 0.f },
+        { 0.3f, 0.3f, 0.f },
+        { -0.3f, 0.3f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{
+        { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+        { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 }
+    };
+
+    // Scatter points inside and outside the domain so there is something to remove
+    std::mt19937 rng{ 42 };
+    std::uniform_real_distribution<float> coord{ -0.95f, 0.95f };
+
+    for (int i = 0; i < 400; ++i)
+    {
+        input_points.push_back({ coord(rng), coord(rng), 0.f });
+    }
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges, { { 0.f, 0.f, 0.f } } };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+    delaunay_gen.remove_exterior();
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& triangles{ delaunay_gen.get_triangles() };
+
+    bool inside_domain{ true };
+    double area{ 0.0 };
+
+    for (const auto& triangle : triangles)
+    {
+        Point3D a{ points[triangle[0]] };
+        Point3D b{ points[triangle[1]] };
+        Point3D c{ points[triangle[2]] };
+
+        float cx{ (a.x + b.x + c.x) / 3.f };
+        float cy{ (a.y + b.y + c.y) / 3.f };
+
+        bool in_outer{ std::abs(cx) < 0.8f && std::abs(cy) < 0.8f };
+        bool in_hole{ std::abs(cx) < 0.3f && std::abs(cy) < 0.3f };
+
+        inside_domain = inside_domain && in_outer && !in_hole;
+        area += 0.5 * orientation(a, b, c);
+    }
+
+    EXPECT_TRUE(inside_domain);
+    EXPECT_NEAR(area, 1.6 * 1.6 - 0.6 * 0.6, 1e-4);
+    EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+    EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+}
+
+TEST(Delaunay, OpenPolylineKeepsMesh)
+{
+    using namespace moodysim;
+
+    // An arch (0 - 3) that does not enclose anything
+    std::vector<Point3D> input_points{
+        { -0.6f, -0.2f, 0.f },
+        { -0.2f, 0.4f, 0.f },
+        { 0.2f, 0.4f, 0.f },
+        { 0.6f, -0.2f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{ { 0, 1 }, { 1, 2 }, { 2, 3 } };
+
+    std::mt19937 rng{ 7 };
+    std::uniform_real_distribution<float> coord{ -0.9f, 0.9f };
+
+    for (int i = 0; i < 200; ++i)
+    {
+        input_points.push_back({ coord(rng), coord(rng), 0.f });
+    }
+
+    DelaunayGenerator constrained_gen{ input_points, input_edges };
+    constrained_gen.triangulate();
+    constrained_gen.apply_constraint();
+
+    // Every triangle of the constrained triangulation is kept
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+    SurfaceMeshData mesh{ delaunay_gen.generate_delaunay_mesh() };
+
+    EXPECT_EQ(mesh.get_indices().size(), 3 * constrained_gen.get_triangles().size());
+
+    // Closing the polyline removes everything outside the loop
+    input_edges.push_back({ 3, 0 });
+
+    DelaunayGenerator closed_gen{ input_points, input_edges };
+    SurfaceMeshData closed_mesh{ closed_gen.generate_delaunay_mesh() };
+
+    EXPECT_GT(closed_mesh.get_indices().size(), 0);
+    EXPECT_LT(closed_mesh.get_indices().size(), mesh.get_indices().size());
+}
+
+TEST(Delaunay, RefinePolygonWithHole)
+{
+    using namespace moodysim;
+
+    // Outer square (0 - 3) and a smaller off center square hole (4 - 7)
+    std::vector<Point3D> input_points{
+        { -0.8f, -0.8f, 0.f },
+        { 0.8f, -0.8f, 0.f },
+        { 0.8f, 0.8f, 0.f },
+        { -0.8f, 0.8f, 0.f },
+        { -0.3f, -0.2f, 0.f },
+        { 0.1f, -0.2f, 0.f },
+        { 0.1f, 0.3f, 0.f },
+        { -0.3f, 0.3f, 0.f },
+        { 0.9f, 0.9f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{
+        { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+        { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 }
+    };
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges, { { -0.1f, 0.f, 0.f } } };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+    delaunay_gen.remove_exterior();
+
+    int added{ delaunay_gen.refine(25.f) };
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& triangles{ delaunay_gen.get_triangles() };
+
+    double area{ 0.0 };
+    for (const auto& triangle : triangles)
+    {
+        area += 0.5 * orientation(points[triangle[0]], points[triangle[1]], points[triangle[2]]);
+    }
+
+    EXPECT_GT(added, 0);
+    EXPECT_GE(smallest_angle(points, triangles), 25.0);
+    EXPECT_NEAR(area, 1.6 * 1.6 - 0.4 * 0.5, 1e-4);
+    EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+    EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+}
+
+TEST(Delaunay, RefineOffCenter)
+{
+    using namespace moodysim;
+
+    // Outer square (0 - 3) and a smaller off center square hole (4 - 7)
+    std::vector<Point3D> input_points{
+        { -0.8f, -0.8f, 0.f },
+        { 0.8f, -0.8f, 0.f },
+        { 0.8f, 0.8f, 0.f },
+        { -0.8f, 0.8f, 0.f },
+        { -0.3f, -0.2f, 0.f },
+        { 0.1f, -0.2f, 0.f },
+        { 0.1f, 0.3f, 0.f },
+        { -0.3f, 0.3f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{
+        { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+        { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 }
+    };
+
+    // Scattered points force a lot of refinement between them
+    std::mt19937 rng{ 4321 };
+    std::uniform_real_distribution<float> coord{ -0.75f, 0.75f };
+
+    while (input_points.size() < 300)
+    {
+        Point3D point{ coord(rng), coord(rng), 0.f };
+
+        if (point.x < -0.35f || point.x > 0.15f || point.y < -0.25f || point.y > 0.35f)
+        {
+            input_points.push_back(point);
+        }
+    }
+
+    int added[2]{};
+
+    for (auto placement : { SteinerPlacement::Circumcenter, SteinerPlacement::OffCenter })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges, { { -0.1f, 0.f, 0.f } } };
+
+        delaunay_gen.triangulate();
+        delaunay_gen.apply_constraint();
+        delaunay_gen.remove_exterior();
+        delaunay_gen.set_steiner_placement(placement);
+
+        int index{ placement == SteinerPlacement::OffCenter ? 1 : 0 };
+        added[index] = delaunay_gen.refine(30.f);
+
+        EXPECT_GE(smallest_angle(delaunay_gen.get_points(), delaunay_gen.get_triangles()), 30.0);
+        EXPECT_TRUE(neighbors_consistent(delaunay_gen.get_triangles(), delaunay_gen.get_neighbors()));
+        EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+    }
+
+    EXPECT_LT(added[1], added[0]);
+}
+
+TEST(Delaunay, RefinePointCloud)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(300, 3, input_points, input_edges);
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+
+    int added{ delaunay_gen.refine(20.f) };
+
+    EXPECT_GT(added, 0);
+    EXPECT_GE(smallest_angle(delaunay_gen.get_points(), delaunay_gen.get_triangles()), 20.0);
+    EXPECT_TRUE(neighbors_consistent(delaunay_gen.get_triangles(), delaunay_gen.get_neighbors()));
+
+    for (auto edge : input_edges)
+    {
+        Point3D a{ input_points[edge.n1] };
+        Point3D b{ input_points[edge.n2] };
+
+        // The constraint pieces still cover each constraint
+        double covered{ 0.0 };
+        for (const auto& triangle : delaunay_gen.get_triangles())
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                Point3D u{ delaunay_gen.get_points()[triangle[i]] };
+                Point3D v{ delaunay_gen.get_points()[triangle[(i + 1) % 3]] };
+
+                bool on_constraint{ std::abs(orientation(a, b, u)) < 1e-6 && std::abs(orientation(a, b, v)) < 1e-6 };
+                bool inside{ dot_product(subtract(u, a), subtract(b, u)) >= -1e-6f && dot_product(subtract(v, a), subtract(b, v)) >= -1e-6f };
+
+                if (on_constraint && inside)
+                {
+                    covered += std::sqrt(dot_product(subtract(v, u), subtract(v, u)));
+                }
+            }
+        }
+
+        // Each piece is counted once from each side
+        EXPECT_NEAR(covered, 2.0 * std::sqrt(dot_product(subtract(b, a), subtract(b, a))), 1e-4);
+    }
+}
+
+TEST(Delaunay, SizeFieldGrid)
+{
+    using namespace moodysim;
+
+    // h = 1 + x + 2y sampled on a 3 x 2 grid over [0, 2] x [0, 1] is reproduced exactly
+    SizeField size_field{ { 1.f, 2.f, 3.f, 3.f, 4.f, 5.f }, 3, 2, 0.f, 0.f, 2.f, 1.f };
+
+    EXPECT_FLOAT_EQ(size_field(0.f, 0.f), 1.f);
+    EXPECT_FLOAT_EQ(size_field(0.5f, 0.5f), 2.5f);
+    EXPECT_FLOAT_EQ(size_field(1.5f, 0.25f), 3.f);
+    EXPECT_FLOAT_EQ(size_field(2.f, 1.f), 5.f);
+
+    // Outside the grid the nearest edge is used
+    EXPECT_FLOAT_EQ(size_field(-1.f, 2.f), 3.f);
+
+    // A single row is interpolated along x and constant along y, a single column the other way
+    SizeField row{ { 1.f, 2.f, 4.f }, 3, 1, 0.f, 0.f, 2.f, 0.f };
+
+    EXPECT_FLOAT_EQ(row(0.5f, 0.f), 1.5f);
+    EXPECT_FLOAT_EQ(row(1.5f, 7.f), 3.f);
+    EXPECT_FLOAT_EQ(row(3.f, -7.f), 4.f);
+
+    SizeField column{ { 1.f, 2.f, 4.f }, 1, 3, 0.f, 0.f, 0.f, 2.f };
+
+    EXPECT_FLOAT_EQ(column(7.f, 0.5f), 1.5f);
+    EXPECT_FLOAT_EQ(column(-7.f, 1.5f), 3.f);
+
+    // A grid that does not match its values sets no limit
+    SizeField mismatched{ { 1.f, 2.f }, 3, 1, 0.f, 0.f, 2.f, 0.f };
+    EXPECT_EQ(mismatched(1.f, 0.f), std::numeric_limits<float>::max());
+
+    SizeField flat{ { 1.f, 2.f }, 2, 1, 1.f, 0.f, 1.f, 0.f };
+    EXPECT_EQ(flat(1.f, 0.f), std::numeric_limits<float>::max());
+}
+
+TEST(Delaunay, RefineSizeField)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{
+        { -0.8f, -0.8f, 0.f },
+        { 0.8f, -0.8f, 0.f },
+        { 0.8f, 0.8f, 0.f },
+        { -0.8f, 0.8f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+
+    // Fine elements near one corner growing away from it
+    auto target = [](float x, float y)
+        {
+            float dx{ x + 0.8f };
+            float dy{ y + 0.8f };
+            return 0.01f + 0.2f * std::sqrt(dx * dx + dy * dy);
+        };
+
+    SizeField adaptive{ target };
+    SizeField uniform{ [](float, float) { return 0.01f; } };
+
+    size_t num_triangles[2]{};
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+        delaunay_gen.apply_constraint();
+        delaunay_gen.remove_exterior();
+        delaunay_gen.refine(20.f, pass == 0 ? adaptive : uniform);
+
+        const auto& points{ delaunay_gen.get_points() };
+        const auto& triangles{ delaunay_gen.get_triangles() };
+
+        num_triangles[pass] = triangles.size();
+
+        bool sizes_met{ true };
+        for (const auto& triangle : triangles)
+        {
+            Point3D a{ points[triangle[0]] };
+            Point3D b{ points[triangle[1]] };
+            Point3D c{ points[triangle[2]] };
+
+            Point3D center{ circumcenter(a, b, c) };
+            float radius{ std::sqrt(dot_product(subtract(a, center), subtract(a, center))) };
+            float size{ pass == 0 ? target((a.x + b.x + c.x) / 3.f, (a.y + b.y + c.y) / 3.f) : 0.01f };
+
+            sizes_met = sizes_met && radius <= 1.0001f * size;
+        }
+
+        EXPECT_TRUE(sizes_met);
+        EXPECT_GE(smallest_angle(points, triangles), 20.0);
+        EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    }
+
+    EXPECT_LT(10 * num_triangles[0], num_triangles[1]);
+}
+
+TEST(Delaunay, LloydRelaxation)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(5000, 40, input_points, input_edges);
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& triangles{ delaunay_gen.get_triangles() };
+
+    std::vector<Point3D> constraint_points{};
+    for (auto edge : input_edges)
+    {
+        constraint_points.push_back(points[edge.n1]);
+    }
+
+    double before{ mean_smallest_angle(points, triangles) };
+
+    delaunay_gen.lloyd_relaxation(10);
+
+    double after{ mean_smallest_angle(points, triangles) };
+
+    EXPECT_GT(after, before + 10.0);
+    EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+    EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+
+    // Vertices on constraints stay in place and the constraints stay in the mesh
+    for (int i = 0; i < input_edges.size(); ++i)
+    {
+        EXPECT_EQ(points[input_edges[i].n1].x, constraint_points[i].x);
+        EXPECT_EQ(points[input_edges[i].n1].y, constraint_points[i].y);
+        EXPECT_TRUE(delaunay_gen.has_edge(input_edges[i].n1, input_edges[i].n2));
+    }
+}
+
+TEST(Delaunay, Smoothing)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(5000, 40, input_points, input_edges);
+
+    for (auto method : { SmoothingMethod::Laplacian, SmoothingMethod::Angle, SmoothingMethod::Optimization })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+        delaunay_gen.apply_constraint();
+
+        const auto& points{ delaunay_gen.get_points() };
+        const auto& triangles{ delaunay_gen.get_triangles() };
+
+        std::vector<int> colors{};
+        int num_colors{ delaunay_gen.color_vertices(colors) };
+
+        EXPECT_LE(num_colors, 12);
+
+        bool proper{ true };
+        for (const auto& triangle : triangles)
+        {
+            proper = proper && colors[triangle[0]] != colors[triangle[1]] && colors[triangle[1]] != colors[triangle[2]] && colors[triangle[2]] != colors[triangle[0]];
+        }
+
+        EXPECT_TRUE(proper);
+
+        std::vector<std::array<int, 3>> topology{ triangles };
+        double before{ mean_smallest_angle(points, triangles) };
+
+        delaunay_gen.smooth(method, 5);
+
+        double after{ mean_smallest_angle(points, triangles) };
+
+        bool counter_clockwise{ true };
+        for (const auto& triangle : triangles)
+        {
+            counter_clockwise = counter_clockwise && orientation(points[triangle[0]], points[triangle[1]], points[triangle[2]]) > 0.0;
+        }
+
+        EXPECT_GT(after, before + 5.0);
+        EXPECT_TRUE(counter_clockwise);
+        EXPECT_TRUE(topology == triangles);
+
+        for (auto edge : input_edges)
+        {
+            EXPECT_EQ(points[edge.n1].x, input_points[edge.n1].x);
+            EXPECT_EQ(points[edge.n1].y, input_points[edge.n1].y);
+        }
+    }
+}
+
+TEST(Delaunay, MetricRemeshing)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{
+        { -0.8f, -0.8f, 0.f },
+        { 0.8f, -0.8f, 0.f },
+        { 0.8f, 0.8f, 0.f },
+        { -0.8f, 0.8f, 0.f }
+    };
+
+    std::vector<Edge> input_edges{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 } };
+
+    DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+    delaunay_gen.triangulate();
+    delaunay_gen.apply_constraint();
+    delaunay_gen.remove_exterior();
+    delaunay_gen.refine(20.f, SizeField{ [](float, float) { return 0.1f; } });
+    delaunay_gen.build_edge_index();
+
+    const auto& points{ delaunay_gen.get_points() };
+    const auto& triangles{ delaunay_gen.get_triangles() };
+
+    // Edges 0.2 long in x and 0.02 long in y
+    std::vector<MetricTensor> metric(points.size(), MetricTensor{ 25.f, 0.f, 2500.f });
+
+    delaunay_gen.remesh(metric, 4);
+
+    EXPECT_EQ(metric.size(), points.size());
+    EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+    EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+    EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+
+    double area{ 0.0 };
+    bool counter_clockwise{ true };
+
+    for (const auto& triangle : triangles)
+    {
+        double twice_area{ orientation(points[triangle[0]], points[triangle[1]], points[triangle[2]]) };
+
+        counter_clockwise = counter_clockwise && twice_area > 0.0;
+        area += 0.5 * twice_area;
+    }
+
+    EXPECT_TRUE(counter_clockwise);
+    EXPECT_NEAR(area, 1.6 * 1.6, 1e-4);
+
+    // Measure each edge in the metric, hull edges are bounded by the square so only interior edges count
+    int num_edges{ 0 };
+    int num_unit{ 0 };
+
+    for (int t = 0; t < triangles.size(); ++t)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            int a{ triangles[t][i] };
+            int b{ triangles[t][(i + 1) % 3] };
+
+            if (a > b || delaunay_gen.get_neighbors()[t][i] == -1)
+            {
+                continue;
+            }
+
+            double dx{ points[b].x - points[a].x };
+            double dy{ points[b].y - points[a].y };
+            double length{ std::sqrt(25.0 * dx * dx + 2500.0 * dy * dy) };
+
+            ++num_edges;
+            num_unit += (length >= 0.5 && length <= 2.0) ? 1 : 0;
+        }
+    }
+
+    EXPECT_GT(num_unit, 0.9 * num_edges);
+}
+
+// Utility function to find the largest and mean index distance between the ends of an edge
+void edge_bandwidth(const std::vector<std::array<int, 3>>& triangles, int& largest, double& mean)
+{
+    largest = 0;
+    mean = 0.0;
+
+    for (const auto& triangle : triangles)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            int distance{ std::abs(triangle[i] - triangle[(i + 1) % 3]) };
+
+            largest = std::max(largest, distance);
+            mean += distance;
+        }
+    }
+
+    mean /= 3.0 * triangles.size();
+}
+
+TEST(Delaunay, Renumbering)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{};
+    std::vector<Edge> input_edges{};
+
+    make_coastline(5000, 40, input_points, input_edges);
+
+    for (auto method : { RenumberingMethod::Hilbert, RenumberingMethod::CuthillMcKee })
+    {
+        DelaunayGenerator delaunay_gen{ input_points, input_edges };
+
+        delaunay_gen.triangulate();
+        delaunay_gen.apply_constraint();
+
+        const auto& points{ delaunay_gen.get_points() };
+        const auto& triangles{ delaunay_gen.get_triangles() };
+
+        int largest_before{};
+        double mean_before{};
+        edge_bandwidth(triangles, largest_before, mean_before);
+
+        size_t num_triangles{ triangles.size() };
+
+        delaunay_gen.renumber(method);
+
+        int largest_after{};
+        double mean_after{};
+        edge_bandwidth(triangles, largest_after, mean_after);
+
+        EXPECT_LT(10.0 * mean_after, mean_before);
+
+        if (method == RenumberingMethod::CuthillMcKee)
+        {
+            EXPECT_LT(4 * largest_after, largest_before);
+        }
+
+        EXPECT_EQ(triangles.size(), num_triangles);
+        EXPECT_TRUE(neighbors_consistent(triangles, delaunay_gen.get_neighbors()));
+        EXPECT_TRUE(edge_index_consistent(delaunay_gen));
+        EXPECT_TRUE(vertex_triangles_consistent(delaunay_gen));
+
+        // Every input point is where point_ordering says and the constraints still connect the same points
+        const auto& ordering{ delaunay_gen.get_point_ordering() };
+        ASSERT_EQ(ordering.size(), input_points.size());
+
+        bool moved{ true };
+        for (int i = 0; i < input_points.size(); ++i)
+        {
+            moved = moved && points[ordering[i]].x == input_points[i].x && points[ordering[i]].y == input_points[i].y;
+        }
+
+        EXPECT_TRUE(moved);
+
+        for (auto edge : input_edges)
+        {
+            EXPECT_TRUE(delaunay_gen.has_edge(ordering[edge.n1], ordering[edge.n2]));
+        }
+
+        bool counter_clockwise{ true };
+        bool sorted{ true };
+
+        for (int t = 0; t < triangles.size(); ++t)
+        {
+            counter_clockwise = counter_clockwise && orientation(points[triangles[t][0]], points[triangles[t][1]], points[triangles[t][2]]) > 0.0;
+
+            if (t > 0)
+            {
+                sorted = sorted && *std::min_element(triangles[t - 1].begin(), triangles[t - 1].end()) <= *std::min_element(triangles[t].begin(), triangles[t].end());
+            }
+        }
+
+        EXPECT_TRUE(counter_clockwise);
+        EXPECT_TRUE(sorted);
+    }
+}
+
+TEST(Delaunay, RenumberingOptIn)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> input_points{ generate_sample_points(1.f, 20) };
+
+    // Vertices keep the input order unless renumbering is asked for
+    DelaunayGenerator plain_gen{ input_points, {} };
+    SurfaceMeshData plain_mesh{ plain_gen.generate_delaunay_mesh() };
+
+    bool in_order{ true };
+    for (int i = 0; i < input_points.size(); ++i)
+    {
+        in_order = in_order && plain_mesh.get_vertices()[i].x == input_points[i].x && plain_mesh.get_vertices()[i].y == input_points[i].y;
+    }
+
+    EXPECT_TRUE(in_order);
+
+    DelaunayGenerator delaunay_gen{ input_points, {} };
+    delaunay_gen.set_renumbering(true, RenumberingMethod::CuthillMcKee);
+
+    SurfaceMeshData mesh{ delaunay_gen.generate_delaunay_mesh() };
+
+    // Only the input points have an entry in the ordering
+    const auto& ordering{ delaunay_gen.get_point_ordering() };
+    ASSERT_EQ(ordering.size(), input_points.size());
+
+    bool moved{ true };
+    for (int i = 0; i < input_points.size(); ++i)
+    {
+        moved = moved && mesh.get_vertices()[ordering[i]].x == input_points[i].x && mesh.get_vertices()[ordering[i]].y == input_points[i].y;
+    }
+
+    EXPECT_TRUE(moved);
+    EXPECT_EQ(mesh.get_indices().size(), plain_mesh.get_indices().size());
+}
+
+TEST(Delaunay, PointSource)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected{ generate_sample_points(1.f, 20) };
+
+    EXPECT_LE(expected.size(), sample_points_bound(1.f, 20));
+    EXPECT_GT(expected.size(), sample_points_bound(1.f, 20) / 2);
+
+    // The source hands out chunks of at most the requested size in generation order
+    RangePointSource chunks{ stream_sample_points(1.f, 20) };
+    std::vector<Point3D> streamed{};
+
+    size_t count{};
+    while ((count = chunks.read(streamed, 100)) > 0)
+    {
+        EXPECT_LE(count, 100);
+    }
+
+    ASSERT_EQ(streamed.size(), expected.size());
+    EXPECT_TRUE(std::equal(streamed.begin(), streamed.end(), expected.begin(), [](Point3D l, Point3D r) { return l.x == r.x && l.y == r.y; }));
+
+    // Streaming into the triangulator gives the same triangulation as the finished vector
+    // and with a size hint the points are allocated once
+    RangePointSource source{ stream_sample_points(1.f, 20), sample_points_bound(1.f, 20) };
+    DelaunayGenerator streamed_gen{ source };
+
+    EXPECT_EQ(streamed_gen.get_points().capacity(), sample_points_bound(1.f, 20) + 3);
+
+    const Point3D* data{ streamed_gen.get_points().data() };
+
+    streamed_gen.triangulate();
+
+    EXPECT_EQ(streamed_gen.get_points().data(), data);
+
+    DelaunayGenerator delaunay_gen{ expected, {} };
+    delaunay_gen.triangulate();
+
+    EXPECT_TRUE(streamed_gen.get_triangles() == delaunay_gen.get_triangles());
+
+    // Sized ranges report their own size
+    RangePointSource view{ std::ranges::ref_view{ expected } };
+    EXPECT_EQ(view.size_hint(), expected.size());
 }
 
 TEST(Delaunay, Generation)
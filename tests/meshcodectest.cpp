@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "mesh.h"
+#include "meshcodec.h"
+#include "meshfixtures.h"
+
+// Sum of the triangle areas projected on the xy plane
+double projected_area(const moodysim::SurfaceMeshData& mesh)
+{
+    auto vertices{ mesh.get_vertices() };
+    auto indices{ mesh.get_indices() };
+
+    double area{ 0.0 };
+
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        const auto& a{ vertices[indices[t]] };
+        const auto& b{ vertices[indices[t + 1]] };
+        const auto& c{ vertices[indices[t + 2]] };
+
+        area += 0.5 * ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    }
+
+    return area;
+}
+
+// Triangles as sorted vertex position triples so meshes can be compared regardless of numbering
+std::set<std::array<float, 6>> triangle_positions(const moodysim::SurfaceMeshData& mesh)
+{
+    auto vertices{ mesh.get_vertices() };
+    auto indices{ mesh.get_indices() };
+
+    std::set<std::array<float, 6>> triangles{};
+
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        std::array<std::pair<float, float>, 3> corners{};
+
+        for (int k = 0; k < 3; ++k)
+        {
+            corners[k] = { vertices[indices[t + k]].x, vertices[indices[t + k]].y };
+        }
+
+        std::sort(corners.begin(), corners.end());
+        triangles.insert({ corners[0].first, corners[0].second, corners[1].first, corners[1].second, corners[2].first, corners[2].second });
+    }
+
+    return triangles;
+}
+
+TEST(MeshCodec, RoundTrip)
+{
+    using namespace moodysim;
+
+    DelaunayGenerator delaunay_gen{ generate_sample_points(1.f, 20), {} };
+    SurfaceMeshData mesh{ delaunay_gen.generate_delaunay_mesh() };
+
+    // Positions within half a step of the bounding box divided into 2^16 - 1 steps
+    std::vector<std::byte> data{ encode_mesh(mesh, 16) };
+    std::optional<SurfaceMeshData> decoded{ decode_mesh(data) };
+
+    ASSERT_TRUE(decoded);
+    ASSERT_EQ(decoded->get_vertices().size(), mesh.get_vertices().size());
+    ASSERT_EQ(decoded->get_indices().size(), mesh.get_indices().size());
+
+    // Same area with the same orientation, moving the boundary by at most half a step
+    // (the unused super triangle corners are kept so the box is 200 wide)
+    double step{ 200.0 / 65535.0 };
+    EXPECT_NEAR(projected_area(*decoded), projected_area(mesh), 2.0 * 3.14159265 * step);
+
+    double bytes_per_triangle{ static_cast<double>(data.size()) / (mesh.get_indices().size() / 3) };
+
+    EXPECT_LT(bytes_per_triangle, 8.0);
+
+    // The same triangles come back when the positions are exact (15 steps of 4 bits)
+    std::vector<SMVertex> vertices{};
+    std::vector<unsigned int> indices{};
+
+    for (int j = 0; j <= 15; ++j)
+    {
+        for (int i = 0; i <= 15; ++i)
+        {
+            vertices.push_back({ static_cast<float>(i), static_cast<float>(j), 0.f });
+        }
+    }
+
+    for (unsigned int j = 0; j < 15; ++j)
+    {
+        for (unsigned int i = 0; i < 15; ++i)
+        {
+            unsigned int v{ j * 16 + i };
+            indices.insert(indices.end(), { v + 17, v, v + 1, v + 16, v, v + 17 });
+        }
+    }
+
+    SurfaceMeshData grid{ std::move(vertices), std::move(indices) };
+
+    decoded = decode_mesh(encode_mesh(grid, 4));
+
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(triangle_positions(*decoded), triangle_positions(grid));
+    EXPECT_EQ(projected_area(*decoded), projected_area(grid));
+}
+
+TEST(MeshCodec, InvalidData)
+{
+    using namespace moodysim;
+
+    DelaunayGenerator delaunay_gen{ generate_sample_points(1.f, 20), {} };
+    SurfaceMeshData mesh{ delaunay_gen.generate_delaunay_mesh() };
+
+    std::vector<std::byte> data{ encode_mesh(mesh) };
+
+    EXPECT_TRUE(encode_mesh(mesh, 0).empty());
+
+    // Cut short
+    EXPECT_FALSE(decode_mesh(std::span<const std::byte>{ data }.first(data.size() - 10)));
+
+    // Indices past the last vertex
+    std::vector<std::byte> corrupt{ data };
+    std::fill(corrupt.end() - 6, corrupt.end(), std::byte{ 0x7f });
+
+    EXPECT_FALSE(decode_mesh(corrupt));
+}
+
+TEST(MeshCodec, JitteredGrid)
+{
+    using namespace moodysim;
+
+    // Jittered grid so positions do not quantize exactly
+    SurfaceMeshData mesh{ make_jittered_grid(100, [](int i, int) { return std::cos(0.01f * i); }) };
+
+    size_t raw_size{ mesh.get_vertices().size() * 3 * sizeof(float) + mesh.get_indices().size() * sizeof(unsigned int) };
+
+    std::vector<std::byte> data{ encode_mesh(mesh) };
+    std::optional<SurfaceMeshData> decoded{ decode_mesh(data) };
+
+    ASSERT_TRUE(decoded);
+
+    EXPECT_LT(data.size(), raw_size / 2);
+
+    // Every decoded position is within half a step of an original one, compare through the area
+    EXPECT_NEAR(projected_area(*decoded), projected_area(mesh), 1e-4 * projected_area(mesh));
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "asciipoints.h"
+#include "meshexport.h"
+#include "meshfixtures.h"
+
+// Grid of n by n cells over the unit square with a bump in z
+moodysim::SurfaceMeshData make_export_grid(int n)
+{
+    return make_grid(n, [n](int i, int j)
+        {
+            float x{ static_cast<float>(i) / n };
+            float y{ static_cast<float>(j) / n };
+
+            return moodysim::SMVertex{ x, y, 0.1f * std::sin(3.f * x) * std::cos(2.f * y) };
+        });
+}
+
+std::string read_file(const std::string& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    std::stringstream text{};
+    text << file.rdbuf();
+    return text.str();
+}
+
+TEST(MeshExport, TextFormats)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_export_grid(10) };
+    auto vertices{ mesh.get_vertices() };
+
+    std::vector<float> height(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        height[i] = 1000.f * vertices[i].z;
+    }
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_export.ply").string() };
+
+    // ASCII PLY reads back exactly, shortest float text round trips
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Ply, false, { { "height", height } }));
+
+    AsciiPointCloud cloud{};
+    ASSERT_TRUE(load_ascii_points(path, cloud));
+
+    ASSERT_EQ(cloud.points.size(), vertices.size());
+    ASSERT_EQ(cloud.attribute_names.size(), 1);
+    EXPECT_EQ(cloud.attribute_names[0], "height");
+
+    bool same{ true };
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        same = same && cloud.points[i].x == vertices[i].x && cloud.points[i].y == vertices[i].y && cloud.points[i].z == vertices[i].z;
+        same = same && cloud.attributes[0][i] == height[i];
+    }
+
+    EXPECT_TRUE(same);
+
+    // OBJ indices start at 1
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Obj));
+
+    std::string text{ read_file(path) };
+
+    EXPECT_EQ(text.find("v 0 0 0\n"), 0);
+    EXPECT_NE(text.find("\nf 1 2 13\n"), std::string::npos);
+    EXPECT_EQ(std::count(text.begin(), text.end(), 'f'), 200);
+
+    // ASCII STL has a facet per triangle
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Stl, false));
+
+    text = read_file(path);
+    size_t facets{ 0 };
+    for (size_t p = text.find("facet normal"); p != std::string::npos; p = text.find("facet normal", p + 1))
+    {
+        ++facets;
+    }
+
+    EXPECT_EQ(facets, 200);
+    EXPECT_NE(text.find("endsolid"), std::string::npos);
+
+    // Legacy VTK lists the polygons with their sizes
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Vtk, false, { { "height", height } }));
+
+    text = read_file(path);
+    EXPECT_NE(text.find("POLYGONS 200 800\n3 0 1 12\n"), std::string::npos);
+    EXPECT_NE(text.find("SCALARS height float 1"), std::string::npos);
+
+    // A field must have a value per vertex
+    EXPECT_FALSE(export_mesh(path, mesh, MeshExportFormat::Ply, false, { { "short", std::span<const float>{ height }.first(5) } }));
+
+    std::filesystem::remove(path);
+}
+
+TEST(MeshExport, BinaryFormats)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_export_grid(10) };
+    auto vertices{ mesh.get_vertices() };
+    auto indices{ mesh.get_indices() };
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_export.bin").string() };
+
+    // Binary STL is a fixed 84 byte header then 50 bytes per triangle
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Stl));
+    EXPECT_EQ(std::filesystem::file_size(path), 84 + 50 * 200);
+
+    // Binary PLY vertices are the raw floats after the header
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Ply));
+
+    std::string data{ read_file(path) };
+    size_t body{ data.find("end_header\n") + 11 };
+
+    EXPECT_EQ(data.size(), body + 12 * vertices.size() + 13 * 200);
+
+    float last[3]{};
+    std::memcpy(last, data.data() + body + 12 * (vertices.size() - 1), sizeof(last));
+    EXPECT_EQ(last[2], vertices.back().z);
+
+    // Legacy VTK binary is big endian
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Vtk));
+
+    data = read_file(path);
+    size_t polygons{ data.find("POLYGONS 200 800\n") + 17 };
+
+    unsigned char count[4]{};
+    std::memcpy(count, data.data() + polygons, sizeof(count));
+    EXPECT_EQ(count[3], 3);
+
+    // VTU appended arrays start with their size in bytes
+    ASSERT_TRUE(export_mesh(path, mesh, MeshExportFormat::Vtu));
+
+    data = read_file(path);
+    size_t appended{ data.find("encoding=\"raw\">\n_") + 17 };
+
+    uint64_t points_size{};
+    std::memcpy(&points_size, data.data() + appended, sizeof(points_size));
+    EXPECT_EQ(points_size, 12 * vertices.size());
+
+    uint64_t connectivity_size{};
+    std::memcpy(&connectivity_size, data.data() + appended + 8 + points_size, sizeof(connectivity_size));
+    EXPECT_EQ(connectivity_size, 4 * indices.size());
+
+    EXPECT_NE(data.find("</VTKFile>"), std::string::npos);
+
+    std::filesystem::remove(path);
+}
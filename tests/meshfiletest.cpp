@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "mesh.h"
+#include "meshfile.h"
+#include "quality.h"
+#include "meshfixtures.h"
+
+TEST(MeshFile, RoundTrip)
+{
+    using namespace moodysim;
+
+    DelaunayGenerator delaunay_gen{ generate_sample_points(1.f, 20), {} };
+    delaunay_gen.set_renumbering(true);
+
+    SurfaceMeshData mesh{ delaunay_gen.generate_delaunay_mesh() };
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_round_trip.mesh").string() };
+
+    ASSERT_TRUE(write_mesh_file(path, mesh, delaunay_gen.get_neighbors(), delaunay_gen.get_point_ordering()));
+
+    std::optional<SurfaceMeshData> view{};
+
+    {
+        MeshFile file{};
+        ASSERT_TRUE(file.open(path));
+
+        const auto& neighbors{ delaunay_gen.get_neighbors() };
+        const auto& point_ordering{ delaunay_gen.get_point_ordering() };
+
+        EXPECT_TRUE(std::equal(neighbors.begin(), neighbors.end(), file.get_neighbors().begin(), file.get_neighbors().end()));
+        EXPECT_TRUE(std::equal(point_ordering.begin(), point_ordering.end(), file.get_point_ordering().begin(), file.get_point_ordering().end()));
+
+        // Sections are cache line aligned in memory
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(file.mesh().get_vertices().data()) % mesh_file_alignment, 0);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(file.mesh().get_indices().data()) % mesh_file_alignment, 0);
+
+        view = file.mesh();
+    }
+
+    // The view outlives the MeshFile it came from
+    auto vertices{ view->get_vertices() };
+    auto indices{ view->get_indices() };
+
+    ASSERT_EQ(vertices.size(), mesh.get_vertices().size());
+    ASSERT_EQ(indices.size(), mesh.get_indices().size());
+
+    EXPECT_EQ(std::memcmp(vertices.data(), mesh.get_vertices().data(), vertices.size_bytes()), 0);
+    EXPECT_TRUE(std::equal(indices.begin(), indices.end(), mesh.get_indices().begin()));
+
+    // Views work anywhere a mesh does
+    EXPECT_EQ(measure_quality(*view).min_angle.min, measure_quality(mesh).min_angle.min);
+
+    view.reset();
+    std::filesystem::remove(path);
+}
+
+TEST(MeshFile, InvalidFiles)
+{
+    using namespace moodysim;
+
+    std::string path{ (std::filesystem::temp_directory_path() / "mesh_invalid.mesh").string() };
+
+    ASSERT_TRUE(write_mesh_file(path, make_grid(4)));
+
+    // Another major version
+    {
+        std::fstream file{ path, std::ios::binary | std::ios::in | std::ios::out };
+        MeshFileHeader header{};
+        header.major_version = 2;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    MeshFile file{};
+    EXPECT_FALSE(file.open(path));
+
+    // Cut off in the middle of the indices
+    ASSERT_TRUE(write_mesh_file(path, make_grid(4)));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 128);
+
+    EXPECT_FALSE(file.open(path));
+
+    // Neighbors must match the triangles
+    std::vector<std::array<int, 3>> neighbors(5);
+    EXPECT_FALSE(write_mesh_file(path, make_grid(4), neighbors));
+
+    // Sections written without those checks are refused when opened
+    SurfaceMeshData grid{ make_grid(4) };
+    std::vector<int> point_ordering(grid.get_vertices().size() + 1);
+
+    std::vector<MeshSectionData> sections{
+        { MeshSection::Vertices, sizeof(SMVertex), grid.get_vertices().size(), grid.get_vertices().data() },
+        { MeshSection::Indices, sizeof(unsigned int), grid.get_indices().size(), grid.get_indices().data() },
+        { MeshSection::Neighbors, sizeof(std::array<int, 3>), neighbors.size(), neighbors.data() }
+    };
+
+    ASSERT_TRUE(write_mesh_sections(path, sections));
+    EXPECT_FALSE(file.open(path));
+
+    sections.back() = { MeshSection::PointOrdering, sizeof(int), point_ordering.size(), point_ordering.data() };
+
+    ASSERT_TRUE(write_mesh_sections(path, sections));
+    EXPECT_FALSE(file.open(path));
+
+    EXPECT_FALSE(write_mesh_file(path, grid, {}, point_ordering));
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mesh.h"
+#include "surfacemeshdata.h"
+
+// Meshes shared by the unit tests and the benchmarks
+
+// Random points in a square with a jagged polyline ("coastline") running across it
+// Returns the points and the consecutive coastline segments as constraints
+inline void make_coastline(int num_points, int num_segments, std::vector<moodysim::Point3D>& points, std::vector<moodysim::Edge>& edges)
+{
+    std::mt19937 rng{ 1234 };
+    std::uniform_real_distribution<float> coord{ -1.f, 1.f };
+    std::uniform_real_distribution<float> jitter{ -0.3f, 0.3f };
+
+    for (int i = 0; i < num_points; ++i)
+    {
+        points.push_back({ coord(rng), coord(rng), 0.f });
+    }
+
+    for (int i = 0; i <= num_segments; ++i)
+    {
+        float x{ -0.95f + 1.9f * i / num_segments };
+        int index{ static_cast<int>(points.size()) };
+
+        points.push_back({ x, jitter(rng), 0.f });
+
+        if (i > 0)
+        {
+            edges.push_back({ index - 1, index });
+        }
+    }
+}
+
+// Random points in [-1, 1] filling a grid of cells one cell at a time in row order
+inline std::vector<moodysim::Point3D> make_cell_ordered_points(int grid_size, int points_per_cell, unsigned int seed)
+{
+    std::mt19937 random{ seed };
+    std::uniform_real_distribution<float> offset{ 0.f, 1.f };
+
+    float cell{ 2.f / grid_size };
+
+    std::vector<moodysim::Point3D> points{};
+    points.reserve(static_cast<size_t>(grid_size) * grid_size * points_per_cell);
+
+    for (int j = 0; j < grid_size; ++j)
+    {
+        for (int i = 0; i < grid_size; ++i)
+        {
+            for (int k = 0; k < points_per_cell; ++k)
+            {
+                points.push_back({ -1.f + (i + offset(random)) * cell, -1.f + (j + offset(random)) * cell, 0.f });
+            }
+        }
+    }
+
+    return points;
+}
+
+// Grid of n by n cells split into counter-clockwise triangles, vertex_at(i, j) gives the vertex
+// in column i and row j (both from 0 to n)
+template <typename VertexAt>
+moodysim::SurfaceMeshData make_grid(int n, VertexAt vertex_at)
+{
+    std::vector<moodysim::SMVertex> vertices{};
+    std::vector<unsigned int> indices{};
+
+    vertices.reserve(static_cast<size_t>(n + 1) * (n + 1));
+    indices.reserve(6 * static_cast<size_t>(n) * n);
+
+    for (int j = 0; j <= n; ++j)
+    {
+        for (int i = 0; i <= n; ++i)
+        {
+            vertices.push_back(vertex_at(i, j));
+        }
+    }
+
+    for (int j = 0; j < n; ++j)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            unsigned int v{ static_cast<unsigned int>(j * (n + 1) + i) };
+
+            indices.insert(indices.end(), { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 });
+        }
+    }
+
+    return moodysim::SurfaceMeshData{ std::move(vertices), std::move(indices) };
+}
+
+// Flat grid with a vertex at every integer point of [0, n] by [0, n]
+inline moodysim::SurfaceMeshData make_grid(int n)
+{
+    return make_grid(n, [](int i, int j) { return moodysim::SMVertex{ static_cast<float>(i), static_cast<float>(j), 0.f }; });
+}
+
+// Integer grid with each vertex moved by up to 0.3 so the triangles are not all alike, z from height(i, j)
+template <typename Height>
+moodysim::SurfaceMeshData make_jittered_grid(int n, Height height)
+{
+    return make_grid(n, [&](int i, int j)
+        {
+            float jitter{ 0.3f * std::sin(12.9898f * i + 78.233f * j) };
+            return moodysim::SMVertex{ i + jitter, j - jitter, height(i, j) };
+        });
+}
+
+// Grid of n by n cells over [-1, 1] with red vertices and heights from height(x, y)
+template <typename Height>
+moodysim::SurfaceMeshData make_height_field(int n, Height&& height)
+{
+    return make_grid(n, [&](int i, int j)
+        {
+            float x{ -1.f + 2.f * i / n };
+            float y{ -1.f + 2.f * j / n };
+
+            return moodysim::SMVertex{ x, y, height(x, y), 1.f, 0.f, 0.f };
+        });
+}
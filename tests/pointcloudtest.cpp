@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "mesh.h"
+#include "pointcloud.h"
+
+// Path for a scratch file in the temporary directory
+std::string scratch_path(const std::string& name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST(PointCloud, MappedReader)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected{ generate_sample_points(1.f, 20) };
+    std::string path{ scratch_path("pointcloud_float.bin") };
+
+    ASSERT_TRUE(write_point_cloud(path, expected));
+
+    // Float xyz is viewed in place when the host byte order matches the file
+    PointCloudReader reader{};
+    ASSERT_TRUE(reader.open(path));
+
+    std::span<const Point3D> view{ reader.points() };
+
+    if constexpr (std::endian::native == std::endian::little)
+    {
+        ASSERT_EQ(view.size(), expected.size());
+        EXPECT_TRUE(std::equal(view.begin(), view.end(), expected.begin(), [](Point3D l, Point3D r) { return l.x == r.x && l.y == r.y && l.z == r.z; }));
+    }
+
+    // Reading the mapped file into the triangulator gives the same triangulation as the vector
+    DelaunayGenerator mapped_gen{ reader };
+    EXPECT_EQ(mapped_gen.get_points().capacity(), expected.size() + 3);
+
+    mapped_gen.triangulate();
+
+    DelaunayGenerator delaunay_gen{ expected, {} };
+    delaunay_gen.triangulate();
+
+    EXPECT_TRUE(mapped_gen.get_triangles() == delaunay_gen.get_triangles());
+
+    // A used up reader starts over after rewinding
+    std::vector<Point3D> points{};
+    EXPECT_EQ(reader.read(points, 10), 0);
+
+    reader.rewind();
+    EXPECT_EQ(reader.read(points, 10), 10);
+
+    std::filesystem::remove(path);
+}
+
+TEST(PointCloud, ConvertedLayouts)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> expected{ { 0.f, 0.f, 0.f }, { 1.5f, -2.f, 3.f }, { 0.25f, 7.f, -1.f } };
+    std::vector<double> attributes{ 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+
+    std::string path{ scratch_path("pointcloud_double.bin") };
+
+    // Double xy records with two attributes are converted as they are read
+    PointCloudLayout layout{ true, 2, 2 };
+    ASSERT_TRUE(write_point_cloud(path, expected, layout, attributes));
+
+    PointCloudReader reader{};
+    ASSERT_TRUE(reader.open(path));
+
+    EXPECT_TRUE(reader.layout().use_double);
+    EXPECT_EQ(reader.layout().dimensions, 2);
+    EXPECT_EQ(reader.layout().num_attributes, 2);
+    EXPECT_TRUE(reader.points().empty());
+
+    std::vector<Point3D> points{};
+    EXPECT_EQ(reader.read(points, 2), 2);
+    EXPECT_EQ(reader.read(points, 2), 1);
+    EXPECT_EQ(reader.read(points, 2), 0);
+
+    ASSERT_EQ(points.size(), expected.size());
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        EXPECT_EQ(points[i].x, expected[i].x);
+        EXPECT_EQ(points[i].y, expected[i].y);
+        EXPECT_EQ(points[i].z, 0.f);
+        EXPECT_EQ(reader.attribute(i, 0), attributes[2 * i]);
+        EXPECT_EQ(reader.attribute(i, 1), attributes[2 * i + 1]);
+    }
+
+    // Attribute count must match the layout
+    EXPECT_FALSE(write_point_cloud(path, expected, layout, {}));
+
+    std::filesystem::remove(path);
+}
+
+TEST(PointCloud, InvalidFiles)
+{
+    using namespace moodysim;
+
+    PointCloudReader reader{};
+
+    EXPECT_FALSE(reader.open(scratch_path("pointcloud_missing.bin")));
+
+    std::string path{ scratch_path("pointcloud_invalid.bin") };
+
+    // Header claims more points than the file holds
+    PointCloudHeader header{};
+    header.num_points = 100;
+
+    {
+        std::ofstream file{ path, std::ios::binary };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    EXPECT_FALSE(reader.open(path));
+
+    // Corrupt attribute count that wraps the record size to zero in 32 bits
+    header.num_attributes = 0xFFFFFFFD;
+    header.num_points = 1;
+
+    {
+        std::ofstream file{ path, std::ios::binary };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    EXPECT_FALSE(reader.open(path));
+
+    // Wrong magic
+    header.num_attributes = 0;
+    std::memcpy(header.magic, "ABCD", 4);
+    header.num_points = 0;
+
+    {
+        std::ofstream file{ path, std::ios::binary };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    EXPECT_FALSE(reader.open(path));
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numeric>
+
+#include "quality.h"
+#include "surfacemeshdata.h"
+#include "meshfixtures.h"
+
+TEST(Quality, KnownTriangles)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> points{
+        { 0.f, 0.f, 0.f },
+        { 1.f, 0.f, 0.f },
+        { 0.5f, 0.8660254f, 0.f },
+        { 0.f, 1.f, 0.f },
+        { 2.f, 0.f, 0.f }
+    };
+
+    // Equilateral, right isosceles, and degenerate (collinear) triangles
+    std::vector<std::array<int, 3>> triangles{ { 0, 1, 2 }, { 0, 1, 3 }, { 0, 1, 4 } };
+
+    QualityReport report{ measure_quality(points, triangles, 4, 2) };
+
+    EXPECT_NEAR(report.min_angle.values[0], 60.f, 0.01f);
+    EXPECT_NEAR(report.max_angle.values[0], 60.f, 0.01f);
+    EXPECT_NEAR(report.aspect_ratio.values[0], 1.f, 1e-4f);
+    EXPECT_NEAR(report.radius_edge_ratio.values[0], 1.f / std::sqrt(3.f), 1e-4f);
+    EXPECT_NEAR(report.area.values[0], 0.4330127f, 1e-5f);
+
+    EXPECT_NEAR(report.min_angle.values[1], 45.f, 0.01f);
+    EXPECT_NEAR(report.max_angle.values[1], 90.f, 0.01f);
+    EXPECT_NEAR(report.radius_edge_ratio.values[1], std::sqrt(2.f) / 2.f, 1e-4f);
+    EXPECT_NEAR(report.area.values[1], 0.5f, 1e-6f);
+
+    EXPECT_NEAR(report.min_angle.values[2], 0.f, 0.01f);
+    EXPECT_NEAR(report.max_angle.values[2], 180.f, 0.01f);
+    EXPECT_FALSE(std::isfinite(report.aspect_ratio.values[2]));
+
+    // The degenerate triangle is left out of the aspect ratio summary
+    EXPECT_NEAR(report.aspect_ratio.max, std::sqrt(3.f) / 2.f * 2.f, 1e-4f);
+    EXPECT_EQ(report.aspect_ratio.histogram[3], 2);
+
+    ASSERT_EQ(report.worst.size(), 2);
+    EXPECT_EQ(report.worst[0], 2);
+    EXPECT_EQ(report.worst[1], 1);
+}
+
+TEST(Quality, InvalidCounts)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_grid(4) };
+
+    // No bins becomes a single bin holding every triangle and a negative count asks for no worst triangles
+    QualityReport report{ measure_quality(mesh, 0, -3) };
+
+    ASSERT_EQ(report.min_angle.histogram.size(), 1);
+    EXPECT_EQ(report.min_angle.histogram[0], 32);
+    EXPECT_TRUE(report.worst.empty());
+}
+
+TEST(Quality, JitteredGrid)
+{
+    using namespace moodysim;
+
+    // Grid of right triangles with a random jitter on the vertices
+    constexpr int n{ 100 };
+
+    SurfaceMeshData mesh{ make_jittered_grid(n, [](int, int) { return 0.f; }) };
+
+    QualityReport report{ measure_quality(mesh, 18, 5) };
+
+    EXPECT_EQ(report.min_angle.values.size(), 2 * n * n);
+    EXPECT_EQ(std::accumulate(report.min_angle.histogram.begin(), report.min_angle.histogram.end(), size_t{ 0 }), 2 * n * n);
+    EXPECT_NEAR(report.area.mean * 2 * n * n, static_cast<float>(n) * n, 0.01f * n * n);
+    EXPECT_LE(report.min_angle.min, report.min_angle.mean);
+    EXPECT_LE(report.min_angle.mean, report.min_angle.max);
+
+    ASSERT_EQ(report.worst.size(), 5);
+    EXPECT_EQ(report.min_angle.values[report.worst[0]], report.min_angle.min);
+
+    for (int i = 1; i < 5; ++i)
+    {
+        EXPECT_LE(report.min_angle.values[report.worst[i - 1]], report.min_angle.values[report.worst[i]]);
+    }
+}
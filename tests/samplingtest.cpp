@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "mesh.h"
+#include "sampling.h"
+
+// Smallest distance between any two points by sweeping them in order of x
+float closest_pair(std::vector<moodysim::Point3D> points)
+{
+    std::sort(points.begin(), points.end(), [](const auto& l, const auto& r) { return l.x < r.x; });
+
+    float closest{ std::numeric_limits<float>::max() };
+
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        for (size_t j = i + 1; j < points.size() && points[j].x - points[i].x < closest; ++j)
+        {
+            float dx{ points[j].x - points[i].x };
+            float dy{ points[j].y - points[i].y };
+
+            closest = std::min(closest, std::sqrt(dx * dx + dy * dy));
+        }
+    }
+
+    return closest;
+}
+
+// Fraction of probe points on a regular grid inside the domain that are farther than gap from every point
+template <typename Inside>
+double uncovered_fraction(const std::vector<moodysim::Point3D>& points, Inside&& inside, float xmin, float ymin, float xmax, float ymax, float gap)
+{
+    // Bin the points so each probe only looks at nearby ones
+    int n{ static_cast<int>((xmax - xmin) / gap) + 1 };
+    float cell{ (xmax - xmin) / n };
+
+    std::vector<std::vector<moodysim::Point3D>> bins(n * n);
+
+    for (auto point : points)
+    {
+        int i{ std::clamp(static_cast<int>((point.x - xmin) / cell), 0, n - 1) };
+        int j{ std::clamp(static_cast<int>((point.y - ymin) / cell), 0, n - 1) };
+        bins[j * n + i].push_back(point);
+    }
+
+    int probes{ 0 };
+    int uncovered{ 0 };
+
+    for (float y = ymin + 0.5f * gap; y < ymax; y += 0.5f * gap)
+    {
+        for (float x = xmin + 0.5f * gap; x < xmax; x += 0.5f * gap)
+        {
+            if (!inside(x, y))
+            {
+                continue;
+            }
+
+            int ci{ std::clamp(static_cast<int>((x - xmin) / cell), 0, n - 1) };
+            int cj{ std::clamp(static_cast<int>((y - ymin) / cell), 0, n - 1) };
+
+            bool covered{ false };
+
+            for (int j = std::max(0, cj - 1); j <= std::min(n - 1, cj + 1) && !covered; ++j)
+            {
+                for (int i = std::max(0, ci - 1); i <= std::min(n - 1, ci + 1) && !covered; ++i)
+                {
+                    for (auto point : bins[j * n + i])
+                    {
+                        covered = covered || (point.x - x) * (point.x - x) + (point.y - y) * (point.y - y) <= gap * gap;
+                    }
+                }
+            }
+
+            ++probes;
+            uncovered += covered ? 0 : 1;
+        }
+    }
+
+    return static_cast<double>(uncovered) / probes;
+}
+
+TEST(Sampling, PoissonDisk)
+{
+    using namespace moodysim;
+
+    constexpr float radius{ 1.f };
+    constexpr float min_distance{ 0.05f };
+
+    std::vector<Point3D> points{ generate_poisson_disk_points(radius, min_distance, 7) };
+
+    bool inside{ true };
+    for (auto point : points)
+    {
+        inside = inside && point.x * point.x + point.y * point.y <= radius * radius * 1.0001f;
+    }
+
+    EXPECT_TRUE(inside);
+    EXPECT_GE(closest_pair(points), 0.9999f * min_distance);
+
+    auto circle = [](float x, float y) { return x * x + y * y < 1.f; };
+    EXPECT_LT(uncovered_fraction(points, circle, -1.f, -1.f, 1.f, 1.f, 2.f * min_distance), 1e-3);
+
+    // Same seed gives the same points
+    std::vector<Point3D> again{ generate_poisson_disk_points(radius, min_distance, 7) };
+
+    ASSERT_EQ(again.size(), points.size());
+    EXPECT_TRUE(std::equal(points.begin(), points.end(), again.begin(), [](auto l, auto r) { return l.x == r.x && l.y == r.y; }));
+
+    // Well spaced points without ties triangulate into well shaped triangles
+    DelaunayGenerator delaunay_gen{ points, {} };
+    delaunay_gen.triangulate();
+
+    const auto& triangles{ delaunay_gen.get_triangles() };
+    const auto& triangle_points{ delaunay_gen.get_points() };
+
+    double sum{ 0.0 };
+    for (const auto& triangle : triangles)
+    {
+        sum += triangle_quality(triangle_points[triangle[0]], triangle_points[triangle[1]], triangle_points[triangle[2]]);
+    }
+
+    EXPECT_GT(sum / triangles.size(), 0.8);
+}
+
+TEST(Sampling, TiledDomain)
+{
+    using namespace moodysim;
+
+    // Annulus with a slot cut out of it
+    auto inside = [](float x, float y)
+        {
+            float sqr_radius{ x * x + y * y };
+            return sqr_radius <= 1.f && sqr_radius >= 0.09f && !(x > 0.f && std::abs(y) < 0.1f);
+        };
+
+    constexpr float min_distance{ 0.004f };
+
+    std::vector<Point3D> points{ generate_poisson_disk_points(inside, -1.f, -1.f, 1.f, 1.f, min_distance, 3) };
+
+    bool all_inside{ true };
+    for (auto point : points)
+    {
+        all_inside = all_inside && inside(point.x, point.y);
+    }
+
+    EXPECT_TRUE(all_inside);
+    EXPECT_GE(closest_pair(points), 0.9999f * min_distance);
+
+    // No gaps along the seams between tiles
+    EXPECT_LT(uncovered_fraction(points, inside, -1.f, -1.f, 1.f, 1.f, 2.f * min_distance), 1e-3);
+}
+
+// Even-odd point in polygon test
+bool inside_polygon(const std::vector<moodysim::Point3D>& polygon, float x, float y)
+{
+    bool inside{ false };
+
+    for (size_t k = 0, l = polygon.size() - 1; k < polygon.size(); l = k++)
+    {
+        if ((polygon[k].y > y) != (polygon[l].y > y) &&
+            x < polygon[l].x + (y - polygon[l].y) * (polygon[k].x - polygon[l].x) / (polygon[k].y - polygon[l].y))
+        {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+TEST(Sampling, LatticeShapes)
+{
+    using namespace moodysim;
+
+    constexpr float spacing{ 0.02f };
+
+    // Circle, the perimeter points lie on it and the lattice keeps half a spacing away
+    LatticeShape circle{};
+    circle.radius = 0.9f;
+
+    std::vector<Point3D> points{ generate_lattice_points(circle, spacing) };
+
+    int on_circle{ 0 };
+    bool inside{ true };
+
+    for (auto point : points)
+    {
+        float radius{ std::sqrt(point.x * point.x + point.y * point.y) };
+
+        on_circle += std::abs(radius - 0.9f) < 1e-5f ? 1 : 0;
+        inside = inside && (std::abs(radius - 0.9f) < 1e-5f || radius <= 0.9f - 0.5f * spacing);
+    }
+
+    // Rotating by a fixed angle comes back around the circle without drifting
+    EXPECT_EQ(on_circle, static_cast<int>(std::round(2.f * 3.14159265f * 0.9f / spacing)));
+    EXPECT_TRUE(inside);
+    EXPECT_GT(closest_pair(points), 0.49f * spacing);
+    EXPECT_NEAR(points.size() - on_circle, 3.14159265 * 0.89 * 0.89 / (0.8660254 * spacing * spacing), 0.01 * points.size());
+
+    // Rectangle includes its corners
+    LatticeShape rectangle{ LatticeShapeType::Rectangle };
+    rectangle.xmin = -0.5f;
+    rectangle.xmax = 1.5f;
+
+    points = generate_lattice_points(rectangle, spacing);
+
+    bool corner{ false };
+    inside = true;
+
+    for (auto point : points)
+    {
+        corner = corner || (point.x == 1.5f && point.y == 1.f);
+        inside = inside && point.x >= -0.5f && point.x <= 1.5f && point.y >= -1.f && point.y <= 1.f;
+    }
+
+    EXPECT_TRUE(corner);
+    EXPECT_TRUE(inside);
+    EXPECT_GT(closest_pair(points), 0.49f * spacing);
+
+    // Non-convex star polygon
+    LatticeShape star{ LatticeShapeType::Polygon };
+
+    for (int k = 0; k < 10; ++k)
+    {
+        float radius{ k % 2 == 0 ? 1.f : 0.4f };
+        float angle{ 3.14159265f * k / 5.f };
+
+        star.polygon.push_back({ radius * std::cos(angle), radius * std::sin(angle), 0.f });
+    }
+
+    points = generate_lattice_points(star, spacing);
+
+    int num_inside{ 0 };
+    for (auto point : points)
+    {
+        num_inside += inside_polygon(star.polygon, point.x, point.y) ? 1 : 0;
+    }
+
+    // Perimeter points on the edges may count either way
+    EXPECT_GE(num_inside, points.size() - 2 * 10 / spacing);
+    EXPECT_GT(closest_pair(points), 0.3f * spacing);
+
+    // The same star as a distance field (sign only) gives the same interior lattice without a perimeter
+    LatticeShape field{ LatticeShapeType::DistanceField };
+    field.distance = [&](float x, float y) { return inside_polygon(star.polygon, x, y) ? -1.f : 1.f; };
+
+    std::vector<Point3D> field_points{ generate_lattice_points(field, spacing) };
+    std::vector<Point3D> star_points{ generate_lattice_points(star, spacing, false) };
+
+    bool all_inside{ true };
+    for (auto point : field_points)
+    {
+        all_inside = all_inside && inside_polygon(star.polygon, point.x, point.y);
+    }
+
+    EXPECT_TRUE(all_inside);
+    EXPECT_NEAR(static_cast<double>(field_points.size()), static_cast<double>(star_points.size()), 0.01 * star_points.size());
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "mesh.h"
+#include "streaming.h"
+#include "pointcloud.h"
+#include "streamedmesh.h"
+#include "meshfixtures.h"
+
+// Keeps everything a StreamingDelaunay writes
+class MemoryMeshSink : public moodysim::StreamingMeshSink
+{
+public:
+
+    void write_points(std::span<const moodysim::Point3D> points) override
+    {
+        this->points.insert(this->points.end(), points.begin(), points.end());
+    }
+
+    void write_triangles(std::span<const std::array<std::int64_t, 3>> triangles) override
+    {
+        // Every triangle only uses points written before it
+        for (const auto& triangle : triangles)
+        {
+            ordered = ordered && *std::max_element(triangle.begin(), triangle.end()) < static_cast<std::int64_t>(this->points.size());
+        }
+
+        this->triangles.insert(this->triangles.end(), triangles.begin(), triangles.end());
+    }
+
+    std::vector<moodysim::Point3D> points{};
+    std::vector<std::array<std::int64_t, 3>> triangles{};
+    bool ordered{ true };
+};
+
+// Rotate each triangle to start at its smallest index and sort them so triangulations can be compared
+template <typename Index>
+std::vector<std::array<std::int64_t, 3>> canonical_triangles(const std::vector<std::array<Index, 3>>& triangles)
+{
+    std::vector<std::array<std::int64_t, 3>> result{};
+
+    for (const auto& triangle : triangles)
+    {
+        int first{ static_cast<int>(std::min_element(triangle.begin(), triangle.end()) - triangle.begin()) };
+        result.push_back({ triangle[first], triangle[(first + 1) % 3], triangle[(first + 2) % 3] });
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+TEST(Streaming, MatchesInCore)
+{
+    using namespace moodysim;
+
+    constexpr int grid_size{ 8 };
+    std::vector<Point3D> points{ make_cell_ordered_points(grid_size, 50, 5) };
+
+    DelaunayGenerator delaunay_gen{ points, {} };
+    delaunay_gen.triangulate();
+
+    MemoryMeshSink sink{};
+    StreamingDelaunay streaming{ sink, -1.f, -1.f, 1.f, 1.f, grid_size };
+
+    // Look for finalized triangles often so most of them are written before the end
+    streaming.set_min_eviction(256);
+
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        streaming.add_point(points[k]);
+
+        if ((k + 1) % 50 == 0)
+        {
+            streaming.finalize_cell(streaming.cell_index(points[k]));
+        }
+    }
+
+    size_t written_before_end{ sink.triangles.size() };
+
+    streaming.finish();
+
+    EXPECT_GT(written_before_end, sink.triangles.size() / 2);
+    EXPECT_LT(streaming.get_peak_resident_triangles(), sink.triangles.size());
+    EXPECT_TRUE(sink.ordered);
+
+    ASSERT_EQ(sink.points.size(), points.size());
+    EXPECT_EQ(streaming.get_num_triangles_written(), sink.triangles.size());
+
+    // Both use the same super triangle for this box so the triangulations are identical
+    EXPECT_EQ(canonical_triangles(sink.triangles), canonical_triangles(delaunay_gen.get_triangles()));
+}
+
+TEST(Streaming, BoundedMemory)
+{
+    using namespace moodysim;
+
+    constexpr int grid_size{ 32 };
+    std::vector<Point3D> points{ make_cell_ordered_points(grid_size, 50, 9) };
+
+    MemoryMeshSink sink{};
+    StreamingDelaunay streaming{ sink, -1.f, -1.f, 1.f, 1.f, grid_size };
+
+    // Scaled down with the input so the front is evicted as often as for a large stream
+    streaming.set_min_eviction(1024);
+
+    for (size_t k = 0; k < points.size(); ++k)
+    {
+        streaming.add_point(points[k]);
+
+        if ((k + 1) % 50 == 0)
+        {
+            streaming.finalize_cell(streaming.cell_index(points[k]));
+        }
+    }
+
+    streaming.finish();
+
+    // Only a few rows of cells along the front stay in memory
+    EXPECT_LT(streaming.get_peak_resident_triangles(), sink.triangles.size() / 8);
+    EXPECT_LT(streaming.get_peak_resident_points(), points.size() / 8);
+    EXPECT_TRUE(sink.ordered);
+
+    // Counter-clockwise triangles covering the hull without overlapping
+    double area{ 0.0 };
+    bool counter_clockwise{ true };
+
+    std::vector<std::uint64_t> edges{};
+    edges.reserve(3 * sink.triangles.size());
+
+    for (const auto& triangle : sink.triangles)
+    {
+        double twice_area{ orientation(sink.points[triangle[0]], sink.points[triangle[1]], sink.points[triangle[2]]) };
+
+        counter_clockwise = counter_clockwise && twice_area > 0.0;
+        area += 0.5 * twice_area;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            edges.push_back((static_cast<std::uint64_t>(triangle[i]) << 32) | static_cast<std::uint64_t>(triangle[(i + 1) % 3]));
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    EXPECT_TRUE(counter_clockwise);
+    EXPECT_EQ(std::adjacent_find(edges.begin(), edges.end()), edges.end());
+    EXPECT_NEAR(area, 4.0, 0.01);
+}
+
+TEST(Streaming, PointCloudFile)
+{
+    using namespace moodysim;
+
+    std::vector<Point3D> points{ make_cell_ordered_points(16, 100, 13) };
+
+    std::string cloud_path{ (std::filesystem::temp_directory_path() / "streaming_points.mpcl").string() };
+    std::string mesh_path{ (std::filesystem::temp_directory_path() / "streaming_mesh.stm").string() };
+
+    ASSERT_TRUE(write_point_cloud(cloud_path, points));
+
+    PointCloudReader reader{};
+    ASSERT_TRUE(reader.open(cloud_path));
+
+    StreamedMeshWriter writer{};
+    ASSERT_TRUE(writer.open(mesh_path));
+
+    ASSERT_TRUE(stream_triangulate(reader, writer, 16));
+    ASSERT_TRUE(writer.close());
+
+    std::vector<Point3D> read_points{};
+    std::vector<std::array<std::int64_t, 3>> read_triangles{};
+
+    ASSERT_TRUE(read_streamed_mesh(mesh_path, read_points, read_triangles));
+
+    ASSERT_EQ(read_points.size(), points.size());
+    EXPECT_TRUE(std::equal(points.begin(), points.end(), read_points.begin(), [](auto l, auto r) { return l.x == r.x && l.y == r.y; }));
+
+    // A source that can only be read once is refused
+    MemoryMeshSink sink{};
+    RangePointSource source{ std::ranges::ref_view{ points } };
+
+    EXPECT_FALSE(stream_triangulate(source, sink));
+
+    // The same points added by hand in the same order give the same triangles
+    float xmin{ points[0].x }, ymin{ points[0].y }, xmax{ points[0].x }, ymax{ points[0].y };
+
+    for (auto point : points)
+    {
+        xmin = std::min(xmin, point.x);
+        ymin = std::min(ymin, point.y);
+        xmax = std::max(xmax, point.x);
+        ymax = std::max(ymax, point.y);
+    }
+
+    StreamingDelaunay streaming{ sink, xmin, ymin, xmax, ymax, 16 };
+
+    for (auto point : points)
+    {
+        streaming.add_point(point);
+    }
+
+    streaming.finish();
+
+    EXPECT_EQ(canonical_triangles(read_triangles), canonical_triangles(sink.triangles));
+
+    std::filesystem::remove(cloud_path);
+    std::filesystem::remove(mesh_path);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+#include <utility>
+
+#include "subdivide.h"
+#include "surfacemeshdata.h"
+#include "meshfixtures.h"
+
+// Flat grid of n by n cells over [-1, 1] with green vertices so grid vertices can be told apart
+moodysim::SurfaceMeshData make_square_grid(int n)
+{
+    return make_grid(n, [n](int i, int j) { return moodysim::SMVertex{ -1.f + 2.f * i / n, -1.f + 2.f * j / n, 0.f, 0.f, 1.f, 0.f }; });
+}
+
+// Closed octahedron with outward facing triangles
+moodysim::SurfaceMeshData make_octahedron()
+{
+    std::vector<moodysim::SMVertex> vertices{
+        { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f },
+        { 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f },
+        { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f }
+    };
+
+    std::vector<unsigned int> indices{
+        0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4,
+        2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5
+    };
+
+    return moodysim::SurfaceMeshData{ std::move(vertices), std::move(indices) };
+}
+
+// Sum of the areas of the triangles projected onto the xy plane, also checks they are counter-clockwise
+double planar_area(const moodysim::SurfaceMeshData& mesh, bool& all_counter_clockwise)
+{
+    const auto& vertices{ mesh.get_vertices() };
+    const auto& indices{ mesh.get_indices() };
+
+    double area{ 0.0 };
+    all_counter_clockwise = true;
+
+    for (size_t f = 0; f < indices.size(); f += 3)
+    {
+        const auto& a{ vertices[indices[f]] };
+        const auto& b{ vertices[indices[f + 1]] };
+        const auto& c{ vertices[indices[f + 2]] };
+
+        double twice_area{ (static_cast<double>(b.x) - a.x) * (c.y - a.y) - (static_cast<double>(b.y) - a.y) * (c.x - a.x) };
+
+        all_counter_clockwise = all_counter_clockwise && twice_area > 0.0;
+        area += 0.5 * twice_area;
+    }
+
+    return area;
+}
+
+// Check that every directed edge appears once and, for a closed mesh, that its reverse appears too
+// Returns the number of undirected edges
+size_t count_edges(const moodysim::SurfaceMeshData& mesh, bool closed, bool& manifold)
+{
+    const auto& indices{ mesh.get_indices() };
+
+    std::set<std::pair<unsigned int, unsigned int>> directed{};
+    manifold = true;
+
+    for (size_t f = 0; f < indices.size(); f += 3)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            manifold = manifold && directed.insert({ indices[f + i], indices[f + (i + 1) % 3] }).second;
+        }
+    }
+
+    size_t num_edges{ 0 };
+
+    for (auto edge : directed)
+    {
+        bool reverse{ directed.count({ edge.second, edge.first }) != 0 };
+
+        manifold = manifold && (reverse || !closed);
+        num_edges += (!reverse || edge.first < edge.second) ? 1 : 0;
+    }
+
+    return num_edges;
+}
+
+TEST(Subdivide, MidpointGrid)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData mesh{ make_square_grid(10) };
+
+    bool manifold{};
+    size_t num_edges{ count_edges(mesh, false, manifold) };
+
+    SurfaceMeshData result{ subdivide(mesh, SubdivisionScheme::Midpoint) };
+
+    EXPECT_EQ(result.get_indices().size(), 4 * mesh.get_indices().size());
+    EXPECT_EQ(result.get_vertices().size(), mesh.get_vertices().size() + num_edges);
+
+    bool counter_clockwise{};
+    EXPECT_NEAR(planar_area(result, counter_clockwise), 4.0, 1e-5);
+    EXPECT_TRUE(counter_clockwise);
+
+    count_edges(result, false, manifold);
+    EXPECT_TRUE(manifold);
+
+    // Midpoints of a uniform grid land on the grid twice as fine
+    bool on_grid{ true };
+    for (const auto& vertex : result.get_vertices())
+    {
+        on_grid = on_grid && std::abs(vertex.x * 10.f - std::round(vertex.x * 10.f)) < 1e-4f;
+        on_grid = on_grid && std::abs(vertex.y * 10.f - std::round(vertex.y * 10.f)) < 1e-4f;
+        on_grid = on_grid && vertex.g == 1.f;
+    }
+
+    EXPECT_TRUE(on_grid);
+}
+
+TEST(Subdivide, LoopSphere)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData result{ subdivide(make_octahedron(), SubdivisionScheme::Loop, 4) };
+
+    // Closed surface of genus 0 keeps V - E + F = 2
+    bool manifold{};
+    size_t num_edges{ count_edges(result, true, manifold) };
+    size_t num_faces{ result.get_indices().size() / 3 };
+
+    EXPECT_TRUE(manifold);
+    EXPECT_EQ(num_faces, 8 * 256);
+    EXPECT_EQ(result.get_vertices().size() + num_faces, num_edges + 2);
+
+    // The limit surface is smooth and close to round, unlike the octahedron with radii from 0.58 to 1
+    float min_radius{ 1e9f };
+    float max_radius{ 0.f };
+
+    for (const auto& vertex : result.get_vertices())
+    {
+        float radius{ std::sqrt(vertex.x * vertex.x + vertex.y * vertex.y + vertex.z * vertex.z) };
+
+        min_radius = std::min(min_radius, radius);
+        max_radius = std::max(max_radius, radius);
+    }
+
+    EXPECT_LT(max_radius / min_radius, 1.2f);
+    EXPECT_LT(max_radius, 1.f);
+}
+
+TEST(Subdivide, Sqrt3)
+{
+    using namespace moodysim;
+
+    SurfaceMeshData sphere{ subdivide(make_octahedron(), SubdivisionScheme::Sqrt3, 3) };
+
+    bool manifold{};
+    size_t num_edges{ count_edges(sphere, true, manifold) };
+    size_t num_faces{ sphere.get_indices().size() / 3 };
+
+    EXPECT_TRUE(manifold);
+    EXPECT_EQ(num_faces, 8 * 27);
+    EXPECT_EQ(sphere.get_vertices().size() + num_faces, num_edges + 2);
+
+    // On a flat grid the boundary is fixed and every new vertex stays inside so the area is unchanged
+    SurfaceMeshData mesh{ make_square_grid(8) };
+    SurfaceMeshData result{ subdivide(mesh, SubdivisionScheme::Sqrt3, 2) };
+
+    EXPECT_EQ(result.get_indices().size(), 9 * mesh.get_indices().size());
+
+    bool counter_clockwise{};
+    EXPECT_NEAR(planar_area(result, counter_clockwise), 4.0, 1e-5);
+    EXPECT_TRUE(counter_clockwise);
+
+    count_edges(result, false, manifold);
+    EXPECT_TRUE(manifold);
+}